@@ -0,0 +1,602 @@
+/**
+ * File: beam.c
+ *
+ * Purpose: Beam search for large near R(s, t) colorings. Where grow follows
+ *  every extension, this keeps only the best width colorings of each order.
+ *  For each of them a greedy descent from random rows, using break and make
+ *  counts per vertex, finds the rows closing the fewest cliques of its
+ *  extension instance; the best few become its children. Children are ranked
+ *  by their number of red K_s and blue K_t, then by their number of red
+ *  K_{s-1} and blue K_{t-1} (fewer leaves more room to extend), isomorphic
+ *  children are merged, and the best width form the next beam. Beam members
+ *  are expanded in parallel.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "extension.h"
+#include "graph.h"
+
+/* Default base graph */
+#define ADJ_MATRIX_FILE "g55.42"
+
+/* Colorings kept at each order */
+#define BEAM_WIDTH 32
+
+/* Children kept per beam member */
+#define BEAM_ROWS 8
+
+/* Greedy descents per beam member */
+#define BEAM_RESTARTS 64
+
+/* Sideways moves allowed per descent, as a multiple of the order */
+#define BEAM_SIDEWAYS 2
+
+/* A coloring in the beam */
+typedef struct {
+    Graph g;
+
+    /* Red K_s plus blue K_t */
+    uint64_t score;
+
+    /* Extension instance of g */
+    Ext_clique* cliques;
+    int count;
+    int size;
+} Beam_member;
+
+/* A proposed child: the parent's coloring plus one row */
+typedef struct {
+    int parent;
+    uint64_t row;
+    uint64_t score;
+    int count;
+
+    /* Canonical form, for merging isomorphic children */
+    uint64_t hash;
+    uint64_t canon[GRAPH_MAX_ORDER];
+} Beam_child;
+
+/* State shared between the expansion threads */
+typedef struct {
+    Beam_member* beam;
+    int beam_count;
+
+    Beam_child* children;
+    int child_count;
+
+    pthread_mutex_t lock;
+    int next;
+} Beam_shared;
+
+/* Per thread descent state */
+typedef struct {
+    Beam_shared* shared;
+    pthread_t thread;
+
+    /* Cliques through each vertex of the member being expanded */
+    int* occ;
+    int occ_start[GRAPH_MAX_ORDER + 1];
+    int occ_size;
+
+    /* Cliques flipping each vertex would close and open */
+    int brk[GRAPH_MAX_ORDER];
+    int make[GRAPH_MAX_ORDER];
+} Beam_thread;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static int clique_size[2] = { 5, 5 };
+static int width = BEAM_WIDTH;
+static int rows_per_member = BEAM_ROWS;
+static uint64_t seed = 0;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-c s,t] [-p n] [-w width] [-k rows] [-n order] [-t threads] "
+            "[-r seed] [-o out] [graph]\n"
+            "  -c  clique sizes s,t (default 5,5)\n"
+            "  -p  start from the coloring induced on the first n vertices\n"
+            "  -w  colorings kept at each order (default %d)\n"
+            "  -k  children kept per coloring (default %d)\n"
+            "  -n  stop at this order (default %d)\n"
+            "  -t  number of threads (default number of processors)\n"
+            "  -r  random seed\n"
+            "  -o  write the best coloring of the last order to out\n",
+            prog, BEAM_WIDTH, BEAM_ROWS, GRAPH_MAX_ORDER);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* xorshift64* */
+static inline uint64_t beam_rand(uint64_t* s) {
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 2685821657736338717ULL;
+}
+
+/* Red K_s plus blue K_t of a coloring */
+static uint64_t beam_score(const Graph* g) {
+    return graph_cliques_in(g, clique_size[0], 0, graph_all(g->order), NULL, NULL) +
+        graph_cliques_in(g, clique_size[1], 1, graph_all(g->order), NULL, NULL);
+}
+
+/* Build the occurrence lists of a member's cliques */
+static void beam_index(Beam_thread* t, const Beam_member* m) {
+    int fill[GRAPH_MAX_ORDER] = {0};
+    int total = 0;
+
+    memset(t->occ_start, 0, sizeof(t->occ_start));
+    for(int i = 0; i < m->count; i++) {
+        for(uint64_t b = m->cliques[i].mask; b; b &= b - 1) {
+            t->occ_start[__builtin_ctzll(b) + 1]++;
+            total++;
+        }
+    }
+    for(int v = 0; v < m->g.order; v++) {
+        t->occ_start[v + 1] += t->occ_start[v];
+    }
+
+    if(total > t->occ_size) {
+        t->occ_size = total;
+        t->occ = realloc(t->occ, sizeof(int) * (t->occ_size + 1));
+        if(t->occ == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(int i = 0; i < m->count; i++) {
+        for(uint64_t b = m->cliques[i].mask; b; b &= b - 1) {
+            int v = __builtin_ctzll(b);
+
+            t->occ[t->occ_start[v] + fill[v]++] = i;
+        }
+    }
+}
+
+/* Set up the counts for row. Returns the cliques it closes */
+static int beam_counts(Beam_thread* t, const Beam_member* m, uint64_t row) {
+    int closed = 0;
+
+    memset(t->brk, 0, sizeof(t->brk));
+    memset(t->make, 0, sizeof(t->make));
+
+    for(int i = 0; i < m->count; i++) {
+        const Ext_clique* c = &m->cliques[i];
+        uint64_t same = c->cc ? row : ~row;
+        uint64_t diff = c->mask & ~same;
+
+        if(diff == 0) {
+            closed++;
+            for(uint64_t b = c->mask; b; b &= b - 1) {
+                t->make[__builtin_ctzll(b)]++;
+            }
+        } else if((diff & (diff - 1)) == 0) {
+            t->brk[__builtin_ctzll(diff)]++;
+        }
+    }
+
+    return closed;
+}
+
+/* Flip vertex v of row, keeping the counts up to date */
+static uint64_t beam_flip(Beam_thread* t, const Beam_member* m, uint64_t row, int v) {
+    uint64_t bit = ((uint64_t)1) << v;
+    uint64_t next = row ^ bit;
+
+    for(int k = t->occ_start[v]; k < t->occ_start[v + 1]; k++) {
+        const Ext_clique* c = &m->cliques[t->occ[k]];
+        uint64_t old_diff = c->mask & ~(c->cc ? row : ~row);
+        uint64_t new_diff = c->mask & ~(c->cc ? next : ~next);
+
+        /* Retract the clique's old contribution, then add the new one */
+        if(old_diff == 0) {
+            for(uint64_t b = c->mask; b; b &= b - 1) {
+                t->make[__builtin_ctzll(b)]--;
+            }
+        } else if((old_diff & (old_diff - 1)) == 0) {
+            t->brk[__builtin_ctzll(old_diff)]--;
+        }
+
+        if(new_diff == 0) {
+            for(uint64_t b = c->mask; b; b &= b - 1) {
+                t->make[__builtin_ctzll(b)]++;
+            }
+        } else if((new_diff & (new_diff - 1)) == 0) {
+            t->brk[__builtin_ctzll(new_diff)]++;
+        }
+    }
+
+    return next;
+}
+
+/* Greedy descent from a random row, taking the best flip (ties at random)
+   while it does not make things worse, with a bounded number of sideways
+   moves. Returns the row reached and stores the cliques it closes */
+static uint64_t beam_descend(Beam_thread* t, const Beam_member* m, uint64_t* rng, int* closed) {
+    int order = m->g.order;
+    uint64_t row = beam_rand(rng) & graph_all(order);
+    uint64_t best_row;
+    int sideways = BEAM_SIDEWAYS * order;
+    int cost, best;
+
+    cost = beam_counts(t, m, row);
+    best = cost;
+    best_row = row;
+
+    while(cost > 0) {
+        int best_delta = 1;
+        int ties = 0;
+        int pick = -1;
+
+        for(int v = 0; v < order; v++) {
+            int delta = t->brk[v] - t->make[v];
+
+            if(delta < best_delta) {
+                best_delta = delta;
+                ties = 1;
+                pick = v;
+            } else if(delta == best_delta && beam_rand(rng) % ++ties == 0) {
+                pick = v;
+            }
+        }
+
+        if(best_delta > 0 || (best_delta == 0 && sideways-- == 0)) {
+            break;
+        }
+
+        row = beam_flip(t, m, row, pick);
+        cost += best_delta;
+        if(cost < best) {
+            best = cost;
+            best_row = row;
+        }
+    }
+
+    *closed = best;
+    return best_row;
+}
+
+static void beam_child(Beam_child* c, const Beam_member* m, int parent, uint64_t row, int closed) {
+    Graph g = m->g;
+    Graph canon;
+    int n = m->g.order;
+
+    g.order = n + 1;
+    g.nbr[0][n] = 0;
+    g.nbr[1][n] = 0;
+    for(int v = 0; v < n; v++) {
+        graph_set(&g, v, n, (row >> v) & 1);
+    }
+
+    c->parent = parent;
+    c->row = row;
+    c->score = m->score + closed;
+
+    /* Cliques the child's own extension instance gains */
+    c->count = m->count +
+        graph_cliques_in(&g, clique_size[0] - 2, 0, g.nbr[0][n], NULL, NULL) +
+        graph_cliques_in(&g, clique_size[1] - 2, 1, g.nbr[1][n], NULL, NULL);
+
+    graph_canonical(&g, &canon, NULL);
+    memcpy(c->canon, canon.nbr[1], sizeof(uint64_t) * g.order);
+    c->hash = 0;
+    for(int v = 0; v < g.order; v++) {
+        c->hash = (c->hash ^ canon.nbr[1][v]) * 0xff51afd7ed558ccdULL;
+        c->hash ^= c->hash >> 32;
+    }
+}
+
+/* Expand beam members in turn, each into its best distinct rows */
+static void* beam_worker(void* arg) {
+    Beam_thread* t = arg;
+    Beam_shared* s = t->shared;
+    uint64_t* rows = malloc(sizeof(uint64_t) * BEAM_RESTARTS);
+    int* closed = malloc(sizeof(int) * BEAM_RESTARTS);
+
+    if(rows == NULL || closed == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(;;) {
+        const Beam_member* m;
+        uint64_t rng;
+        int found = 0;
+        int i;
+
+        pthread_mutex_lock(&s->lock);
+        i = s->next++;
+        pthread_mutex_unlock(&s->lock);
+
+        if(i >= s->beam_count) {
+            break;
+        }
+
+        /* Seeded per member so results do not depend on the thread count */
+        m = &s->beam[i];
+        rng = (seed ^ ((uint64_t)(i + 1) * 0x9e3779b97f4a7c15ULL) ^ ((uint64_t)m->g.order << 56)) | 1;
+        beam_index(t, m);
+
+        for(int r = 0; r < BEAM_RESTARTS; r++) {
+            int cost;
+            uint64_t row = beam_descend(t, m, &rng, &cost);
+            int k;
+
+            for(k = 0; k < found && rows[k] != row; k++);
+            if(k == found) {
+                rows[found] = row;
+                closed[found] = cost;
+                found++;
+            }
+        }
+
+        /* Keep the best rows, by insertion sort on cliques closed */
+        for(int a = 1; a < found; a++) {
+            uint64_t row = rows[a];
+            int cost = closed[a];
+            int b = a;
+
+            for(; b > 0 && closed[b - 1] > cost; b--) {
+                rows[b] = rows[b - 1];
+                closed[b] = closed[b - 1];
+            }
+            rows[b] = row;
+            closed[b] = cost;
+        }
+        if(found > rows_per_member) {
+            found = rows_per_member;
+        }
+
+        for(int k = 0; k < found; k++) {
+            beam_child(&s->children[i * rows_per_member + k], m, i, rows[k], closed[k]);
+        }
+        for(int k = found; k < rows_per_member; k++) {
+            s->children[i * rows_per_member + k].parent = -1;
+        }
+    }
+
+    free(rows);
+    free(closed);
+    free(t->occ);
+
+    return NULL;
+}
+
+static int compare_children(const void* a, const void* b) {
+    const Beam_child* x = a;
+    const Beam_child* y = b;
+
+    /* Unused slots last */
+    if((x->parent < 0) != (y->parent < 0)) {
+        return x->parent < 0 ? 1 : -1;
+    }
+    if(x->score != y->score) {
+        return x->score < y->score ? -1 : 1;
+    }
+    if(x->count != y->count) {
+        return x->count < y->count ? -1 : 1;
+    }
+    if(x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+
+    return x->parent - y->parent;
+}
+
+int main(int argc, char** argv) {
+    struct timespec start;
+    const char* path = ADJ_MATRIX_FILE;
+    const char* out_path = NULL;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int target = GRAPH_MAX_ORDER;
+    int prefix = 0;
+    Beam_member* beam;
+    Beam_member* next;
+    Beam_shared shared;
+    Beam_thread* workers;
+    int beam_count = 1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:p:w:k:n:t:r:o:")) != -1) {
+        switch(opt) {
+        case 'c':
+            if(sscanf(optarg, "%d,%d", &clique_size[0], &clique_size[1]) != 2 ||
+               clique_size[0] < 3 || clique_size[1] < 3) {
+                usage(argv[0]);
+            }
+            break;
+        case 'p':
+            prefix = atoi(optarg);
+            break;
+        case 'w':
+            width = atoi(optarg);
+            break;
+        case 'k':
+            rows_per_member = atoi(optarg);
+            break;
+        case 'n':
+            target = atoi(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'r':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind > 1) {
+        usage(argv[0]);
+    }
+    if(argc - optind == 1) {
+        path = argv[optind];
+    }
+    if(width < 1 || rows_per_member < 1 || rows_per_member > BEAM_RESTARTS ||
+       target > GRAPH_MAX_ORDER) {
+        usage(argv[0]);
+    }
+    if(threads < 1) {
+        threads = 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    beam = calloc(width, sizeof(Beam_member));
+    next = calloc(width, sizeof(Beam_member));
+    shared.children = malloc(sizeof(Beam_child) * width * rows_per_member);
+    workers = calloc(threads, sizeof(Beam_thread));
+    if(beam == NULL || next == NULL || shared.children == NULL || workers == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    graph_load(&beam[0].g, path);
+    if(prefix > 0 && prefix < beam[0].g.order) {
+        Graph full = beam[0].g;
+
+        graph_init(&beam[0].g, prefix);
+        for(int u = 0; u < prefix; u++) {
+            for(int v = u + 1; v < prefix; v++) {
+                graph_set(&beam[0].g, u, v, graph_color(&full, u, v));
+            }
+        }
+    }
+    beam[0].score = beam_score(&beam[0].g);
+    beam[0].cliques = ext_from_graph(&beam[0].g, clique_size[0], clique_size[1], &beam[0].count);
+    beam[0].size = beam[0].count;
+
+    printf("Beam search for R(%d, %d) colorings from order %d (score %llu), width %d, %d children each\n",
+           clique_size[0], clique_size[1], beam[0].g.order, (unsigned long long) beam[0].score,
+           width, rows_per_member);
+
+    pthread_mutex_init(&shared.lock, NULL);
+
+    while(beam[0].g.order < target) {
+        int order = beam[0].g.order + 1;
+        int kept = 0;
+
+        shared.beam = beam;
+        shared.beam_count = beam_count;
+        shared.child_count = beam_count * rows_per_member;
+        shared.next = 0;
+
+        for(int i = 0; i < threads; i++) {
+            memset(&workers[i], 0, sizeof(Beam_thread));
+            workers[i].shared = &shared;
+            if(pthread_create(&workers[i].thread, NULL, beam_worker, &workers[i]) != 0) {
+                perror("Could not create thread");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for(int i = 0; i < threads; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+
+        qsort(shared.children, shared.child_count, sizeof(Beam_child), compare_children);
+
+        /* Take the best children, skipping any isomorphic to one already
+           taken; equal canonical forms sort next to each other unless their
+           scores differ, which isomorphic colorings' cannot */
+        for(int i = 0; i < shared.child_count && kept < width; i++) {
+            const Beam_child* c = &shared.children[i];
+            const Beam_member* parent;
+            Beam_member* m;
+
+            if(c->parent < 0) {
+                break;
+            }
+            if(i > 0 && c->hash == shared.children[i - 1].hash &&
+               memcmp(c->canon, shared.children[i - 1].canon, sizeof(uint64_t) * order) == 0) {
+                continue;
+            }
+
+            parent = &beam[c->parent];
+            m = &next[kept++];
+            m->g = parent->g;
+            m->g.order = order;
+            m->g.nbr[0][order - 1] = 0;
+            m->g.nbr[1][order - 1] = 0;
+            for(int v = 0; v < order - 1; v++) {
+                graph_set(&m->g, v, order - 1, (c->row >> v) & 1);
+            }
+            m->score = c->score;
+
+            if(m->size < parent->count) {
+                m->size = parent->count;
+                m->cliques = realloc(m->cliques, sizeof(Ext_clique) * m->size);
+                if(m->cliques == NULL) {
+                    perror("Could not alloc");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            memcpy(m->cliques, parent->cliques, sizeof(Ext_clique) * parent->count);
+            m->count = parent->count;
+            ext_add_vertex(&m->g, clique_size[0], clique_size[1], &m->cliques, &m->count, &m->size);
+        }
+
+        if(kept == 0) {
+            break;
+        }
+
+        /* The old beam's buffers are reused for the next order */
+        {
+            Beam_member* t = beam;
+
+            beam = next;
+            next = t;
+        }
+        beam_count = kept;
+
+        printf("Order %d: best score %llu (%d cliques to extend), worst kept %llu, %d kept, %.2fs\n",
+               order, (unsigned long long) beam[0].score, beam[0].count,
+               (unsigned long long) beam[beam_count - 1].score, beam_count, elapsed(&start));
+        fflush(stdout);
+    }
+
+    if(out_path != NULL) {
+        FILE* f = fopen(out_path, "w");
+
+        if(f == NULL) {
+            perror("Could not open output file");
+            exit(EXIT_FAILURE);
+        }
+        graph_dump(&beam[0].g, f);
+        fclose(f);
+    }
+
+    pthread_mutex_destroy(&shared.lock);
+    for(int i = 0; i < width; i++) {
+        free(beam[i].cliques);
+        free(next[i].cliques);
+    }
+    free(beam);
+    free(next);
+    free(shared.children);
+    free(workers);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,304 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bnb.h"
+
+/* Branch and bound state */
+typedef struct {
+    const Ext_clique* cliques;
+    int count;
+    int order;
+
+    /* Open cliques at each depth of the search */
+    int* open[EXT_MAX_ORDER + 1];
+
+    /* Cliques already used by a conflict in the current lower bound, marked
+       with the bound's epoch so they need not be cleared between bounds */
+    uint32_t* used;
+    uint32_t epoch;
+
+    uint64_t best_row;
+    int best;
+
+    uint64_t nodes;
+    uint64_t pruned;
+    int max_bound;
+
+    /* Certificate output, and the conflict sets of the last lower bound: each
+       set's cliques followed by -1 */
+    FILE* proof;
+    int* sets;
+    int set_len;
+} Bnb;
+
+/* Is the clique satisfied, i.e. is one of its assigned vertices colored
+   differently from the clique */
+static inline bool bnb_satisfied(const Ext_clique* clique, uint64_t assigned, uint64_t values) {
+    uint64_t same = clique->cc ? values : ~values;
+
+    return (clique->mask & assigned & ~same) != 0;
+}
+
+/* Lower bound on the number of open cliques which must still be closed under
+   the partial row. Repeatedly unit propagates the open cliques not yet used
+   (treating them as hard) until one is closed, then retires the closed clique
+   together with every clique whose propagation led to it. Each retired set is
+   disjoint from the others and cannot stay open as a whole, so each adds one
+   to the bound. Stops early once need is reached. Every clique has at least
+   two open vertices until some of the row is assigned, so the bound is 0 at
+   the root and only bites deeper in the search.
+
+   O(n * m), n = open cliques, m = bound reached
+ */
+static int bnb_lower_bound(Bnb* b, const int* open, int n, uint64_t assigned,
+                           uint64_t values, int need) {
+    int reason[EXT_MAX_ORDER];
+    int lb = 0;
+
+    b->epoch++;
+    b->set_len = 0;
+
+    while(lb < need) {
+        uint64_t a = assigned;
+        uint64_t v = values;
+        int conflict = -1;
+        bool changed = true;
+
+        while(changed && conflict < 0) {
+            changed = false;
+
+            for(int i = 0; i < n; i++) {
+                int c = open[i];
+                const Ext_clique* clique = &b->cliques[c];
+                uint64_t rem;
+
+                if(b->used[c] == b->epoch || bnb_satisfied(clique, a, v)) {
+                    continue;
+                }
+
+                rem = clique->mask & ~a;
+                if(rem == 0) {
+                    conflict = c;
+                    break;
+                }
+
+                /* Unit: the last open vertex must differ from the clique */
+                if((rem & (rem - 1)) == 0) {
+                    a |= rem;
+                    if(clique->cc) {
+                        v &= ~rem;
+                    } else {
+                        v |= rem;
+                    }
+                    reason[__builtin_ctzll(rem)] = c;
+                    changed = true;
+                }
+            }
+        }
+
+        if(conflict < 0) {
+            break;
+        }
+
+        /* Retire the conflict and the reasons for every propagated vertex it
+           depends on */
+        {
+            int stack[EXT_MAX_ORDER + 1];
+            int top = 0;
+            uint64_t seen = 0;
+
+            stack[top++] = conflict;
+            while(top > 0) {
+                int c = stack[--top];
+                uint64_t implied = b->cliques[c].mask & a & ~assigned & ~seen;
+
+                b->used[c] = b->epoch;
+                b->sets[b->set_len++] = c;
+                seen |= implied;
+                while(implied) {
+                    stack[top++] = reason[__builtin_ctzll(implied)];
+                    implied &= implied - 1;
+                }
+            }
+        }
+
+        b->sets[b->set_len++] = -1;
+        lb++;
+    }
+
+    return lb;
+}
+
+/* Choose the open vertex to branch on, weighting cliques with fewer open
+   vertices more heavily. first is set to the value which satisfies the
+   heavier side */
+static int bnb_choose(Bnb* b, const int* open, int n, uint64_t assigned, color* first) {
+    uint32_t red[EXT_MAX_ORDER] = {0};
+    uint32_t blue[EXT_MAX_ORDER] = {0};
+    uint32_t best_score = 0;
+    int best = -1;
+
+    for(int i = 0; i < n; i++) {
+        const Ext_clique* clique = &b->cliques[open[i]];
+        uint64_t rem = clique->mask & ~assigned;
+        uint32_t w = ext_weight(clique, rem);
+        uint32_t* score = clique->cc ? blue : red;
+
+        while(rem) {
+            score[__builtin_ctzll(rem)] += w;
+            rem &= rem - 1;
+        }
+    }
+
+    for(int v = 0; v < b->order; v++) {
+        uint32_t score = red[v] + blue[v];
+
+        if(score > best_score) {
+            best_score = score;
+            best = v;
+        }
+    }
+
+    /* A red clique is satisfied by a blue edge */
+    *first = red[best] >= blue[best];
+    return best;
+}
+
+/* Write a pruned leaf to the certificate with the conflict sets of the last
+   lower bound, or none */
+static void bnb_prove_leaf(Bnb* b, int lb) {
+    int i = 0;
+
+    if(b->proof == NULL) {
+        return;
+    }
+
+    fprintf(b->proof, "x %d\n", lb);
+    for(int k = 0; k < lb; k++) {
+        for(; b->sets[i] >= 0; i++) {
+            fprintf(b->proof, "%d ", b->sets[i] + 1);
+        }
+        fprintf(b->proof, "0\n");
+        i++;
+    }
+}
+
+static void bnb_dfs(Bnb* b, int depth, int n, uint64_t assigned, uint64_t values, int cost) {
+    const int* open = b->open[depth];
+    color first;
+    int v, lb;
+
+    b->nodes++;
+
+    if(cost >= b->best) {
+        bnb_prove_leaf(b, 0);
+        b->pruned++;
+        return;
+    }
+
+    /* Every clique is settled, so the remaining vertices are free */
+    if(n == 0) {
+        bnb_prove_leaf(b, 0);
+        b->best = cost;
+        b->best_row = values;
+        return;
+    }
+
+    lb = bnb_lower_bound(b, open, n, assigned, values, b->best - cost);
+    if(cost + lb >= b->best) {
+        bnb_prove_leaf(b, lb);
+        b->pruned++;
+        if(lb > b->max_bound) {
+            b->max_bound = lb;
+        }
+        return;
+    }
+
+    v = bnb_choose(b, open, n, assigned, &first);
+    if(b->proof != NULL) {
+        fprintf(b->proof, "b %d %d\n", v, first);
+    }
+
+    for(int k = 0; k < 2; k++) {
+        uint64_t bit = ((uint64_t)1) << v;
+        color value = k ? !first : first;
+        uint64_t a = assigned | bit;
+        uint64_t vals = value ? values | bit : values & ~bit;
+        int* next = b->open[depth + 1];
+        int m = 0;
+        int closed = 0;
+
+        for(int i = 0; i < n; i++) {
+            const Ext_clique* clique = &b->cliques[open[i]];
+
+            if(!(clique->mask & bit)) {
+                next[m++] = open[i];
+            } else if(value == clique->cc) {
+                if((clique->mask & ~a) == 0) {
+                    closed++;
+                } else {
+                    next[m++] = open[i];
+                }
+            }
+        }
+
+        bnb_dfs(b, depth + 1, m, a, vals, cost + closed);
+    }
+}
+
+/* Find a row closing the fewest cliques. start_row gives the initial upper
+   bound; the search proves it optimal or replaces it with a better row. If
+   proof is given the search tree is written to it as a certificate */
+void bnb_search(const Ext_clique* cliques, int count, int order,
+                uint64_t start_row, FILE* proof, Bnb_result* result) {
+    Bnb b;
+    int i;
+
+    b.cliques = cliques;
+    b.count = count;
+    b.order = order;
+    b.epoch = 0;
+    b.best_row = start_row;
+    b.best = ext_count_violations(cliques, count, start_row);
+    b.nodes = 0;
+    b.pruned = 0;
+    b.max_bound = 0;
+    b.proof = NULL;
+
+    b.used = calloc(count + 1, sizeof(uint32_t));
+    b.sets = malloc(sizeof(int) * 2 * (count + 1));
+    b.open[0] = malloc(sizeof(int) * (count + 1) * (order + 1));
+    if(b.used == NULL || b.sets == NULL || b.open[0] == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(i = 1; i <= order; i++) {
+        b.open[i] = b.open[0] + i * (count + 1);
+    }
+    for(i = 0; i < count; i++) {
+        b.open[0][i] = i;
+    }
+
+    if(proof != NULL) {
+        b.proof = proof;
+        fprintf(proof, "p bnb %d %d\n", order, count);
+    }
+
+    bnb_dfs(&b, 0, count, 0, 0, 0);
+
+    if(proof != NULL) {
+        fprintf(proof, "o %d %llx\n", b.best, (unsigned long long) b.best_row);
+    }
+
+    result->row = b.best_row;
+    result->violations = b.best;
+    result->nodes = b.nodes;
+    result->pruned = b.pruned;
+    result->max_bound = b.max_bound;
+
+    free(b.used);
+    free(b.sets);
+    free(b.open[0]);
+}
@@ -0,0 +1,47 @@
+/**
+ * Exact minimum-violation extension by branch and bound. Row bits are fixed
+ * one at a time; a subtree is pruned when the cliques it has already closed
+ * plus a lower bound on the cliques it must still close reach the best row
+ * known. The lower bound is MaxSAT style: disjoint sets of still open cliques
+ * which unit propagation shows cannot all stay open, each of which costs at
+ * least one closed clique.
+ *
+ * The search tree can be written out as a certificate of optimality, in
+ * preorder:
+ *
+ *   p bnb <order> <cliques>
+ *   b <vertex> <value>      branch on vertex, value first; both subtrees follow
+ *   x <k>                   leaf, followed by k lines each listing a conflict
+ *                           set (clique indices from 1, terminated by 0)
+ *   o <violations> <row>    the optimum and a row achieving it, in hex
+ *
+ * Clique indices follow the lexicographic order of the 4-cliques. At every
+ * leaf, the cliques closed by its partial row plus its conflict sets must
+ * reach the optimum.
+ */
+
+#ifndef BNB_H
+#define BNB_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "extension.h"
+
+typedef struct {
+    /* Optimal row and the number of cliques it closes */
+    uint64_t row;
+    int violations;
+
+    /* Largest lower bound which pruned a subtree, 0 if none did */
+    int max_bound;
+
+    /* Search tree size */
+    uint64_t nodes;
+    uint64_t pruned;
+} Bnb_result;
+
+void bnb_search(const Ext_clique* cliques, int count, int order,
+                uint64_t start_row, FILE* proof, Bnb_result* result);
+
+#endif
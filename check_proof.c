@@ -0,0 +1,654 @@
+/**
+ * Purpose: Independently check a proof written by extend_graph -p that a base
+ *  graph has no clique-less one-vertex extension, or that every extension
+ *  closes at least some number of monochromatic 5-cliques.
+ *
+ * Theory of operation: The base graph is loaded and its monochromatic
+ *  4-cliques are enumerated afresh; nothing is taken from the proof except the
+ *  steps themselves. Two kinds of proof are understood:
+ *
+ *  - DRUP proofs from the SAT engines. The formula has one variable per edge
+ *    of the new vertex and one clause per 4-clique forbidding the edges from
+ *    all matching its color. Every lemma must follow from the formula and the
+ *    lemmas before it by unit propagation, and the proof must end in the empty
+ *    clause. Deletions are ignored, which can only make lemmas easier to
+ *    check.
+ *
+ *  - Branch and bound certificates, starting "p bnb". The search tree must be
+ *    complete and at every leaf the cliques closed by its partial row plus its
+ *    conflict sets, each of which unit propagation must show cannot stay open
+ *    as a whole, must reach the claimed optimum. The witness row must close
+ *    exactly that many cliques.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Graph checked when none is given on the command line */
+#define ADJ_MATRIX_FILE "g55.42"
+
+/* Largest base graph a row can be packed for */
+#define MAX_ORDER 64
+
+/* Color of each edge (0 -> red, 1 -> blue) */
+typedef uint8_t color;
+
+/* A monochromatic 4-clique of the base graph */
+typedef struct {
+    uint64_t mask;
+    color cc;
+} Clique;
+
+/* Internally a literal is 2 * (var - 1), plus 1 when negated */
+#define LIT(d) ((d) > 0 ? 2 * ((d) - 1) : 2 * (-(d) - 1) + 1)
+#define NEG(l) ((l) ^ 1)
+
+/* Clause database for unit propagation with two watched literals */
+typedef struct {
+    int vars;
+
+    int* lits;
+    int lit_count;
+    int lit_cap;
+    int* start;
+    int* size;
+    int clause_count;
+    int clause_cap;
+
+    /* Clauses watching each literal */
+    int** watches;
+    int* watch_count;
+    int* watch_cap;
+
+    /* Per literal: 1 true, -1 false, 0 unassigned */
+    int8_t* value;
+    int* trail;
+    int trail_size;
+    int qhead;
+
+    /* Set once top level propagation has found a conflict */
+    bool refuted;
+} Db;
+
+static void* xrealloc(void* p, size_t size) {
+    p = realloc(p, size);
+    if(p == NULL && size > 0) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    return p;
+}
+
+static int load_matrix(const char* path, color matrix[MAX_ORDER][MAX_ORDER]) {
+    FILE* f = fopen(path, "r");
+    int order = 0;
+    int i = 0;
+    int c;
+
+    if(f == NULL) {
+        perror("Could not open adjacency matrix");
+        exit(EXIT_FAILURE);
+    }
+
+    /* The first row gives the order */
+    while((c = fgetc(f)) != EOF && c != '\n') {
+        if(c == '0' || c == '1') {
+            if(order == MAX_ORDER) {
+                fprintf(stderr, "Error: graph has more than %d vertices\n", MAX_ORDER);
+                exit(EXIT_FAILURE);
+            }
+            matrix[0][order++] = c - '0';
+        }
+    }
+
+    i = order;
+    while((c = fgetc(f)) != EOF) {
+        if(c == '0' || c == '1') {
+            if(i == order * order) {
+                i++;
+                break;
+            }
+            matrix[i / order][i % order] = c - '0';
+            i++;
+        }
+    }
+    fclose(f);
+
+    if(order == 0 || i != order * order) {
+        fprintf(stderr, "Error: invalid matrix size\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(i = 0; i < order; i++) {
+        for(int j = 0; j < i; j++) {
+            if(matrix[i][j] != matrix[j][i]) {
+                fprintf(stderr, "Error: matrix is not symmetric at %d, %d\n", i, j);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    return order;
+}
+
+/* Enumerate the monochromatic 4-cliques in lexicographic order */
+static Clique* find_four_cliques(color matrix[MAX_ORDER][MAX_ORDER], int order, int* count) {
+    uint64_t nbr[2][MAX_ORDER] = {{0}};
+    Clique* cliques = NULL;
+    int cap = 0;
+    int n = 0;
+
+    for(int i = 0; i < order; i++) {
+        for(int j = 0; j < order; j++) {
+            if(i != j) {
+                nbr[matrix[i][j]][i] |= ((uint64_t)1) << j;
+            }
+        }
+    }
+
+    for(int a = 0; a < order; a++) {
+        for(int b = a + 1; b < order; b++) {
+            color cc = matrix[a][b];
+            uint64_t ab = nbr[cc][a] & nbr[cc][b];
+
+            for(int c = b + 1; c < order; c++) {
+                uint64_t abc;
+
+                if(!((ab >> c) & 1)) {
+                    continue;
+                }
+
+                abc = ab & nbr[cc][c] & ~((((uint64_t)2) << c) - 1);
+                for(; abc; abc &= abc - 1) {
+                    if(n == cap) {
+                        cap = cap ? 2 * cap : 1024;
+                        cliques = xrealloc(cliques, cap * sizeof(Clique));
+                    }
+                    cliques[n].mask = (((uint64_t)1) << a) | (((uint64_t)1) << b) |
+                        (((uint64_t)1) << c) | (abc & -abc);
+                    cliques[n].cc = cc;
+                    n++;
+                }
+            }
+        }
+    }
+
+    *count = n;
+    return cliques;
+}
+
+/* Read the next integer from a proof, skipping "d" deletion markers which are
+   reported through deletion. Returns false at end of file */
+static bool read_int(FILE* f, int* value, bool* deletion) {
+    int c, sign = 1, v = 0;
+
+    while((c = getc(f)) != EOF) {
+        if(c == 'd') {
+            *deletion = true;
+        } else if(c == '-' || (c >= '0' && c <= '9')) {
+            break;
+        }
+    }
+    if(c == EOF) {
+        return false;
+    }
+
+    if(c == '-') {
+        sign = -1;
+        c = getc(f);
+    }
+    while(c >= '0' && c <= '9') {
+        v = 10 * v + (c - '0');
+        c = getc(f);
+    }
+
+    *value = sign * v;
+    return true;
+}
+
+static void db_assign(Db* db, int lit) {
+    db->value[lit] = 1;
+    db->value[NEG(lit)] = -1;
+    db->trail[db->trail_size++] = lit;
+}
+
+static void db_undo(Db* db, int size) {
+    while(db->trail_size > size) {
+        int lit = db->trail[--db->trail_size];
+
+        db->value[lit] = db->value[NEG(lit)] = 0;
+    }
+    db->qhead = size;
+}
+
+static void db_watch(Db* db, int lit, int clause) {
+    if(db->watch_count[lit] == db->watch_cap[lit]) {
+        db->watch_cap[lit] = db->watch_cap[lit] ? 2 * db->watch_cap[lit] : 8;
+        db->watches[lit] = xrealloc(db->watches[lit], db->watch_cap[lit] * sizeof(int));
+    }
+    db->watches[lit][db->watch_count[lit]++] = clause;
+}
+
+/* Propagate the trail. Returns false on conflict */
+static bool db_propagate(Db* db) {
+    while(db->qhead < db->trail_size) {
+        int false_lit = NEG(db->trail[db->qhead++]);
+        int* ws = db->watches[false_lit];
+        int n = db->watch_count[false_lit];
+        int i = 0, j = 0;
+
+        while(i < n) {
+            int c = ws[i++];
+            int* lits = db->lits + db->start[c];
+            int k;
+
+            if(lits[0] == false_lit) {
+                lits[0] = lits[1];
+                lits[1] = false_lit;
+            }
+
+            if(db->value[lits[0]] == 1) {
+                ws[j++] = c;
+                continue;
+            }
+
+            for(k = 2; k < db->size[c]; k++) {
+                if(db->value[lits[k]] != -1) {
+                    lits[1] = lits[k];
+                    lits[k] = false_lit;
+                    db_watch(db, lits[1], c);
+                    break;
+                }
+            }
+            if(k < db->size[c]) {
+                continue;
+            }
+
+            ws[j++] = c;
+            if(db->value[lits[0]] == -1) {
+                while(i < n) {
+                    ws[j++] = ws[i++];
+                }
+                db->watch_count[false_lit] = j;
+                return false;
+            }
+            db_assign(db, lits[0]);
+        }
+
+        db->watch_count[false_lit] = j;
+    }
+
+    return true;
+}
+
+/* Add a clause of internal literals at the top level */
+static void db_add(Db* db, const int* lits, int n) {
+    int* c;
+    int free_count = 0;
+
+    if(db->refuted) {
+        return;
+    }
+
+    for(int i = 0; i < n; i++) {
+        if(db->value[lits[i]] == 1) {
+            return;
+        }
+    }
+
+    if(db->clause_count == db->clause_cap) {
+        db->clause_cap = db->clause_cap ? 2 * db->clause_cap : 1024;
+        db->start = xrealloc(db->start, db->clause_cap * sizeof(int));
+        db->size = xrealloc(db->size, db->clause_cap * sizeof(int));
+    }
+    while(db->lit_count + n > db->lit_cap) {
+        db->lit_cap = db->lit_cap ? 2 * db->lit_cap : 4096;
+        db->lits = xrealloc(db->lits, db->lit_cap * sizeof(int));
+    }
+
+    /* Unassigned literals first so they are the ones watched */
+    c = db->lits + db->lit_count;
+    for(int i = 0; i < n; i++) {
+        if(db->value[lits[i]] == 0) {
+            c[free_count++] = lits[i];
+        }
+    }
+    if(free_count == 0) {
+        db->refuted = true;
+        return;
+    }
+    if(free_count == 1) {
+        db_assign(db, c[0]);
+        db->refuted = !db_propagate(db);
+        return;
+    }
+
+    for(int i = 0, k = free_count; i < n; i++) {
+        if(db->value[lits[i]] != 0) {
+            c[k++] = lits[i];
+        }
+    }
+
+    db->start[db->clause_count] = db->lit_count;
+    db->size[db->clause_count] = n;
+    db->lit_count += n;
+    db_watch(db, c[0], db->clause_count);
+    db_watch(db, c[1], db->clause_count);
+    db->clause_count++;
+}
+
+/* Is the clause implied by unit propagation */
+static bool db_rup(Db* db, const int* lits, int n) {
+    int mark = db->trail_size;
+    bool implied;
+
+    if(db->refuted) {
+        return true;
+    }
+
+    for(int i = 0; i < n; i++) {
+        if(db->value[lits[i]] == 1) {
+            db_undo(db, mark);
+            return true;
+        }
+        if(db->value[lits[i]] == 0) {
+            db_assign(db, NEG(lits[i]));
+        }
+    }
+
+    implied = !db_propagate(db);
+    db_undo(db, mark);
+
+    return implied;
+}
+
+static void check_drup(FILE* proof, const Clique* cliques, int count, int order) {
+    Db db;
+    int* lemma = NULL;
+    int cap = 0;
+    int n = 0;
+    int lemmas = 0;
+    int lit;
+    bool deletion = false;
+
+    memset(&db, 0, sizeof(Db));
+    db.vars = order;
+    db.watches = xrealloc(NULL, 2 * order * sizeof(int*));
+    db.watch_count = xrealloc(NULL, 2 * order * sizeof(int));
+    db.watch_cap = xrealloc(NULL, 2 * order * sizeof(int));
+    db.value = xrealloc(NULL, 2 * order * sizeof(int8_t));
+    db.trail = xrealloc(NULL, order * sizeof(int));
+    for(int l = 0; l < 2 * order; l++) {
+        db.watches[l] = NULL;
+        db.watch_count[l] = db.watch_cap[l] = 0;
+        db.value[l] = 0;
+    }
+
+    /* The formula: some edge into each clique differs from its color */
+    for(int i = 0; i < count; i++) {
+        int lits[4];
+        int k = 0;
+
+        for(uint64_t m = cliques[i].mask; m; m &= m - 1) {
+            int var = __builtin_ctzll(m) + 1;
+
+            lits[k++] = LIT(cliques[i].cc ? -var : var);
+        }
+        db_add(&db, lits, k);
+    }
+
+    while(read_int(proof, &lit, &deletion)) {
+        if(lit != 0) {
+            if(lit > order || lit < -order) {
+                fprintf(stderr, "Error: lemma %d uses unknown variable %d\n", lemmas + 1, lit);
+                exit(EXIT_FAILURE);
+            }
+            if(n == cap) {
+                cap = cap ? 2 * cap : 64;
+                lemma = xrealloc(lemma, cap * sizeof(int));
+            }
+            lemma[n++] = LIT(lit);
+            continue;
+        }
+
+        if(!deletion) {
+            lemmas++;
+            if(!db_rup(&db, lemma, n)) {
+                fprintf(stderr, "Error: lemma %d is not implied by unit propagation\n", lemmas);
+                exit(EXIT_FAILURE);
+            }
+            if(n == 0) {
+                printf("Verified: %d lemmas derive the empty clause\n", lemmas);
+                printf("No clique-less extension of the graph exists\n");
+                free(lemma);
+                return;
+            }
+            db_add(&db, lemma, n);
+        }
+
+        n = 0;
+        deletion = false;
+    }
+
+    fprintf(stderr, "Error: proof ends without the empty clause (%d lemmas checked)\n", lemmas);
+    exit(EXIT_FAILURE);
+}
+
+/* Check one leaf of a branch and bound certificate under the partial row and
+   return the bound it proves */
+static int check_leaf(FILE* proof, const Clique* cliques, int count, uint32_t* stamp,
+                      uint32_t leaf, uint64_t assigned, uint64_t values) {
+    int bound = 0;
+    int sets, index;
+    bool deletion = false;
+
+    /* Cliques already closed */
+    for(int i = 0; i < count; i++) {
+        uint64_t same = cliques[i].cc ? values : ~values;
+
+        if((cliques[i].mask & ~assigned) == 0 && (cliques[i].mask & same) == cliques[i].mask) {
+            bound++;
+        }
+    }
+
+    if(!read_int(proof, &sets, &deletion) || sets < 0) {
+        fprintf(stderr, "Error: truncated leaf\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int k = 0; k < sets; k++) {
+        int set[MAX_ORDER + 1];
+        int n = 0;
+        uint64_t a = assigned;
+        uint64_t v = values;
+        bool changed = true;
+        bool conflict = false;
+
+        while(read_int(proof, &index, &deletion) && index != 0) {
+            const Clique* c;
+            uint64_t same;
+
+            if(index < 1 || index > count || n > MAX_ORDER) {
+                fprintf(stderr, "Error: invalid conflict set\n");
+                exit(EXIT_FAILURE);
+            }
+            if(stamp[index - 1] == leaf) {
+                fprintf(stderr, "Error: clique %d used twice in one leaf\n", index);
+                exit(EXIT_FAILURE);
+            }
+            stamp[index - 1] = leaf;
+
+            /* The clique must still be open */
+            c = &cliques[index - 1];
+            same = c->cc ? values : ~values;
+            if((c->mask & assigned & ~same) != 0 || (c->mask & ~assigned) == 0) {
+                fprintf(stderr, "Error: conflict set uses settled clique %d\n", index);
+                exit(EXIT_FAILURE);
+            }
+
+            set[n++] = index - 1;
+        }
+
+        /* Unit propagate the set alone */
+        while(changed && !conflict) {
+            changed = false;
+
+            for(int i = 0; i < n; i++) {
+                const Clique* c = &cliques[set[i]];
+                uint64_t same = c->cc ? v : ~v;
+                uint64_t rem = c->mask & ~a;
+
+                if((c->mask & a & ~same) != 0) {
+                    continue;
+                }
+                if(rem == 0) {
+                    conflict = true;
+                    break;
+                }
+                if((rem & (rem - 1)) == 0) {
+                    a |= rem;
+                    v = c->cc ? v & ~rem : v | rem;
+                    changed = true;
+                }
+            }
+        }
+
+        if(!conflict) {
+            fprintf(stderr, "Error: conflict set does not propagate to a conflict\n");
+            exit(EXIT_FAILURE);
+        }
+
+        bound++;
+    }
+
+    return bound;
+}
+
+/* Check the subtree at the partial row and return the smallest bound proved
+   by its leaves */
+static int check_tree(FILE* proof, const Clique* cliques, int count, int order, uint32_t* stamp,
+                      uint32_t* leaves, uint64_t assigned, uint64_t values) {
+    int c;
+
+    do {
+        c = getc(proof);
+    } while(c == ' ' || c == '\n');
+
+    if(c == 'x') {
+        (*leaves)++;
+        return check_leaf(proof, cliques, count, stamp, *leaves, assigned, values);
+    }
+
+    if(c == 'b') {
+        bool deletion = false;
+        int vertex, first;
+        int bound[2];
+
+        if(!read_int(proof, &vertex, &deletion) || !read_int(proof, &first, &deletion) ||
+           vertex < 0 || vertex >= order || (first != 0 && first != 1) ||
+           ((assigned >> vertex) & 1)) {
+            fprintf(stderr, "Error: invalid branch\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for(int k = 0; k < 2; k++) {
+            uint64_t bit = ((uint64_t)1) << vertex;
+            int value = k ? !first : first;
+
+            bound[k] = check_tree(proof, cliques, count, order, stamp, leaves,
+                                  assigned | bit, value ? values | bit : values & ~bit);
+        }
+
+        return bound[0] < bound[1] ? bound[0] : bound[1];
+    }
+
+    fprintf(stderr, "Error: truncated or malformed search tree\n");
+    exit(EXIT_FAILURE);
+}
+
+static void check_bnb(FILE* proof, const Clique* cliques, int count, int order) {
+    uint32_t* stamp = calloc(count + 1, sizeof(uint32_t));
+    uint32_t leaves = 0;
+    int proof_order, proof_count, bound, optimum, violations = 0;
+    unsigned long long row;
+
+    if(fscanf(proof, " bnb %d %d", &proof_order, &proof_count) != 2 ||
+       proof_order != order || proof_count != count) {
+        fprintf(stderr, "Error: certificate is for a different graph\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bound = check_tree(proof, cliques, count, order, stamp, &leaves, 0, 0);
+
+    if(fscanf(proof, " o %d %llx", &optimum, &row) != 2) {
+        fprintf(stderr, "Error: certificate has no optimum\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < count; i++) {
+        uint64_t same = cliques[i].cc ? row : ~row;
+
+        if((cliques[i].mask & same) == cliques[i].mask) {
+            violations++;
+        }
+    }
+
+    if(violations != optimum) {
+        fprintf(stderr, "Error: witness row closes %d cliques, not %d\n", violations, optimum);
+        exit(EXIT_FAILURE);
+    }
+    if(bound < optimum) {
+        fprintf(stderr, "Error: search tree only proves a bound of %d\n", bound);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Verified: %u leaves prove every row closes at least %d 5-cliques\n", leaves, optimum);
+    if(optimum > 0) {
+        printf("No clique-less extension of the graph exists\n");
+    }
+
+    free(stamp);
+}
+
+int main(int argc, char** argv) {
+    static color matrix[MAX_ORDER][MAX_ORDER];
+    const char* graph = ADJ_MATRIX_FILE;
+    Clique* cliques;
+    FILE* proof;
+    int order, count, c;
+
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s proof [graph]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(argc == 3) {
+        graph = argv[2];
+    }
+
+    order = load_matrix(graph, matrix);
+    cliques = find_four_cliques(matrix, order, &count);
+    printf("Loaded %d-vertex graph with %d monochromatic 4-cliques\n", order, count);
+
+    proof = fopen(argv[1], "r");
+    if(proof == NULL) {
+        perror("Could not open proof");
+        return EXIT_FAILURE;
+    }
+
+    c = getc(proof);
+    if(c == 'p') {
+        check_bnb(proof, cliques, count, order);
+    } else {
+        ungetc(c, proof);
+        check_drup(proof, cliques, count, order);
+    }
+
+    fclose(proof);
+    free(cliques);
+
+    return 0;
+}
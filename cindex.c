@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cindex.h"
+
+/* A growable list of clique ids */
+typedef struct {
+    int* ids;
+    int count;
+    int cap;
+} Cindex_list;
+
+struct Cindex_s {
+    Graph g;
+    int k;
+
+    /* Clique slots. pos[id][i] is the position of the clique in the list of
+       its i-th lowest vertex */
+    Ext_clique* cliques;
+    int (*pos)[CINDEX_MAX_K];
+    bool* live;
+    int slots;
+    int cap;
+    int count;
+
+    Cindex_list vertex[GRAPH_MAX_ORDER];
+
+    /* Endpoints of the edge being flipped, which every clique visited
+       contains besides the vertices enumerated */
+    uint64_t through;
+
+    /* Slots free for reuse, and the changes made by the last flip */
+    Cindex_list free;
+    Cindex_list removed;
+    Cindex_list added;
+};
+
+static void cindex_push(Cindex_list* l, int id) {
+    if(l->count == l->cap) {
+        l->cap = l->cap ? 2 * l->cap : 64;
+        l->ids = realloc(l->ids, sizeof(int) * l->cap);
+        if(l->ids == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    l->ids[l->count++] = id;
+}
+
+/* Index of vertex v among the vertices of mask, lowest first */
+static inline int cindex_rank(uint64_t mask, int v) {
+    return __builtin_popcountll(mask & ((((uint64_t)1) << v) - 1));
+}
+
+static void cindex_add(Cindex* x, uint64_t mask, color cc) {
+    int id, i = 0;
+
+    if(x->free.count > 0) {
+        id = x->free.ids[--x->free.count];
+    } else {
+        if(x->slots == x->cap) {
+            x->cap = x->cap ? 2 * x->cap : 1024;
+            x->cliques = realloc(x->cliques, sizeof(Ext_clique) * x->cap);
+            x->pos = realloc(x->pos, sizeof(*x->pos) * x->cap);
+            x->live = realloc(x->live, sizeof(bool) * x->cap);
+            if(x->cliques == NULL || x->pos == NULL || x->live == NULL) {
+                perror("Could not alloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        id = x->slots++;
+    }
+
+    x->cliques[id].mask = mask;
+    x->cliques[id].cc = cc;
+    x->live[id] = true;
+    x->count++;
+
+    for(uint64_t m = mask; m; m &= m - 1, i++) {
+        Cindex_list* l = &x->vertex[__builtin_ctzll(m)];
+
+        x->pos[id][i] = l->count;
+        cindex_push(l, id);
+    }
+
+    cindex_push(&x->added, id);
+}
+
+/* Unlink the clique from its vertices' lists, moving the last entry of each
+   list into the hole */
+static void cindex_remove(Cindex* x, int id) {
+    uint64_t mask = x->cliques[id].mask;
+    int i = 0;
+
+    for(uint64_t m = mask; m; m &= m - 1, i++) {
+        int v = __builtin_ctzll(m);
+        Cindex_list* l = &x->vertex[v];
+        int p = x->pos[id][i];
+        int last = l->ids[--l->count];
+
+        if(last != id) {
+            l->ids[p] = last;
+            x->pos[last][cindex_rank(x->cliques[last].mask, v)] = p;
+        }
+    }
+
+    x->live[id] = false;
+    x->count--;
+    cindex_push(&x->removed, id);
+}
+
+static void cindex_visit(const int* clique, int k, color cc, void* arg) {
+    Cindex* x = arg;
+    uint64_t mask = x->through;
+
+    for(int i = 0; i < k; i++) {
+        mask |= ((uint64_t)1) << clique[i];
+    }
+
+    cindex_add(x, mask, cc);
+}
+
+Cindex* cindex_new(const Graph* g, int k) {
+    Cindex* x = calloc(1, sizeof(Cindex));
+
+    if(x == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    if(k < 2 || k > CINDEX_MAX_K) {
+        fprintf(stderr, "Error: cliques of size %d can not be indexed\n", k);
+        exit(EXIT_FAILURE);
+    }
+
+    x->g = *g;
+    x->k = k;
+
+    graph_cliques(g, k, cindex_visit, x);
+    x->added.count = 0;
+
+    return x;
+}
+
+void cindex_free(Cindex* x) {
+    for(int v = 0; v < GRAPH_MAX_ORDER; v++) {
+        free(x->vertex[v].ids);
+    }
+    free(x->free.ids);
+    free(x->removed.ids);
+    free(x->added.ids);
+    free(x->cliques);
+    free(x->pos);
+    free(x->live);
+    free(x);
+}
+
+void cindex_flip(Cindex* x, int u, int v) {
+    Cindex_list* l;
+    uint64_t edge = (((uint64_t)1) << u) | (((uint64_t)1) << v);
+    color cc = !graph_color(&x->g, u, v);
+
+    /* Slots removed by the previous flip may be reused from now on */
+    for(int i = 0; i < x->removed.count; i++) {
+        cindex_push(&x->free, x->removed.ids[i]);
+    }
+    x->removed.count = 0;
+    x->added.count = 0;
+
+    /* Cliques through uv are found from the shorter of the two lists.
+       Removing swaps later entries down, so the list is walked from the end */
+    l = x->vertex[u].count <= x->vertex[v].count ? &x->vertex[u] : &x->vertex[v];
+    for(int i = l->count - 1; i >= 0; i--) {
+        if((x->cliques[l->ids[i]].mask & edge) == edge) {
+            cindex_remove(x, l->ids[i]);
+        }
+    }
+
+    graph_set(&x->g, u, v, cc);
+
+    x->through = edge;
+    graph_cliques_in(&x->g, x->k - 2, cc, x->g.nbr[cc][u] & x->g.nbr[cc][v], cindex_visit, x);
+    x->through = 0;
+}
+
+const Graph* cindex_graph(const Cindex* x) {
+    return &x->g;
+}
+
+const Ext_clique* cindex_cliques(const Cindex* x, int* slots) {
+    *slots = x->slots;
+    return x->cliques;
+}
+
+bool cindex_live(const Cindex* x, int id) {
+    return x->live[id];
+}
+
+int cindex_count(const Cindex* x) {
+    return x->count;
+}
+
+const int* cindex_vertex(const Cindex* x, int v, int* n) {
+    *n = x->vertex[v].count;
+    return x->vertex[v].ids;
+}
+
+const int* cindex_removed(const Cindex* x, int* n) {
+    *n = x->removed.count;
+    return x->removed.ids;
+}
+
+const int* cindex_added(const Cindex* x, int* n) {
+    *n = x->added.count;
+    return x->added.ids;
+}
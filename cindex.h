@@ -0,0 +1,55 @@
+/**
+ * Mutable index of the monochromatic k-cliques of a coloring, kept up to date
+ * as single edges are flipped. Flipping uv can only destroy or create cliques
+ * containing both u and v: the destroyed ones are found through a per-vertex
+ * inverted index from each vertex to the cliques containing it, and the
+ * created ones by enumerating (k - 2)-cliques of the new color in the common
+ * neighborhood of u and v. Nothing else is looked at, so a flip costs a tiny
+ * fraction of a full clique sweep.
+ *
+ * Cliques are identified by their position in the clique array, which is
+ * stable while they live. For k = 4 the entries are exactly the extension
+ * constraints of the coloring (see extension.h). The ids a flip removed keep
+ * their contents until the next flip, so callers can patch state derived
+ * from them; ids are only reused after that.
+ */
+
+#ifndef CINDEX_H
+#define CINDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "extension.h"
+#include "graph.h"
+
+/* Largest clique size indexed */
+#define CINDEX_MAX_K 8
+
+typedef struct Cindex_s Cindex;
+
+Cindex* cindex_new(const Graph* g, int k);
+void cindex_free(Cindex* x);
+
+/* Flip the color of edge uv and update the index */
+void cindex_flip(Cindex* x, int u, int v);
+
+/* The coloring as of the last flip */
+const Graph* cindex_graph(const Cindex* x);
+
+/* Every clique slot, live or not, and the number of slots. A slot is live
+   when it holds a current monochromatic clique */
+const Ext_clique* cindex_cliques(const Cindex* x, int* slots);
+bool cindex_live(const Cindex* x, int id);
+
+/* Number of live cliques */
+int cindex_count(const Cindex* x);
+
+/* Ids of the live cliques containing v */
+const int* cindex_vertex(const Cindex* x, int v, int* n);
+
+/* Ids removed and added by the last flip */
+const int* cindex_removed(const Cindex* x, int* n);
+const int* cindex_added(const Cindex* x, int* n);
+
+#endif
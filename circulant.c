@@ -0,0 +1,386 @@
+/**
+ * File: circulant.c
+ *
+ * Purpose: Exhaustive survey of circulant R(s, t) colorings of K_n. In a
+ *  circulant coloring on Z_n the color of edge xy only depends on the
+ *  difference y - x, so a coloring is the color of each difference 1..n/2.
+ *
+ *  Differences are colored in order by a backtracking search. Rotations are
+ *  automorphisms, so any monochromatic clique using an edge of difference d
+ *  can be moved onto vertices 0 and d; coloring d only needs a check for
+ *  cliques through 0 and d among the differences colored so far, done with
+ *  one bitset of differences per color. Colorings equal under a multiplier
+ *  x -> ux, u a unit of Z_n, (and for s == t swapping colors) are only
+ *  counted once: every partial coloring whose image under one of them is
+ *  already lexicographically smaller is pruned.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+/* Differences colored before subtrees are handed out to threads */
+#define CIRC_SPLIT_DEPTH 12
+
+#define CIRC_MAX_ORDER GRAPH_MAX_ORDER
+
+/* A transformation of colorings: the multiplier u, then a color swap if
+   flip is set */
+typedef struct {
+    int image[CIRC_MAX_ORDER / 2 + 1];
+    color flip;
+} Circ_symmetry;
+
+/* State shared between the search threads */
+typedef struct {
+    int order;
+    int half;
+    int size[2];
+    int split;
+
+    Circ_symmetry* symmetries;
+    int symmetry_count;
+
+    pthread_mutex_t lock;
+    uint64_t next_prefix;
+    uint64_t found;
+    uint64_t nodes;
+} Circ_shared;
+
+/* Per thread search state */
+typedef struct {
+    Circ_shared* shared;
+    pthread_t thread;
+
+    /* Color of each difference, and the differences of each color as a set
+       of vertices adjacent to 0 */
+    color colors[CIRC_MAX_ORDER / 2 + 1];
+    uint64_t nbr[2];
+
+    uint64_t nodes;
+} Circ_thread;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+static void survey(int order, int s, int t, int threads);
+
+static const char* output_prefix = NULL;
+static bool quiet = false;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-t threads] [-q] [-o prefix] <s> <t> <n> [n_max]\n"
+            "  -t  number of search threads (default number of processors)\n"
+            "  -q  only print the number of colorings of each order\n"
+            "  -o  also write coloring k of order n to prefix.n.k\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int gcd(int a, int b) {
+    while(b) {
+        int r = a % b;
+
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+/* The neighbors of x, given the neighbors of 0 */
+static inline uint64_t circ_rotate(uint64_t nbr, int x, int order) {
+    if(x == 0) {
+        return nbr;
+    }
+
+    return ((nbr << x) | (nbr >> (order - x))) & graph_all(order);
+}
+
+/* Is there a clique of need more vertices among cand */
+static bool circ_has_clique(uint64_t nbr, uint64_t cand, int need, int order) {
+    if(need == 0) {
+        return true;
+    }
+
+    for(; cand && __builtin_popcountll(cand) >= need; cand &= cand - 1) {
+        int v = __builtin_ctzll(cand);
+        uint64_t next = cand & circ_rotate(nbr, v, order) & ~((((uint64_t)2) << v) - 1);
+
+        if(circ_has_clique(nbr, next, need - 1, order)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Color difference d, returning false if that closes a monochromatic clique
+   or makes the coloring non-canonical */
+static bool circ_assign(Circ_thread* t, int d, color c) {
+    Circ_shared* s = t->shared;
+    uint64_t nbr;
+
+    t->colors[d] = c;
+    t->nbr[c] |= (((uint64_t)1) << d) | (((uint64_t)1) << (s->order - d));
+    nbr = t->nbr[c];
+
+    /* Cliques through 0 and d lie in their common neighbors */
+    if(circ_has_clique(nbr, nbr & circ_rotate(nbr, d, s->order), s->size[c] - 2, s->order)) {
+        return false;
+    }
+
+    /* Compare with each image as far as both are known */
+    for(int i = 0; i < s->symmetry_count; i++) {
+        const Circ_symmetry* sym = &s->symmetries[i];
+
+        for(int e = 1; e <= d; e++) {
+            int pre = sym->image[e];
+            color x, y;
+
+            if(pre > d) {
+                break;
+            }
+
+            x = t->colors[e];
+            y = t->colors[pre] ^ sym->flip;
+            if(y < x) {
+                return false;
+            }
+            if(y > x) {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void circ_unassign(Circ_thread* t, int d) {
+    t->nbr[t->colors[d]] &= ~((((uint64_t)1) << d) | (((uint64_t)1) << (t->shared->order - d)));
+}
+
+static void circ_report(Circ_thread* t) {
+    Circ_shared* s = t->shared;
+    uint64_t index;
+
+    pthread_mutex_lock(&s->lock);
+    index = ++s->found;
+
+    if(!quiet) {
+        printf("%d:", s->order);
+        for(int d = 1; d <= s->half; d++) {
+            if(t->colors[d]) {
+                printf(" %d", d);
+            }
+        }
+        printf("\n");
+    }
+
+    if(output_prefix != NULL) {
+        char path[4096];
+        Graph g;
+        FILE* f;
+
+        graph_init(&g, s->order);
+        for(int u = 0; u < s->order; u++) {
+            for(int v = u + 1; v < s->order; v++) {
+                int d = v - u;
+
+                graph_set(&g, u, v, t->colors[d <= s->half ? d : s->order - d]);
+            }
+        }
+
+        snprintf(path, sizeof(path), "%s.%d.%llu", output_prefix, s->order, (unsigned long long) index);
+        f = fopen(path, "w");
+        if(f == NULL) {
+            perror("Could not open output file");
+            exit(EXIT_FAILURE);
+        }
+        graph_dump(&g, f);
+        fclose(f);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void circ_dfs(Circ_thread* t, int d) {
+    Circ_shared* s = t->shared;
+
+    t->nodes++;
+
+    if(d > s->half) {
+        circ_report(t);
+        return;
+    }
+
+    for(color c = 0; c < 2; c++) {
+        if(circ_assign(t, d, c)) {
+            circ_dfs(t, d + 1);
+        }
+        circ_unassign(t, d);
+    }
+}
+
+/* Threads take the colorings of the first split differences in turn and
+   search below each one */
+static void* circ_worker(void* arg) {
+    Circ_thread* t = arg;
+    Circ_shared* s = t->shared;
+
+    for(;;) {
+        uint64_t prefix;
+        int d;
+
+        pthread_mutex_lock(&s->lock);
+        prefix = s->next_prefix++;
+        pthread_mutex_unlock(&s->lock);
+
+        if(prefix >= (((uint64_t)1) << s->split)) {
+            break;
+        }
+
+        t->nbr[0] = t->nbr[1] = 0;
+        for(d = 1; d <= s->split; d++) {
+            t->nodes++;
+            if(!circ_assign(t, d, (prefix >> (d - 1)) & 1)) {
+                break;
+            }
+        }
+
+        if(d > s->split) {
+            circ_dfs(t, d);
+        }
+    }
+
+    pthread_mutex_lock(&s->lock);
+    s->nodes += t->nodes;
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+
+static void survey(int order, int s, int t, int threads) {
+    struct timespec start;
+    Circ_shared shared;
+    Circ_thread* workers;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    shared.order = order;
+    shared.half = order / 2;
+    shared.size[0] = s;
+    shared.size[1] = t;
+    shared.split = shared.half < CIRC_SPLIT_DEPTH ? shared.half : CIRC_SPLIT_DEPTH;
+    shared.next_prefix = 0;
+    shared.found = 0;
+    shared.nodes = 0;
+    pthread_mutex_init(&shared.lock, NULL);
+
+    /* Multipliers u and -u act alike on differences, and the identity only
+       matters combined with a color swap */
+    shared.symmetries = malloc(sizeof(Circ_symmetry) * 2 * (shared.half + 1));
+    workers = calloc(threads, sizeof(Circ_thread));
+    if(shared.symmetries == NULL || workers == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    shared.symmetry_count = 0;
+    for(int u = 1; u <= shared.half; u++) {
+        if(gcd(u, order) != 1) {
+            continue;
+        }
+
+        for(color flip = 0; flip <= (s == t); flip++) {
+            Circ_symmetry* sym = &shared.symmetries[shared.symmetry_count];
+
+            if(u == 1 && !flip) {
+                continue;
+            }
+
+            /* The image's color of e is the color of u * e */
+            for(int e = 1; e <= shared.half; e++) {
+                int x = (u * e) % order;
+
+                sym->image[e] = x <= shared.half ? x : order - x;
+            }
+            sym->flip = flip;
+            shared.symmetry_count++;
+        }
+    }
+
+    for(int i = 0; i < threads; i++) {
+        workers[i].shared = &shared;
+        if(pthread_create(&workers[i].thread, NULL, circ_worker, &workers[i]) != 0) {
+            perror("Could not create thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for(int i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    printf("Order %d: %llu circulant R(%d, %d) colorings up to multipliers%s (%llu nodes, %.2fs)\n",
+           order, (unsigned long long) shared.found, s, t, s == t ? " and color swap" : "",
+           (unsigned long long) shared.nodes, elapsed(&start));
+    fflush(stdout);
+
+    pthread_mutex_destroy(&shared.lock);
+    free(shared.symmetries);
+    free(workers);
+}
+
+int main(int argc, char** argv) {
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt, s, t, lo, hi;
+
+    while((opt = getopt(argc, argv, "t:qo:")) != -1) {
+        switch(opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'o':
+            output_prefix = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind != 3 && argc - optind != 4) {
+        usage(argv[0]);
+    }
+
+    s = atoi(argv[optind]);
+    t = atoi(argv[optind + 1]);
+    lo = atoi(argv[optind + 2]);
+    hi = argc - optind == 4 ? atoi(argv[optind + 3]) : lo;
+    if(s < 2 || t < 2 || lo < 3 || hi < lo || hi > CIRC_MAX_ORDER) {
+        usage(argv[0]);
+    }
+    if(threads < 1) {
+        threads = 1;
+    }
+
+    for(int n = lo; n <= hi; n++) {
+        survey(n, s, t, threads);
+    }
+
+    return EXIT_SUCCESS;
+}
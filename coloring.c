@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "coloring.h"
+#include "sat.h"
+
+struct Coloring_s {
+    int order;
+    int block_size;
+    int size[2];
+    Sat* sat;
+    int vars;
+
+    /* Orbit variable of each edge */
+    int orbit[GRAPH_MAX_ORDER][GRAPH_MAX_ORDER];
+
+    /* Clique clauses added after the current solve */
+    int found;
+
+    /* Marks the orbits already in the clause being built */
+    uint32_t* seen;
+    uint32_t stamp;
+
+    uint64_t rounds;
+    uint64_t clauses;
+};
+
+Coloring* coloring_new(int blocks, int block_size, int s, int t) {
+    Coloring* c = calloc(1, sizeof(Coloring));
+    int order = blocks * block_size;
+    int within = block_size / 2;
+
+    if(c == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    if(order > GRAPH_MAX_ORDER || blocks < 1 || block_size < 1) {
+        fprintf(stderr, "Error: invalid block structure\n");
+        exit(EXIT_FAILURE);
+    }
+
+    c->order = order;
+    c->block_size = block_size;
+    c->size[0] = s;
+    c->size[1] = t;
+
+    /* Orbits within each block first, by difference up to m / 2, then those
+       between each pair of blocks by difference */
+    for(int u = 0; u < order; u++) {
+        for(int v = 0; v < order; v++) {
+            int p = u / block_size;
+            int q = v / block_size;
+            int d = ((v - u) % block_size + block_size) % block_size;
+
+            if(p == q) {
+                c->orbit[u][v] = u == v ? 0 : p * within + (d <= block_size - d ? d : block_size - d);
+            } else {
+                int lo = p < q ? p : q;
+                int hi = p < q ? q : p;
+
+                /* Differences are taken from the lower block */
+                if(p > q) {
+                    d = (block_size - d) % block_size;
+                }
+                c->orbit[u][v] = blocks * within +
+                    (lo * (2 * blocks - lo - 1) / 2 + (hi - lo - 1)) * block_size + d + 1;
+            }
+        }
+    }
+    c->vars = blocks * within + blocks * (blocks - 1) / 2 * block_size;
+
+    c->sat = sat_new(c->vars);
+    c->seen = calloc(c->vars + 1, sizeof(uint32_t));
+    if(c->seen == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    /* The complement of a coloring has the same structure, so when s == t
+       the first orbit may be taken to be red */
+    if(s == t && c->vars > 0) {
+        int lit = -1;
+
+        sat_add_clause(c->sat, &lit, 1);
+    }
+
+    return c;
+}
+
+void coloring_free(Coloring* c) {
+    sat_free(c->sat);
+    free(c->seen);
+    free(c);
+}
+
+/* Forbid the clique, and with it every rotation of the clique */
+static void coloring_forbid(Coloring* c, const int* clique, int k, color cc) {
+    int lits[GRAPH_MAX_ORDER * (GRAPH_MAX_ORDER - 1) / 2];
+    int n = 0;
+
+    c->stamp++;
+    for(int a = 0; a < k; a++) {
+        for(int b = a + 1; b < k; b++) {
+            int var = c->orbit[clique[a]][clique[b]];
+
+            if(c->seen[var] != c->stamp) {
+                c->seen[var] = c->stamp;
+                lits[n++] = cc ? -var : var;
+            }
+        }
+    }
+
+    sat_add_clause(c->sat, lits, n);
+    c->found++;
+    c->clauses++;
+}
+
+/* Extend clique, whose common neighbors of color cc above its last vertex are
+   cand, to k-cliques until the batch is full */
+static void coloring_find(Coloring* c, const Graph* g, int* clique, int n, int k,
+                          color cc, uint64_t cand) {
+    if(n == k) {
+        coloring_forbid(c, clique, k, cc);
+        return;
+    }
+
+    for(; cand && c->found < COLORING_BATCH; cand &= cand - 1) {
+        int v = __builtin_ctzll(cand);
+        uint64_t next = cand & g->nbr[cc][v] & ~((((uint64_t)2) << v) - 1);
+
+        if(__builtin_popcountll(next) < k - n - 1) {
+            continue;
+        }
+
+        clique[n] = v;
+        coloring_find(c, g, clique, n + 1, k, cc, next);
+    }
+}
+
+int coloring_next(Coloring* c, Graph* g, uint64_t conflict_limit) {
+    int clique[GRAPH_MAX_ORDER];
+
+    for(;;) {
+        int result = sat_solve(c->sat, NULL, 0, conflict_limit);
+
+        if(result != SAT_SAT) {
+            return result;
+        }
+        c->rounds++;
+
+        graph_init(g, c->order);
+        for(int u = 0; u < c->order; u++) {
+            for(int v = u + 1; v < c->order; v++) {
+                graph_set(g, u, v, sat_value(c->sat, c->orbit[u][v]));
+            }
+        }
+
+        /* Every clique can be rotated so that its lowest vertex is the first
+           vertex of a block */
+        c->found = 0;
+        for(int cc = 0; cc < 2; cc++) {
+            for(int v = 0; v < c->order; v += c->block_size) {
+                clique[0] = v;
+                coloring_find(c, g, clique, 1, c->size[cc], cc,
+                              g->nbr[cc][v] & ~((((uint64_t)2) << v) - 1));
+            }
+        }
+
+        if(c->found == 0) {
+            return SAT_SAT;
+        }
+    }
+}
+
+void coloring_block(Coloring* c) {
+    int* lits = malloc(sizeof(int) * (c->vars + 1));
+
+    if(lits == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int var = 1; var <= c->vars; var++) {
+        lits[var - 1] = sat_value(c->sat, var) ? -var : var;
+    }
+    sat_add_clause(c->sat, lits, c->vars);
+
+    free(lits);
+}
+
+int coloring_vars(const Coloring* c) {
+    return c->vars;
+}
+
+uint64_t coloring_rounds(const Coloring* c) {
+    return c->rounds;
+}
+
+uint64_t coloring_clauses(const Coloring* c) {
+    return c->clauses;
+}
@@ -0,0 +1,43 @@
+/**
+ * Full-graph SAT search for R(s, t) colorings with block-circulant structure.
+ * The n = blocks * m vertices are split into blocks of m, vertex p * m + i
+ * being vertex i of block p, and the color of the edge from (p, i) to (q, j)
+ * only depends on p, q and j - i mod m. There is one variable per orbit of
+ * edges under rotating every block at once, so a circulant coloring (a single
+ * block) has m / 2 variables.
+ *
+ * Clique clauses are added lazily: the solver proposes a coloring, the
+ * monochromatic cliques found in it are forbidden by clauses over their
+ * orbits, and the solve is repeated until a coloring has none. Rotation fixes
+ * every orbit, so one clause also forbids all rotations of its clique.
+ */
+
+#ifndef COLORING_H
+#define COLORING_H
+
+#include <stdint.h>
+
+#include "graph.h"
+
+/* Most clique clauses added after each solve */
+#define COLORING_BATCH 256
+
+typedef struct Coloring_s Coloring;
+
+Coloring* coloring_new(int blocks, int block_size, int s, int t);
+void coloring_free(Coloring* c);
+
+/* Find the next coloring, stored in g. Returns SAT_SAT, SAT_UNSAT once no
+   more exist, or SAT_UNKNOWN if a solve reaches the conflict limit (0 for no
+   limit) */
+int coloring_next(Coloring* c, Graph* g, uint64_t conflict_limit);
+
+/* Forbid the coloring last found, so the next call finds a different one */
+void coloring_block(Coloring* c);
+
+/* Orbit variables, solve rounds and clique clauses added so far */
+int coloring_vars(const Coloring* c);
+uint64_t coloring_rounds(const Coloring* c);
+uint64_t coloring_clauses(const Coloring* c);
+
+#endif
@@ -0,0 +1,291 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "cstore.h"
+
+/* Most bytes one coded clique can take */
+#define CSTORE_MAX_CODE (CSTORE_MAX_K * 10)
+
+/* Where a block starts in the coded data, and its number of cliques */
+typedef struct {
+    uint64_t offset;
+    uint64_t count;
+} Cstore_block;
+
+struct Cstore_s {
+    int k;
+    size_t budget;
+    const char* spill_path;
+
+    /* Finished blocks while they fit in the budget */
+    uint8_t* data;
+    uint64_t data_size;
+
+    Cstore_block* dir;
+    int blocks;
+    int dir_size;
+
+    /* Block being coded, and the clique it was last coded against */
+    uint8_t block[CSTORE_BLOCK_BYTES + CSTORE_MAX_CODE];
+    int block_len;
+    uint64_t block_count;
+    int prev[CSTORE_MAX_K];
+
+    /* Last clique added, for checking the order */
+    int last[CSTORE_MAX_K];
+
+    /* Spill file, and its mapping once finished */
+    FILE* spill;
+    uint8_t* map;
+
+    bool finished;
+    uint64_t count;
+    uint64_t bytes;
+};
+
+static inline uint8_t* cstore_put(uint8_t* q, uint64_t x) {
+    while(x >= 0x80) {
+        *q++ = (uint8_t)(x | 0x80);
+        x >>= 7;
+    }
+    *q++ = (uint8_t) x;
+
+    return q;
+}
+
+static inline const uint8_t* cstore_get(const uint8_t* p, uint64_t* x) {
+    int shift = 0;
+
+    *x = 0;
+    while(*p & 0x80) {
+        *x |= ((uint64_t)(*p++ & 0x7f)) << shift;
+        shift += 7;
+    }
+    *x |= ((uint64_t) *p++) << shift;
+
+    return p;
+}
+
+Cstore* cstore_new(int k, size_t budget, const char* spill_path) {
+    Cstore* s = calloc(1, sizeof(Cstore));
+
+    if(s == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    if(k < 1 || k > CSTORE_MAX_K) {
+        fprintf(stderr, "Error: cliques of size %d can not be stored\n", k);
+        exit(EXIT_FAILURE);
+    }
+
+    s->k = k;
+    s->budget = budget;
+    s->spill_path = spill_path;
+    for(int i = 0; i < k; i++) {
+        s->prev[i] = -1;
+        s->last[i] = -1;
+    }
+
+    return s;
+}
+
+void cstore_free(Cstore* s) {
+    if(s->map != NULL) {
+        munmap(s->map, s->bytes);
+    }
+    if(s->spill != NULL) {
+        fclose(s->spill);
+    }
+    free(s->data);
+    free(s->dir);
+    free(s);
+}
+
+/* Move everything coded so far out to the spill file */
+static void cstore_spill(Cstore* s) {
+    s->spill = s->spill_path != NULL ? fopen(s->spill_path, "w+b") : tmpfile();
+    if(s->spill == NULL) {
+        perror("Could not open spill file");
+        exit(EXIT_FAILURE);
+    }
+
+    if(s->data_size > 0 && fwrite(s->data, 1, s->data_size, s->spill) != s->data_size) {
+        perror("Could not write spill file");
+        exit(EXIT_FAILURE);
+    }
+
+    free(s->data);
+    s->data = NULL;
+}
+
+static void cstore_close_block(Cstore* s) {
+    if(s->block_count == 0) {
+        return;
+    }
+
+    if(s->blocks == s->dir_size) {
+        s->dir_size = s->dir_size ? 2 * s->dir_size : 64;
+        s->dir = realloc(s->dir, sizeof(Cstore_block) * s->dir_size);
+        if(s->dir == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    s->dir[s->blocks].offset = s->bytes;
+    s->dir[s->blocks].count = s->block_count;
+    s->blocks++;
+
+    if(s->spill == NULL && s->bytes + s->block_len > s->budget) {
+        cstore_spill(s);
+    }
+
+    if(s->spill != NULL) {
+        if(fwrite(s->block, 1, s->block_len, s->spill) != (size_t) s->block_len) {
+            perror("Could not write spill file");
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        s->data = realloc(s->data, s->bytes + s->block_len);
+        if(s->data == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(s->data + s->bytes, s->block, s->block_len);
+        s->data_size = s->bytes + s->block_len;
+    }
+
+    s->bytes += s->block_len;
+    s->block_len = 0;
+    s->block_count = 0;
+    for(int i = 0; i < s->k; i++) {
+        s->prev[i] = -1;
+    }
+}
+
+void cstore_add(Cstore* s, const int* clique) {
+    uint8_t* q = s->block + s->block_len;
+    int p = 0;
+
+    if(s->finished) {
+        fprintf(stderr, "Error: clique added to a finished store\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Cliques must be increasing, and come in lexicographic order */
+    for(int i = 1; i < s->k; i++) {
+        if(clique[i] <= clique[i - 1]) {
+            fprintf(stderr, "Error: clique vertices out of order\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    while(p < s->k && clique[p] == s->last[p]) {
+        p++;
+    }
+    if(p == s->k || clique[p] < s->last[p]) {
+        fprintf(stderr, "Error: cliques added out of order\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(s->last, clique, sizeof(int) * s->k);
+
+    /* A fresh block codes against nothing, i.e. from position 0 */
+    p = 0;
+    while(clique[p] == s->prev[p]) {
+        p++;
+    }
+
+    q = cstore_put(q, (((uint64_t)(clique[p] - s->prev[p] - 1)) << 3) | p);
+    for(int i = p + 1; i < s->k; i++) {
+        q = cstore_put(q, clique[i] - clique[i - 1] - 1);
+    }
+    memcpy(s->prev, clique, sizeof(int) * s->k);
+
+    s->block_len = q - s->block;
+    s->block_count++;
+    s->count++;
+
+    if(s->block_len >= CSTORE_BLOCK_BYTES) {
+        cstore_close_block(s);
+    }
+}
+
+void cstore_finish(Cstore* s) {
+    if(s->finished) {
+        return;
+    }
+
+    cstore_close_block(s);
+    s->finished = true;
+
+    if(s->spill != NULL && s->bytes > 0) {
+        fflush(s->spill);
+        s->map = mmap(NULL, s->bytes, PROT_READ, MAP_PRIVATE, fileno(s->spill), 0);
+        if(s->map == MAP_FAILED) {
+            perror("Could not map spill file");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+uint64_t cstore_count(const Cstore* s) {
+    return s->count;
+}
+
+uint64_t cstore_bytes(const Cstore* s) {
+    return s->bytes + s->block_len;
+}
+
+int cstore_blocks(const Cstore* s) {
+    return s->blocks;
+}
+
+bool cstore_spilled(const Cstore* s) {
+    return s->spill != NULL;
+}
+
+void cstore_scan_init(const Cstore* s, Cstore_scan* scan) {
+    if(!s->finished) {
+        fprintf(stderr, "Error: scan of an unfinished store\n");
+        exit(EXIT_FAILURE);
+    }
+
+    scan->store = s;
+    scan->block = -1;
+    scan->left = 0;
+    scan->p = NULL;
+}
+
+bool cstore_scan_next(Cstore_scan* scan, int* clique) {
+    const Cstore* s = scan->store;
+    uint64_t x;
+    int p;
+
+    while(scan->left == 0) {
+        if(++scan->block >= s->blocks) {
+            return false;
+        }
+
+        scan->p = (s->map != NULL ? s->map : s->data) + s->dir[scan->block].offset;
+        scan->left = s->dir[scan->block].count;
+        for(int i = 0; i < s->k; i++) {
+            scan->prev[i] = -1;
+        }
+    }
+
+    scan->p = cstore_get(scan->p, &x);
+    p = x & 7;
+    memcpy(clique, scan->prev, sizeof(int) * p);
+    clique[p] = scan->prev[p] + 1 + (int)(x >> 3);
+    for(int i = p + 1; i < s->k; i++) {
+        scan->p = cstore_get(scan->p, &x);
+        clique[i] = clique[i - 1] + 1 + (int) x;
+    }
+
+    memcpy(scan->prev, clique, sizeof(int) * s->k);
+    scan->left--;
+
+    return true;
+}
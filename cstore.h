@@ -0,0 +1,64 @@
+/**
+ * Compressed, external-memory store of monochromatic k-cliques, for orders
+ * and clique sizes where a plain clique list outgrows RAM. Cliques are added
+ * in lexicographic order (the order the clique searches produce them) and
+ * delta coded against the clique before them: the first position where the
+ * two differ, packed with the gap at that position, then the gaps between
+ * the remaining vertices, all as varints. A typical clique takes a byte or
+ * so per vertex.
+ *
+ * The coded cliques are cut into blocks which each start from scratch, so a
+ * block can be decoded on its own. Blocks are kept in memory until they pass
+ * a budget; from then on everything is spilled to a file, which is memory
+ * mapped once the store is finished. Either way the store is read back by
+ * sequential scans without ever being decoded whole.
+ */
+
+#ifndef CSTORE_H
+#define CSTORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest clique size stored */
+#define CSTORE_MAX_K 8
+
+/* Coded bytes per block */
+#define CSTORE_BLOCK_BYTES 65536
+
+typedef struct Cstore_s Cstore;
+
+/* A sequential scan over a finished store */
+typedef struct {
+    const Cstore* store;
+    int block;
+    uint64_t left;
+    const uint8_t* p;
+    int prev[CSTORE_MAX_K];
+} Cstore_scan;
+
+/* A store of k-cliques keeping at most budget bytes in memory. Spilled
+   blocks go to spill_path, or an anonymous temporary file if it is NULL */
+Cstore* cstore_new(int k, size_t budget, const char* spill_path);
+void cstore_free(Cstore* s);
+
+/* Append a clique, given as k increasing vertices, lexicographically after
+   the previous one */
+void cstore_add(Cstore* s, const int* clique);
+
+/* Flush the last block and map the spill file. No more cliques can be
+   added, and scans may begin */
+void cstore_finish(Cstore* s);
+
+uint64_t cstore_count(const Cstore* s);
+uint64_t cstore_bytes(const Cstore* s);
+int cstore_blocks(const Cstore* s);
+bool cstore_spilled(const Cstore* s);
+
+/* Decode the cliques in order. cstore_scan_next stores the next clique and
+   returns true, or returns false at the end */
+void cstore_scan_init(const Cstore* s, Cstore_scan* scan);
+bool cstore_scan_next(Cstore_scan* scan, int* clique);
+
+#endif
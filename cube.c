@@ -0,0 +1,624 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cube.h"
+#include "sat.h"
+
+/* Lookahead splitter state */
+typedef struct {
+    const Ext_clique* cliques;
+    int count;
+    int order;
+    int depth;
+
+    /* Open cliques at each depth of the split */
+    int* open[EXT_MAX_ORDER + 2];
+
+    Cube* cubes;
+    int cube_count;
+    int cube_cap;
+    int refuted;
+
+    /* Proof of the split, as the negations of partial rows in the order
+       they can be derived, if a proof is wanted */
+    bool prove;
+    Cube* lemmas;
+    int lemma_count;
+    int lemma_cap;
+
+    /* Set if a split already settles every clique */
+    bool found;
+    uint64_t row;
+} Splitter;
+
+/* State shared by the conquer threads */
+typedef struct {
+    const Ext_clique* cliques;
+    int count;
+    int order;
+
+    const Cube* cubes;
+    int cube_count;
+
+    /* Cubes already refuted by the log */
+    bool* done;
+
+    pthread_mutex_t lock;
+    int next;
+    bool found;
+    uint64_t row;
+    uint64_t conflicts;
+    FILE* log;
+    FILE* proof;
+} Conquer;
+
+static inline bool cube_satisfied(const Ext_clique* clique, uint64_t assigned, uint64_t values) {
+    uint64_t same = clique->cc ? values : ~values;
+
+    return (clique->mask & assigned & ~same) != 0;
+}
+
+/* Unit propagate the open cliques under the partial row. Returns false if a
+   clique is closed */
+static bool cube_propagate(const Splitter* sp, const int* open, int n, uint64_t* assigned, uint64_t* values) {
+    bool changed = true;
+
+    while(changed) {
+        changed = false;
+
+        for(int i = 0; i < n; i++) {
+            const Ext_clique* clique = &sp->cliques[open[i]];
+            uint64_t rem;
+
+            if(cube_satisfied(clique, *assigned, *values)) {
+                continue;
+            }
+
+            rem = clique->mask & ~*assigned;
+            if(rem == 0) {
+                return false;
+            }
+
+            if((rem & (rem - 1)) == 0) {
+                *assigned |= rem;
+                if(clique->cc) {
+                    *values &= ~rem;
+                } else {
+                    *values |= rem;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* How much fixing the extra bits shrank the open cliques, weighting cliques
+   left with two open vertices most */
+static int cube_reduction(const Splitter* sp, const int* open, int n, uint64_t assigned,
+                          uint64_t a, uint64_t v) {
+    int score = __builtin_popcountll(a & ~assigned);
+
+    for(int i = 0; i < n; i++) {
+        const Ext_clique* clique = &sp->cliques[open[i]];
+        int before, after;
+
+        if(cube_satisfied(clique, a, v)) {
+            continue;
+        }
+
+        before = __builtin_popcountll(clique->mask & ~assigned);
+        after = __builtin_popcountll(clique->mask & ~a);
+        if(after < before) {
+            score += after == 2 ? 4 : 1;
+        }
+    }
+
+    return score;
+}
+
+/* The most promising open vertices by weighted occurrence, best first */
+static int cube_preselect(const Splitter* sp, const int* open, int n, uint64_t assigned, int* vars) {
+    uint32_t score[EXT_MAX_ORDER] = {0};
+    int count = 0;
+
+    for(int i = 0; i < n; i++) {
+        const Ext_clique* clique = &sp->cliques[open[i]];
+        uint64_t rem = clique->mask & ~assigned;
+        uint32_t w = ext_weight(clique, rem);
+
+        for(; rem; rem &= rem - 1) {
+            score[__builtin_ctzll(rem)] += w;
+        }
+    }
+
+    for(int v = 0; v < sp->order; v++) {
+        int j;
+
+        if(score[v] == 0) {
+            continue;
+        }
+
+        /* Insertion into the sorted candidate list */
+        for(j = count; j > 0 && score[vars[j - 1]] < score[v]; j--) {
+            if(j < CUBE_LOOKAHEAD_VARS) {
+                vars[j] = vars[j - 1];
+            }
+        }
+        if(j < CUBE_LOOKAHEAD_VARS) {
+            vars[j] = v;
+            if(count < CUBE_LOOKAHEAD_VARS) {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+static void cube_push(Cube** list, int* count, int* cap, uint64_t assigned, uint64_t values) {
+    if(*count == *cap) {
+        *cap = *cap ? 2 * *cap : 256;
+        *list = realloc(*list, *cap * sizeof(Cube));
+        if(*list == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    (*list)[*count].assigned = assigned;
+    (*list)[*count].values = values;
+    (*count)++;
+}
+
+static void cube_emit(Splitter* sp, uint64_t assigned, uint64_t values) {
+    cube_push(&sp->cubes, &sp->cube_count, &sp->cube_cap, assigned, values);
+}
+
+/* Record that the partial row cannot be extended to a solution */
+static void cube_lemma(Splitter* sp, uint64_t assigned, uint64_t values) {
+    if(sp->prove) {
+        cube_push(&sp->lemmas, &sp->lemma_count, &sp->lemma_cap, assigned, values);
+    }
+}
+
+/* Split the node reached by the decisions in dec_assigned and dec_values,
+   whose propagated row is assigned and values. Every lemma recorded is the
+   negation of decisions only: unit propagation rederives the rest of the
+   row from the decisions and the lemmas recorded before it */
+static void cube_split(Splitter* sp, int depth, const int* open, int n, uint64_t assigned, uint64_t values,
+                       uint64_t dec_assigned, uint64_t dec_values) {
+    int* next = sp->open[depth + 1];
+    int vars[CUBE_LOOKAHEAD_VARS];
+    int candidates, best, best_score, m;
+
+    if(sp->found) {
+        return;
+    }
+
+    while(true) {
+        if(!cube_propagate(sp, open, n, &assigned, &values)) {
+            cube_lemma(sp, dec_assigned, dec_values);
+            sp->refuted++;
+            return;
+        }
+
+        /* Keep only the cliques still open */
+        m = 0;
+        for(int i = 0; i < n; i++) {
+            if(!cube_satisfied(&sp->cliques[open[i]], assigned, values)) {
+                next[m++] = open[i];
+            }
+        }
+        open = next;
+        n = m;
+
+        if(n == 0) {
+            sp->found = true;
+            sp->row = values;
+            return;
+        }
+
+        if(depth == sp->depth) {
+            /* The conquering solver proves the full cube; the decisions
+               follow from it */
+            cube_emit(sp, assigned, values);
+            cube_lemma(sp, dec_assigned, dec_values);
+            return;
+        }
+
+        /* Look ahead on both values of each candidate. A value which fails
+           outright forces the other and the node is propagated again */
+        candidates = cube_preselect(sp, open, n, assigned, vars);
+        best = -1;
+        best_score = -1;
+
+        for(int i = 0; i < candidates && best != -2; i++) {
+            uint64_t bit = ((uint64_t)1) << vars[i];
+            int score[2];
+
+            for(int k = 0; k < 2; k++) {
+                uint64_t a = assigned | bit;
+                uint64_t v = k ? values | bit : values & ~bit;
+
+                score[k] = cube_propagate(sp, open, n, &a, &v) ?
+                    cube_reduction(sp, open, n, assigned, a, v) : -1;
+            }
+
+            if(score[0] < 0 && score[1] < 0) {
+                cube_lemma(sp, dec_assigned | bit, dec_values & ~bit);
+                cube_lemma(sp, dec_assigned, dec_values);
+                sp->refuted++;
+                return;
+            } else if(score[0] < 0 || score[1] < 0) {
+                cube_lemma(sp, dec_assigned | bit, score[0] < 0 ? dec_values & ~bit : dec_values | bit);
+                assigned |= bit;
+                values = score[0] < 0 ? values | bit : values & ~bit;
+                best = -2;
+            } else if(score[0] * score[1] + score[0] + score[1] > best_score) {
+                best_score = score[0] * score[1] + score[0] + score[1];
+                best = vars[i];
+            }
+        }
+
+        if(best != -2) {
+            break;
+        }
+    }
+
+    for(int k = 0; k < 2; k++) {
+        uint64_t bit = ((uint64_t)1) << best;
+
+        cube_split(sp, depth + 1, open, n, assigned | bit, k ? values | bit : values & ~bit,
+                   dec_assigned | bit, k ? dec_values | bit : dec_values & ~bit);
+    }
+
+    if(!sp->found) {
+        cube_lemma(sp, dec_assigned, dec_values);
+    }
+}
+
+/* Assumption literals for a cube */
+static int cube_assumptions(const Cube* cube, int* lits) {
+    int n = 0;
+
+    for(uint64_t m = cube->assigned; m; m &= m - 1) {
+        int v = __builtin_ctzll(m);
+
+        lits[n++] = (cube->values >> v) & 1 ? v + 1 : -(v + 1);
+    }
+
+    return n;
+}
+
+/* Write the clause excluding the cube to a proof, as a single fwrite so lines
+   from the conquering threads do not interleave */
+static void cube_proof_write(FILE* proof, const Cube* cube) {
+    char line[EXT_MAX_ORDER * 4 + 4];
+    int lits[EXT_MAX_ORDER];
+    int n = cube_assumptions(cube, lits);
+    size_t len = 0;
+
+    for(int i = 0; i < n; i++) {
+        len += sprintf(line + len, "%d ", -lits[i]);
+    }
+    len += sprintf(line + len, "0\n");
+
+    fwrite(line, 1, len, proof);
+}
+
+static void cube_log(FILE* log, int id, const Cube* cube, const char* status) {
+    int lits[EXT_MAX_ORDER];
+    int n = cube_assumptions(cube, lits);
+
+    fprintf(log, "%d %s", id, status);
+    for(int i = 0; i < n; i++) {
+        fprintf(log, " %d", lits[i]);
+    }
+    fprintf(log, " 0\n");
+    fflush(log);
+}
+
+/* Read the cubes an earlier run refuted. The log header must match this
+   instance and split. A last line cut short by an interrupted run is
+   ignored, and torn set to its offset so it can be dropped, or -1. Returns
+   the number of cubes marked done, or -1 if the log is empty */
+static int cube_resume(FILE* log, const Splitter* sp, bool* done, long* torn) {
+    char line[EXT_MAX_ORDER * 4 + 32];
+    int order, count, depth, cubes;
+    int resumed = 0;
+
+    *torn = -1;
+
+    if(fscanf(log, " p cube %d %d %d %d", &order, &count, &depth, &cubes) != 4) {
+        if(feof(log) && ftell(log) == 0) {
+            return -1;
+        }
+        fprintf(stderr, "Error: invalid cube log header\n");
+        exit(EXIT_FAILURE);
+    }
+    if(order != sp->order || count != sp->count || depth != sp->depth || cubes != sp->cube_count) {
+        fprintf(stderr, "Error: cube log was written for a different instance\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* The rest of the header line */
+    if(fgets(line, sizeof(line), log) == NULL || line[strlen(line) - 1] != '\n') {
+        fprintf(stderr, "Error: invalid cube log header\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while(true) {
+        long start = ftell(log);
+        Cube cube = {0, 0};
+        char status[8];
+        char* p;
+        int id;
+        int pos;
+        long lit = 1;
+
+        if(fgets(line, sizeof(line), log) == NULL) {
+            break;
+        }
+        if(line[strlen(line) - 1] != '\n') {
+            if(feof(log)) {
+                *torn = start;
+                break;
+            }
+            fprintf(stderr, "Error: invalid line in cube log\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if(sscanf(line, "%d %7s%n", &id, status, &pos) != 2) {
+            fprintf(stderr, "Error: invalid line in cube log\n");
+            exit(EXIT_FAILURE);
+        }
+        for(p = line + pos; lit != 0; ) {
+            char* next;
+            int v;
+
+            lit = strtol(p, &next, 10);
+            if(next == p || lit < -EXT_MAX_ORDER || lit > EXT_MAX_ORDER) {
+                fprintf(stderr, "Error: invalid line in cube log\n");
+                exit(EXIT_FAILURE);
+            }
+            p = next;
+
+            if(lit != 0) {
+                v = (lit > 0 ? lit : -lit) - 1;
+                cube.assigned |= ((uint64_t)1) << v;
+                if(lit > 0) {
+                    cube.values |= ((uint64_t)1) << v;
+                }
+            }
+        }
+
+        if(id < 0 || id >= sp->cube_count ||
+           cube.assigned != sp->cubes[id].assigned || cube.values != sp->cubes[id].values) {
+            fprintf(stderr, "Error: cube %d in log does not match the split\n", id);
+            exit(EXIT_FAILURE);
+        }
+
+        if(status[0] == 'U' && !done[id]) {
+            done[id] = true;
+            resumed++;
+        }
+    }
+
+    return resumed;
+}
+
+static void* cube_worker(void* arg) {
+    Conquer* cq = arg;
+    Sat* sat = sat_new(cq->order);
+    int lits[EXT_MAX_ORDER];
+    int n;
+
+    sat_set_proof(sat, cq->proof);
+
+    for(int i = 0; i < cq->count; i++) {
+        n = ext_clause(&cq->cliques[i], lits);
+        sat_add_clause(sat, lits, n);
+    }
+
+    while(true) {
+        int id;
+        int status;
+
+        /* Take the next unsolved cube */
+        pthread_mutex_lock(&cq->lock);
+        while(cq->next < cq->cube_count && cq->done[cq->next]) {
+            cq->next++;
+        }
+        id = cq->found ? cq->cube_count : cq->next++;
+        pthread_mutex_unlock(&cq->lock);
+
+        if(id >= cq->cube_count) {
+            break;
+        }
+
+        n = cube_assumptions(&cq->cubes[id], lits);
+        status = sat_solve(sat, lits, n, 0);
+
+        if(status == SAT_UNSAT && cq->proof != NULL) {
+            cube_proof_write(cq->proof, &cq->cubes[id]);
+        }
+
+        pthread_mutex_lock(&cq->lock);
+        if(status == SAT_SAT && !cq->found) {
+            cq->found = true;
+            cq->row = 0;
+            for(int v = 0; v < cq->order; v++) {
+                if(sat_value(sat, v + 1)) {
+                    cq->row |= ((uint64_t)1) << v;
+                }
+            }
+        }
+        if(cq->log != NULL) {
+            cube_log(cq->log, id, &cq->cubes[id], status == SAT_SAT ? "SAT" : "UNSAT");
+        }
+        pthread_mutex_unlock(&cq->lock);
+    }
+
+    pthread_mutex_lock(&cq->lock);
+    cq->conflicts += sat_conflicts(sat);
+    pthread_mutex_unlock(&cq->lock);
+
+    sat_free(sat);
+    return NULL;
+}
+
+/* Decide whether any row closes no clique, splitting into cubes of the given
+   depth and conquering them with the given number of threads. Finished cubes
+   are appended to the log at log_path, if given, and cubes it already
+   refutes are skipped. A record cut short by an interrupted run is dropped.
+
+   If proof is given, a DRUP refutation is written to it: the conquering
+   solvers' lemmas, the clause excluding each refuted cube, and finally the
+   split's lemmas ending in the empty clause. A proof has to cover every
+   cube, so cubes in the log are solved again rather than skipped */
+void cube_search(const Ext_clique* cliques, int count, int order, int depth,
+                 int threads, const char* log_path, FILE* proof, Cube_result* result) {
+    Splitter sp;
+    Conquer cq;
+    pthread_t* workers;
+    int i;
+
+    if(depth > order) {
+        depth = order;
+    }
+
+    sp.cliques = cliques;
+    sp.count = count;
+    sp.order = order;
+    sp.depth = depth;
+    sp.cubes = NULL;
+    sp.cube_count = 0;
+    sp.cube_cap = 0;
+    sp.refuted = 0;
+    sp.found = false;
+    sp.row = 0;
+    sp.prove = proof != NULL;
+    sp.lemmas = NULL;
+    sp.lemma_count = 0;
+    sp.lemma_cap = 0;
+
+    sp.open[0] = malloc(sizeof(int) * (count + 1) * (depth + 2));
+    if(sp.open[0] == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 1; i <= depth + 1; i++) {
+        sp.open[i] = sp.open[0] + i * (count + 1);
+    }
+    for(i = 0; i < count; i++) {
+        sp.open[0][i] = i;
+    }
+
+    cube_split(&sp, 0, sp.open[0], count, 0, 0, 0, 0);
+    free(sp.open[0]);
+
+    result->cubes = sp.cube_count;
+    result->refuted = sp.refuted;
+    result->resumed = 0;
+    result->conflicts = 0;
+
+    if(sp.found) {
+        result->status = SAT_SAT;
+        result->row = sp.row;
+        free(sp.cubes);
+        free(sp.lemmas);
+        return;
+    }
+
+    cq.cliques = cliques;
+    cq.count = count;
+    cq.order = order;
+    cq.cubes = sp.cubes;
+    cq.cube_count = sp.cube_count;
+    cq.next = 0;
+    cq.found = false;
+    cq.row = 0;
+    cq.conflicts = 0;
+    cq.log = NULL;
+    cq.proof = proof;
+    cq.done = calloc(sp.cube_count + 1, sizeof(bool));
+    workers = malloc(sizeof(pthread_t) * threads);
+    if(cq.done == NULL || workers == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&cq.lock, NULL);
+
+    if(log_path != NULL) {
+        FILE* old = fopen(log_path, "r");
+        bool header = true;
+
+        if(old != NULL) {
+            long torn;
+            int resumed = cube_resume(old, &sp, cq.done, &torn);
+
+            /* Appending after a torn line would run the next record into it */
+            if(torn >= 0 && truncate(log_path, torn) != 0) {
+                perror("Could not truncate cube log");
+                exit(EXIT_FAILURE);
+            }
+
+            if(resumed >= 0) {
+                header = false;
+                if(proof == NULL) {
+                    result->resumed = resumed;
+                } else {
+                    memset(cq.done, 0, sp.cube_count * sizeof(bool));
+                }
+            }
+            fclose(old);
+        }
+
+        cq.log = fopen(log_path, "a");
+        if(cq.log == NULL) {
+            perror("Could not open cube log");
+            exit(EXIT_FAILURE);
+        }
+        if(header) {
+            fprintf(cq.log, "p cube %d %d %d %d\n", order, count, depth, sp.cube_count);
+            fflush(cq.log);
+        }
+    }
+
+    for(i = 0; i < threads; i++) {
+        if(pthread_create(&workers[i], NULL, cube_worker, &cq) != 0) {
+            perror("Could not start solver thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for(i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    result->status = cq.found ? SAT_SAT : SAT_UNSAT;
+    result->row = cq.row;
+    result->conflicts = cq.conflicts;
+
+    if(proof != NULL && !cq.found) {
+        for(i = 0; i < sp.lemma_count; i++) {
+            cube_proof_write(proof, &sp.lemmas[i]);
+        }
+    }
+
+    if(cq.log != NULL) {
+        fclose(cq.log);
+    }
+    pthread_mutex_destroy(&cq.lock);
+    free(workers);
+    free(cq.done);
+    free(sp.cubes);
+    free(sp.lemmas);
+}
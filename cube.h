@@ -0,0 +1,54 @@
+/**
+ * Cube-and-conquer SAT for extension instances. A lookahead splitter fixes
+ * row bits until the formula is cut into up to 2^depth cubes (partial rows),
+ * refuting cubes on the way where propagation alone can. The remaining cubes
+ * are handed out one at a time to CDCL workers, one per thread, which solve
+ * the full formula under each cube as assumptions and keep their learnt
+ * clauses between cubes.
+ *
+ * Finished cubes can be recorded to a log. Running again with the same log
+ * skips the cubes it already refutes, so an interrupted run resumes where it
+ * stopped.
+ *
+ * An UNSAT answer can come with a DRUP proof checkable against the base
+ * graph alone.
+ */
+
+#ifndef CUBE_H
+#define CUBE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "extension.h"
+
+/* Default splitting depth, giving up to 2^CUBE_DEPTH cubes */
+#define CUBE_DEPTH 12
+
+/* Variables considered by the lookahead at each split */
+#define CUBE_LOOKAHEAD_VARS 12
+
+/* A partial row: the bits in assigned are fixed to their value in values */
+typedef struct {
+    uint64_t assigned;
+    uint64_t values;
+} Cube;
+
+typedef struct {
+    /* SAT_SAT with the row found, or SAT_UNSAT */
+    int status;
+    uint64_t row;
+
+    /* Cubes handed to the workers, cubes refuted by the splitter itself, and
+       cubes skipped because the log already refutes them */
+    int cubes;
+    int refuted;
+    int resumed;
+
+    uint64_t conflicts;
+} Cube_result;
+
+void cube_search(const Ext_clique* cliques, int count, int order, int depth,
+                 int threads, const char* log_path, FILE* proof, Cube_result* result);
+
+#endif
@@ -0,0 +1,781 @@
+/**
+ * File: difftest.c
+ *
+ * Purpose: Differential testing of the clique and extension engines against
+ *  brute force on random small colorings, where brute force is instant.
+ *
+ *  The reference follows scan_cliques() and next_graph() in ramsey.c,
+ *  without the permutation filter: cliques are found by trying every vertex
+ *  subset in lexicographic order against the plain color matrix, and
+ *  extensions by trying every row of the new vertex against every base
+ *  clique. Each case then checks
+ *
+ *   cliques    graph_cliques_in and wide_cliques list exactly the reference
+ *              cliques in the same order; graph_clique_counts,
+ *              graph_clique_number and wide_has_clique agree with them; the
+ *              cliques survive a round trip through a cstore; a cindex agrees
+ *              on the coloring and after random flips
+ *   extension  ext_from_graph has the reference cliques and ext_add_vertex
+ *              grows the same instance; ext_enumerate and SAT enumeration
+ *              find exactly the reference rows; bnb finds the least number
+ *              of closed cliques; cube_search, a session moved over from a
+ *              neighboring instance, recolor_search (for R(5, 5)) and the
+ *              libramsey permutation search and its pipeline (for s = t)
+ *              agree on whether a row exists and return a valid one; local
+ *              search never beats the optimum; ramsey_verify agrees with
+ *              the clique numbers
+ *   symmetry   graph_canonical gives the same form and group order for a
+ *              random relabeling
+ *
+ *  Blue densities are kept between 1/4 and 3/4, so the colorings have small
+ *  automorphism groups and the brute force references stay fast.
+ *
+ *  A failing case is shrunk, deleting vertices and recoloring edges toward
+ *  equal blue and red counts while the same check still fails, and the
+ *  minimal coloring is printed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bnb.h"
+#include "cindex.h"
+#include "cstore.h"
+#include "cube.h"
+#include "extension.h"
+#include "graph.h"
+#include "local_search.h"
+#include "ramsey.h"
+#include "recolor.h"
+#include "sat.h"
+#include "session.h"
+#include "wide.h"
+
+/* Largest order tested, since every row is tried */
+#define DIFF_MAX_ORDER 24
+
+/* Largest clique size compared */
+#define DIFF_MAX_K 6
+
+/* Permutation filter size of the libramsey search */
+#define DIFF_PERM_BITS 12
+
+/* Most rows SAT enumeration is run to */
+#define DIFF_MAX_SAT_ROWS 4096
+
+/* Random edge flips applied to a cindex */
+#define DIFF_CINDEX_FLIPS 8
+
+/* A list of cliques of one size, or of rows */
+typedef struct {
+    int k;
+    int* vertices;
+    uint64_t* rows;
+    int count;
+    int size;
+} Diff_list;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-n cases] [-r min,max] [-c s,t] [-s seed]\n"
+            "  -n  number of cases (default 1000)\n"
+            "  -r  range of orders (default 8,20)\n"
+            "  -c  clique sizes s,t (default random from 3 to 5)\n"
+            "  -s  random seed\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void list_grow(Diff_list* list) {
+    if(list->count < list->size) {
+        return;
+    }
+
+    list->size = list->size ? 2 * list->size : 256;
+    list->vertices = realloc(list->vertices, sizeof(int) * DIFF_MAX_K * list->size);
+    list->rows = realloc(list->rows, sizeof(uint64_t) * list->size);
+    if(list->vertices == NULL || list->rows == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void list_clique(const int* clique, int k, color cc, void* arg) {
+    Diff_list* list = arg;
+
+    (void) cc;
+    list_grow(list);
+    memcpy(list->vertices + list->count * DIFF_MAX_K, clique, sizeof(int) * k);
+    list->count++;
+}
+
+static void list_row(uint64_t row, void* arg) {
+    Diff_list* list = arg;
+
+    list_grow(list);
+    list->rows[list->count++] = row;
+}
+
+static void list_free(Diff_list* list) {
+    free(list->vertices);
+    free(list->rows);
+}
+
+static bool same_cliques(const Diff_list* a, const Diff_list* b, int k) {
+    if(a->count != b->count) {
+        return false;
+    }
+    for(int i = 0; i < a->count; i++) {
+        if(memcmp(a->vertices + i * DIFF_MAX_K, b->vertices + i * DIFF_MAX_K, sizeof(int) * k) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int compare_rows(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+
+    return x < y ? -1 : x > y;
+}
+
+static int compare_ext(const void* a, const void* b) {
+    const Ext_clique* x = a;
+    const Ext_clique* y = b;
+
+    if(x->mask != y->mask) {
+        return x->mask < y->mask ? -1 : 1;
+    }
+    return (int) x->cc - (int) y->cc;
+}
+
+static bool same_graph(const Graph* a, const Graph* b) {
+    return a->order == b->order && memcmp(a->nbr, b->nbr, sizeof(a->nbr)) == 0;
+}
+
+/* Row lists may be empty with no array, which qsort, bsearch and memcmp
+   must not be handed */
+static void sort_rows(Diff_list* rows) {
+    if(rows->count > 0) {
+        qsort(rows->rows, rows->count, sizeof(uint64_t), compare_rows);
+    }
+}
+
+static bool same_rows(const Diff_list* a, const Diff_list* b) {
+    return a->count == b->count &&
+           (a->count == 0 || memcmp(a->rows, b->rows, sizeof(uint64_t) * a->count) == 0);
+}
+
+static bool has_row(const Diff_list* rows, uint64_t row) {
+    return rows->count > 0 &&
+           bsearch(&row, rows->rows, rows->count, sizeof(uint64_t), compare_rows) != NULL;
+}
+
+/* Reference: every k-subset in lexicographic order, checked pair by pair */
+static void brute_cliques(const Graph* g, int k, color cc, int* clique, int n, int from,
+                          Diff_list* list) {
+    if(n == k) {
+        list_clique(clique, k, cc, list);
+        return;
+    }
+
+    for(int v = from; v < g->order; v++) {
+        bool mono = true;
+
+        for(int i = 0; i < n && mono; i++) {
+            mono = graph_color(g, clique[i], v) == cc;
+        }
+        if(mono) {
+            clique[n] = v;
+            brute_cliques(g, k, cc, clique, n + 1, v + 1, list);
+        }
+    }
+}
+
+static void brute_list(const Graph* g, int k, color cc, Diff_list* list) {
+    int clique[DIFF_MAX_K];
+
+    list->count = 0;
+    list->k = k;
+    brute_cliques(g, k, cc, clique, 0, 0, list);
+}
+
+static void wide_from_graph(const Graph* g, Wide_graph* w) {
+    wide_init(w, g->order);
+    for(int u = 0; u < g->order; u++) {
+        for(int v = u + 1; v < g->order; v++) {
+            wide_set(w, u, v, graph_color(g, u, v));
+        }
+    }
+}
+
+/* g without vertex x, the later vertices moving down one */
+static void delete_vertex(const Graph* g, int x, Graph* out) {
+    graph_init(out, g->order - 1);
+    for(int u = 0; u < g->order; u++) {
+        for(int v = u + 1; v < g->order; v++) {
+            if(u != x && v != x) {
+                graph_set(out, u - (u > x), v - (v > x), graph_color(g, u, v));
+            }
+        }
+    }
+}
+
+static const char* check_cliques(const Graph* g, uint64_t seed) {
+    Diff_list ref[2] = { { 0 } }, got = { 0 };
+    const char* failure = NULL;
+    Wide_graph w;
+    uint64_t rng = seed;
+
+    wide_from_graph(g, &w);
+
+    for(int k = 1; k <= DIFF_MAX_K && k <= g->order && failure == NULL; k++) {
+        for(color cc = 0; cc < 2 && failure == NULL; cc++) {
+            uint64_t counts[GRAPH_MAX_ORDER + 1];
+            int clique[DIFF_MAX_K];
+            Cstore* store;
+            Cstore_scan scan;
+            int i = 0;
+
+            brute_list(g, k, cc, &ref[cc]);
+
+            got.count = 0;
+            graph_cliques_in(g, k, cc, graph_all(g->order), list_clique, &got);
+            if(!same_cliques(&ref[cc], &got, k)) {
+                failure = "graph_cliques_in";
+                break;
+            }
+
+            got.count = 0;
+            wide_cliques(&w, k, cc, list_clique, &got);
+            if(!same_cliques(&ref[cc], &got, k)) {
+                failure = "wide_cliques";
+                break;
+            }
+
+            graph_clique_counts(g, cc, graph_all(g->order), counts);
+            if(counts[k] != (uint64_t) ref[cc].count) {
+                failure = "graph_clique_counts";
+                break;
+            }
+
+            if(wide_has_clique(&w, k, cc) != (ref[cc].count > 0) ||
+               (graph_clique_number(g, cc, graph_all(g->order)) >= k) != (ref[cc].count > 0)) {
+                failure = "clique_number";
+                break;
+            }
+
+            store = cstore_new(k, 64, NULL);
+            for(int j = 0; j < ref[cc].count; j++) {
+                cstore_add(store, ref[cc].vertices + j * DIFF_MAX_K);
+            }
+            cstore_finish(store);
+            cstore_scan_init(store, &scan);
+            while(failure == NULL && cstore_scan_next(&scan, clique)) {
+                if(i == ref[cc].count ||
+                   memcmp(clique, ref[cc].vertices + i * DIFF_MAX_K, sizeof(int) * k) != 0) {
+                    failure = "cstore";
+                }
+                i++;
+            }
+            if(i != ref[cc].count) {
+                failure = "cstore";
+            }
+            cstore_free(store);
+        }
+
+        if(failure == NULL && k >= 2 && k <= CINDEX_MAX_K) {
+            Cindex* x = cindex_new(g, k);
+            Graph flipped = *g;
+
+            if(cindex_count(x) != ref[0].count + ref[1].count) {
+                failure = "cindex";
+            }
+            for(int f = 0; f < DIFF_CINDEX_FLIPS && failure == NULL; f++) {
+                int u = wide_rand_below(&rng, g->order);
+                int v = wide_rand_below(&rng, g->order);
+
+                if(u == v) {
+                    continue;
+                }
+                cindex_flip(x, u, v);
+                graph_set(&flipped, u, v, !graph_color(&flipped, u, v));
+
+                brute_list(&flipped, k, 0, &ref[0]);
+                brute_list(&flipped, k, 1, &ref[1]);
+                if(cindex_count(x) != ref[0].count + ref[1].count ||
+                   !same_graph(cindex_graph(x), &flipped)) {
+                    failure = "cindex flips";
+                }
+            }
+            cindex_free(x);
+        }
+    }
+
+    wide_free(&w);
+    list_free(&ref[0]);
+    list_free(&ref[1]);
+    list_free(&got);
+
+    return failure;
+}
+
+/* Reference rows: every row tried against every base clique. Stores the
+   rows closing none, sorted, and returns the fewest cliques any row closes */
+static int brute_rows(const Graph* g, int s, int t, Diff_list* rows) {
+    Diff_list base[2] = { { 0 } };
+    int best = -1;
+
+    brute_list(g, s - 1, 0, &base[0]);
+    brute_list(g, t - 1, 1, &base[1]);
+
+    rows->count = 0;
+    for(uint64_t row = 0; row < ((uint64_t)1) << g->order; row++) {
+        int closed = 0;
+
+        for(color cc = 0; cc < 2 && (best < 0 || closed <= best); cc++) {
+            for(int i = 0; i < base[cc].count && (best < 0 || closed <= best); i++) {
+                const int* clique = base[cc].vertices + i * DIFF_MAX_K;
+                bool mono = true;
+
+                for(int j = 0; j < base[cc].k && mono; j++) {
+                    mono = ((row >> clique[j]) & 1) == cc;
+                }
+                closed += mono;
+            }
+        }
+
+        if(best < 0 || closed < best) {
+            best = closed;
+        }
+        if(closed == 0) {
+            list_row(row, rows);
+        }
+    }
+
+    list_free(&base[0]);
+    list_free(&base[1]);
+
+    return best;
+}
+
+/* Rows of the instance by SAT, blocking each one found, up to limit */
+static int sat_rows(const Ext_clique* cliques, int count, int order, int limit, Diff_list* rows) {
+    Sat* sat = sat_new(order);
+    int lits[EXT_MAX_ORDER];
+    int status;
+
+    for(int i = 0; i < count; i++) {
+        sat_add_clause(sat, lits, ext_clause(&cliques[i], lits));
+    }
+
+    rows->count = 0;
+    while(rows->count < limit && (status = sat_solve(sat, NULL, 0, 0)) == SAT_SAT) {
+        uint64_t row = 0;
+
+        for(int v = 0; v < order; v++) {
+            if(sat_value(sat, v + 1)) {
+                row |= ((uint64_t)1) << v;
+            }
+            lits[v] = sat_value(sat, v + 1) ? -(v + 1) : v + 1;
+        }
+        list_row(row, rows);
+        sat_add_clause(sat, lits, order);
+    }
+    sat_free(sat);
+
+    sort_rows(rows);
+
+    return rows->count;
+}
+
+static const char* check_extension(const Graph* g, int s, int t, uint64_t seed) {
+    Diff_list ref = { 0 }, got = { 0 };
+    const char* failure = NULL;
+    Ext_clique* cliques;
+    Ext_clique* grown;
+    int count, grown_count, grown_size;
+    int best;
+
+    best = brute_rows(g, s, t, &ref);
+    cliques = ext_from_graph(g, s, t, &count);
+
+    /* The instance itself, from scratch and grown from g minus its last
+       vertex */
+    {
+        Diff_list base[2] = { { 0 } };
+        Graph less;
+
+        brute_list(g, s - 1, 0, &base[0]);
+        brute_list(g, t - 1, 1, &base[1]);
+        if(count != base[0].count + base[1].count) {
+            failure = "ext_from_graph";
+        }
+        list_free(&base[0]);
+        list_free(&base[1]);
+
+        delete_vertex(g, g->order - 1, &less);
+        grown = ext_from_graph(&less, s, t, &grown_count);
+        grown_size = grown_count;
+        ext_add_vertex(g, s, t, &grown, &grown_count, &grown_size);
+        if(failure == NULL && grown_count == count && count > 0) {
+            Ext_clique* sorted = malloc(sizeof(Ext_clique) * (count + 1));
+
+            if(sorted == NULL) {
+                perror("Could not alloc");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(sorted, cliques, sizeof(Ext_clique) * count);
+            qsort(sorted, count, sizeof(Ext_clique), compare_ext);
+            qsort(grown, grown_count, sizeof(Ext_clique), compare_ext);
+            for(int i = 0; i < count && failure == NULL; i++) {
+                if(compare_ext(&grown[i], &sorted[i]) != 0) {
+                    failure = "ext_add_vertex";
+                }
+            }
+            free(sorted);
+        } else if(failure == NULL && grown_count != count) {
+            failure = "ext_add_vertex";
+        }
+        free(grown);
+    }
+
+    if(failure == NULL) {
+        got.count = 0;
+        ext_enumerate(cliques, count, g->order, list_row, &got);
+        sort_rows(&got);
+        if(!same_rows(&got, &ref)) {
+            failure = "ext_enumerate";
+        }
+    }
+
+    if(failure == NULL) {
+        sat_rows(cliques, count, g->order, DIFF_MAX_SAT_ROWS, &got);
+        if(ref.count <= DIFF_MAX_SAT_ROWS) {
+            if(!same_rows(&got, &ref)) {
+                failure = "sat";
+            }
+        } else {
+            for(int i = 0; i < got.count && failure == NULL; i++) {
+                if(!has_row(&ref, got.rows[i])) {
+                    failure = "sat";
+                }
+            }
+        }
+    }
+
+    if(failure == NULL) {
+        Bnb_result result;
+
+        bnb_search(cliques, count, g->order, 0, NULL, &result);
+        if(result.violations != best ||
+           ext_count_violations(cliques, count, result.row) != best) {
+            failure = "bnb";
+        }
+    }
+
+    if(failure == NULL) {
+        Cube_result result;
+
+        cube_search(cliques, count, g->order, 4, 1, NULL, NULL, &result);
+        if((result.status == SAT_SAT) != (ref.count > 0) ||
+           (result.status == SAT_SAT && !has_row(&ref, result.row))) {
+            failure = "cube_search";
+        }
+    }
+
+    /* A session first solving the instance of g with one edge flipped */
+    if(failure == NULL) {
+        Session* session = session_new(g->order);
+        uint64_t rng = seed;
+        Graph near = *g;
+        Ext_clique* near_cliques;
+        int near_count, added, retracted, status;
+        uint64_t row;
+        int u = wide_rand_below(&rng, g->order);
+        int v = (u + 1 + wide_rand_below(&rng, g->order - 1)) % g->order;
+
+        graph_set(&near, u, v, !graph_color(g, u, v));
+        near_cliques = ext_from_graph(&near, s, t, &near_count);
+        session_update(session, near_cliques, near_count, &added, &retracted);
+        session_solve(session, &row);
+        session_update(session, cliques, count, &added, &retracted);
+        status = session_solve(session, &row);
+        if((status == SAT_SAT) != (ref.count > 0) || (status == SAT_SAT && !has_row(&ref, row))) {
+            failure = "session";
+        }
+        free(near_cliques);
+        session_free(session);
+    }
+
+    if(failure == NULL && s == 5 && t == 5) {
+        Recolor_result result;
+
+        recolor_search(g, cliques, count, 0, &result);
+        if((result.status == SAT_SAT) != (ref.count > 0) ||
+           (result.status == SAT_SAT && !has_row(&ref, result.row))) {
+            failure = "recolor_search";
+        }
+    }
+
+    if(failure == NULL && s == t) {
+        Ramsey_ctx ctx;
+        bool free_of = graph_clique_number(g, 0, graph_all(g->order)) < s &&
+                       graph_clique_number(g, 1, graph_all(g->order)) < t;
+
+        ramsey_init(&ctx, s, DIFF_PERM_BITS);
+        ramsey_from_graph(&ctx, g);
+        if(ramsey_verify(&ctx) != free_of) {
+            failure = "ramsey_verify";
+        } else if(ramsey_extend(&ctx) != (ref.count > 0)) {
+            failure = "ramsey_extend";
+        } else if(ref.count > 0) {
+            uint64_t row = 0;
+
+            for(int v = 0; v < g->order; v++) {
+                row |= ((uint64_t) ctx.row[v]) << v;
+            }
+            if(!has_row(&ref, row)) {
+                failure = "ramsey_extend";
+            }
+        }
+
+        /* The pipeline may find any row, from the filter kept by the search */
+        if(failure == NULL) {
+            if(ramsey_extend_pipeline(&ctx, 2, 2, false) != (ref.count > 0)) {
+                failure = "ramsey_extend_pipeline";
+            } else if(ref.count > 0) {
+                uint64_t row = 0;
+
+                for(int v = 0; v < g->order; v++) {
+                    row |= ((uint64_t) ctx.row[v]) << v;
+                }
+                if(!has_row(&ref, row)) {
+                    failure = "ramsey_extend_pipeline";
+                }
+            }
+        }
+        ramsey_free(&ctx);
+    }
+
+    /* Without a row to find local search runs all its tries, so it is only
+       run when one exists */
+    if(failure == NULL && ref.count > 0) {
+        Ls_result result;
+
+        ls_search(cliques, count, g->order, 1, seed, &result);
+        if(result.violations < best ||
+           ext_count_violations(cliques, count, result.row) != result.violations) {
+            failure = "ls_search";
+        }
+    }
+
+    free(cliques);
+    list_free(&ref);
+    list_free(&got);
+
+    return failure;
+}
+
+static const char* check_symmetry(const Graph* g, uint64_t seed) {
+    Graph relabeled, canon[2];
+    uint64_t rng = seed;
+    uint64_t group[2];
+    int perm[GRAPH_MAX_ORDER];
+
+    for(int v = 0; v < g->order; v++) {
+        perm[v] = v;
+    }
+    for(int v = g->order - 1; v > 0; v--) {
+        int u = wide_rand_below(&rng, v + 1);
+        int x = perm[u];
+
+        perm[u] = perm[v];
+        perm[v] = x;
+    }
+
+    graph_init(&relabeled, g->order);
+    for(int u = 0; u < g->order; u++) {
+        for(int v = u + 1; v < g->order; v++) {
+            graph_set(&relabeled, perm[u], perm[v], graph_color(g, u, v));
+        }
+    }
+
+    group[0] = graph_canonical(g, &canon[0], NULL);
+    group[1] = graph_canonical(&relabeled, &canon[1], NULL);
+    if(group[0] != group[1] || !same_graph(&canon[0], &canon[1])) {
+        return "graph_canonical";
+    }
+
+    return NULL;
+}
+
+/* The first check g fails, or NULL. The symmetry check is skipped if not
+   asked for */
+static const char* run_checks(const Graph* g, int s, int t, uint64_t seed, bool symmetry) {
+    const char* failure = check_cliques(g, seed);
+
+    if(failure == NULL && g->order >= 2) {
+        failure = check_extension(g, s, t, seed);
+    }
+    if(failure == NULL && symmetry) {
+        failure = check_symmetry(g, seed);
+    }
+
+    return failure;
+}
+
+static int blue_edges(const Graph* g) {
+    int blue = 0;
+
+    for(int u = 0; u < g->order; u++) {
+        blue += __builtin_popcountll(g->nbr[1][u]);
+    }
+
+    return blue / 2;
+}
+
+/* Delete vertices and recolor edges as long as the same check keeps
+   failing. Only edges of the more common color are recolored, and only
+   while that brings the blue density closer to 1/2, so the shrunk coloring
+   stays as balanced as the random ones. The symmetry check is only run when
+   it is the one being shrunk */
+static void shrink(Graph* g, int s, int t, uint64_t seed, const char* failure) {
+    bool symmetry = strcmp(failure, "graph_canonical") == 0;
+    bool changed = true;
+
+    while(changed) {
+        changed = false;
+
+        for(int x = g->order - 1; x >= 0 && g->order > 2; x--) {
+            Graph less;
+            const char* again;
+
+            delete_vertex(g, x, &less);
+            again = run_checks(&less, s, t, seed, symmetry);
+            if(again != NULL && strcmp(again, failure) == 0) {
+                *g = less;
+                changed = true;
+            }
+        }
+
+        for(int u = 0; u < g->order; u++) {
+            for(int v = u + 1; v < g->order; v++) {
+                int edges = g->order * (g->order - 1) / 2;
+                int blue = blue_edges(g);
+                color cc = graph_color(g, u, v);
+                Graph flipped = *g;
+                const char* again;
+
+                if(cc ? 2 * blue <= edges + 1 : 2 * blue + 1 >= edges) {
+                    continue;
+                }
+
+                graph_set(&flipped, u, v, !cc);
+                again = run_checks(&flipped, s, t, seed, symmetry);
+                if(again != NULL && strcmp(again, failure) == 0) {
+                    *g = flipped;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    struct timespec start;
+    uint64_t rng = (uint64_t) time(NULL);
+    int cases = 1000;
+    int order_min = 8, order_max = 20;
+    int fixed_s = 0, fixed_t = 0;
+    int failed = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:r:c:s:")) != -1) {
+        switch(opt) {
+        case 'n':
+            cases = atoi(optarg);
+            break;
+        case 'r':
+            if(sscanf(optarg, "%d,%d", &order_min, &order_max) != 2 || order_min < 2 ||
+               order_max > DIFF_MAX_ORDER || order_max < order_min) {
+                usage(argv[0]);
+            }
+            break;
+        case 'c':
+            if(sscanf(optarg, "%d,%d", &fixed_s, &fixed_t) != 2 || fixed_s < 3 || fixed_t < 3 ||
+               fixed_s > DIFF_MAX_K + 1 || fixed_t > DIFF_MAX_K + 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 's':
+            rng = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc != optind || cases < 1) {
+        usage(argv[0]);
+    }
+    if(rng == 0) {
+        rng = 1;
+    }
+
+    printf("Seed %llu, %d cases of order %d to %d\n", (unsigned long long) rng, cases,
+           order_min, order_max);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < cases; i++) {
+        int order = order_min + wide_rand_below(&rng, order_max - order_min + 1);
+        int s = fixed_s ? fixed_s : 3 + wide_rand_below(&rng, 3);
+        int t = fixed_t ? fixed_t : 3 + wide_rand_below(&rng, 3);
+        uint64_t density = UINT64_MAX / 4 + wide_rand(&rng) / 2;
+        uint64_t seed = wide_rand(&rng) | 1;
+        const char* failure;
+        Graph g;
+
+        graph_init(&g, order);
+        for(int u = 0; u < order; u++) {
+            for(int v = u + 1; v < order; v++) {
+                if(wide_rand(&rng) < density) {
+                    graph_set(&g, u, v, 1);
+                }
+            }
+        }
+
+        failure = run_checks(&g, s, t, seed, true);
+        if(failure == NULL) {
+            continue;
+        }
+
+        failed++;
+        printf("Case %d (order %d, R(%d, %d), seed %llu): %s disagrees with the reference\n",
+               i + 1, order, s, t, (unsigned long long) seed, failure);
+        shrink(&g, s, t, seed, failure);
+        printf("Shrunk to order %d:\n", g.order);
+        graph_dump(&g, stdout);
+        fflush(stdout);
+    }
+
+    printf("%d of %d cases failed (%.2fs)\n", failed, cases, elapsed(&start));
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+/**
+ * File: estimate.c
+ *
+ * Purpose: Approximate counts of monochromatic k-cliques in colorings too
+ *  large to enumerate, up to WIDE_MAX_ORDER vertices. Two unbiased
+ *  estimators are available:
+ *
+ *   walk    random walks through common neighborhoods (see wide_walk). Each
+ *           step is one AND and popcount over the bitset rows, and the walk
+ *           weights concentrate the samples on the cliques themselves.
+ *   subset  uniform vertex k-subsets, counting the monochromatic ones. Simple
+ *           but needs about 1 / p samples per clique found.
+ *
+ *  Samples are drawn in batches until the normal confidence interval of the
+ *  mean is within the requested relative error, or the sample limit is hit.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gen.h"
+#include "wide.h"
+
+/* Samples between checks of the confidence interval */
+#define ESTIMATE_BATCH 10000
+
+/* Samples drawn before the interval is trusted */
+#define ESTIMATE_MIN_SAMPLES 100000
+
+/* Samples without a single hit before the color is given up as cliqueless */
+#define ESTIMATE_ZERO_SAMPLES 10000000
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-k k] [-e walk|subset] [-r error] [-z quantile] [-n samples] "
+            "[-s seed] [-x] <graph|spec>\n"
+            "  -k  clique size (default 5)\n"
+            "  -e  estimator (default walk)\n"
+            "  -r  relative error to stop at (default 0.01)\n"
+            "  -z  normal quantile of the confidence level (default 1.96, i.e. 95%%)\n"
+            "  -n  most samples per color (default 1000000000)\n"
+            "  -s  random seed\n"
+            "  -x  also count exactly, for comparison\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Is a uniform random k-subset a k-clique of color cc */
+static bool sample_subset(const Wide_graph* g, int k, color cc, uint64_t* rng) {
+    int picked[64];
+
+    for(int i = 0; i < k; i++) {
+        bool fresh;
+
+        do {
+            picked[i] = (int) wide_rand_below(rng, g->order);
+            fresh = true;
+            for(int j = 0; j < i; j++) {
+                fresh = fresh && picked[j] != picked[i];
+            }
+        } while(!fresh);
+
+        for(int j = 0; j < i; j++) {
+            if(wide_color(g, picked[i], picked[j]) != cc) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* estimator = "walk";
+    double rel_error = 0.01;
+    double quantile = 1.96;
+    uint64_t max_samples = 1000000000;
+    uint64_t rng = (uint64_t) time(NULL);
+    bool exact = false;
+    bool walk;
+    double scale;
+    Wide_graph g;
+    int k = 5;
+    int opt;
+
+    while((opt = getopt(argc, argv, "k:e:r:z:n:s:x")) != -1) {
+        switch(opt) {
+        case 'k':
+            k = atoi(optarg);
+            break;
+        case 'e':
+            estimator = optarg;
+            break;
+        case 'r':
+            rel_error = atof(optarg);
+            break;
+        case 'z':
+            quantile = atof(optarg);
+            break;
+        case 'n':
+            max_samples = strtoull(optarg, NULL, 0);
+            break;
+        case 's':
+            rng = strtoull(optarg, NULL, 0);
+            break;
+        case 'x':
+            exact = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    walk = strcmp(estimator, "walk") == 0;
+    if(argc - optind != 1 || k < 2 || k > 64 || rel_error <= 0 || quantile <= 0 ||
+       (!walk && strcmp(estimator, "subset") != 0)) {
+        usage(argv[0]);
+    }
+    if(rng == 0) {
+        rng = 1;
+    }
+
+    gen_load(&g, argv[optind]);
+    if(k > g.order) {
+        usage(argv[0]);
+    }
+
+    /* A walk's weight counts ordered cliques, a subset hit stands for all
+       C(n, k) subsets */
+    scale = 1;
+    for(int i = 0; i < k; i++) {
+        scale *= walk ? 1.0 / (i + 1) : (double)(g.order - i) / (i + 1);
+    }
+
+    printf("Order %d, estimating K%d by %s sampling to within %.2f%% (z = %.2f)\n",
+           g.order, k, estimator, rel_error * 100, quantile);
+
+    for(color cc = 0; cc < 2; cc++) {
+        struct timespec start;
+        double mean = 0, m2 = 0, half = 0;
+        uint64_t n = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        /* Welford's running mean and variance of the scaled samples */
+        while(n < max_samples) {
+            for(int i = 0; i < ESTIMATE_BATCH && n < max_samples; i++) {
+                double x = walk ? wide_walk(&g, k, cc, &rng) * scale :
+                           sample_subset(&g, k, cc, &rng) ? scale : 0;
+                double delta = x - mean;
+
+                n++;
+                mean += delta / n;
+                m2 += delta * (x - mean);
+            }
+
+            half = n > 1 ? quantile * sqrt(m2 / (n - 1) / n) : 0;
+            if(n >= ESTIMATE_MIN_SAMPLES && mean > 0 && half <= rel_error * mean) {
+                break;
+            }
+            if(n >= ESTIMATE_ZERO_SAMPLES && mean == 0) {
+                break;
+            }
+        }
+
+        printf("%-4s K%d: %.6g +- %.3g (%.2f%%), %llu samples, %.2fs",
+               cc ? "Blue" : "Red", k, mean, half, mean > 0 ? 100 * half / mean : 0.0,
+               (unsigned long long) n, elapsed(&start));
+        if(mean == 0) {
+            printf(", none sampled");
+        } else if(half > rel_error * mean) {
+            printf(", sample limit reached");
+        }
+        if(exact) {
+            printf(", exactly %llu", (unsigned long long) wide_cliques(&g, k, cc, NULL, NULL));
+        }
+        printf("\n");
+    }
+
+    wide_free(&g);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,449 @@
+/**
+ * File: explore.c
+ *
+ * Purpose: Interactive exploration of edits to a base R(5, 5) coloring. The
+ *  valid new rows of the base graph are enumerated once, then edge flips read
+ *  from stdin update them in place instead of re-running the extension. The
+ *  4-clique constraints are kept in an incremental clique index, so a flip of
+ *  uv only changes the constraints through both u and v:
+ *
+ *   - rows closing a constraint the flip added are dropped from the set;
+ *   - rows closing a constraint the flip removed were filtered out before and
+ *     may now be valid. Each removed constraint contained u and v with their
+ *     old color, so they are enumerated with those two bits fixed, branching
+ *     on the other vertices of the removed constraints first and giving up
+ *     on a branch once it can close none of them.
+ *
+ *  Every row in the set closes no constraint, so the revalidated rows are
+ *  never already in it.
+ *
+ *  Commands:
+ *   f <u> <v>   flip edge uv
+ *   r           print the valid rows
+ *   g           print the base graph
+ *   q           quit
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cindex.h"
+#include "extension.h"
+#include "graph.h"
+
+/* Default base graph */
+#define ADJ_MATRIX_FILE "g55.42"
+
+/* Size of cliques to avoid */
+#define CLIQUE_N 5
+
+/* Valid rows of the current base graph */
+typedef struct {
+    uint64_t* rows;
+    int count;
+    int size;
+} Row_set;
+
+/* Revalidation after a flip of uv. Every removed constraint went through uv
+   with its old color, so only rows with both of those bits of the old color
+   can close one. The other vertices are renumbered into positions, those of
+   the removed constraints first, so a branch is given up as soon as it
+   closes none of them */
+typedef struct {
+    /* Fixed bits of the full row, and the vertex at each position */
+    uint64_t values;
+    int vertex[GRAPH_MAX_ORDER];
+    int positions;
+
+    /* Constraints over positions; those whose highest position is i are
+       cliques[by_last[start[i]]] up to cliques[by_last[start[i + 1]]] */
+    Ext_clique* cliques;
+    int* by_last;
+    int start[GRAPH_MAX_ORDER + 1];
+
+    /* Removed constraints of the current batch through each position */
+    uint64_t through[GRAPH_MAX_ORDER];
+    color old;
+
+    Row_set* out;
+} Revalidation;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static bool check = false;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-p n] [-c] [graph]\n"
+            "  -p  explore the coloring induced on the first n vertices\n"
+            "  -c  check every update against a full re-enumeration\n"
+            "Commands on stdin: f <u> <v> (flip), r (rows), g (graph), q (quit)\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void row_add(Row_set* set, uint64_t row) {
+    if(set->count == set->size) {
+        set->size = set->size ? 2 * set->size : 1024;
+        set->rows = realloc(set->rows, sizeof(uint64_t) * set->size);
+        if(set->rows == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    set->rows[set->count++] = row;
+}
+
+static void collect_row(uint64_t row, void* arg) {
+    row_add(arg, row);
+}
+
+static int compare_rows(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* The live constraints of the index, packed */
+static Ext_clique* live_cliques(const Cindex* index, int* count) {
+    int slots;
+    const Ext_clique* all = cindex_cliques(index, &slots);
+    Ext_clique* cliques = malloc(sizeof(Ext_clique) * (cindex_count(index) + 1));
+
+    if(cliques == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    *count = 0;
+    for(int id = 0; id < slots; id++) {
+        if(cindex_live(index, id)) {
+            cliques[(*count)++] = all[id];
+        }
+    }
+
+    return cliques;
+}
+
+static void revalidate_dfs(Revalidation* r, int i, uint64_t row, uint64_t closable) {
+    if(closable == 0) {
+        return;
+    }
+
+    if(i == r->positions) {
+        uint64_t full = r->values;
+
+        for(int j = 0; j < r->positions; j++) {
+            if((row >> j) & 1) {
+                full |= ((uint64_t)1) << r->vertex[j];
+            }
+        }
+        row_add(r->out, full);
+        return;
+    }
+
+    for(int value = 0; value < 2; value++) {
+        uint64_t next = value ? row | (((uint64_t)1) << i) : row;
+        bool ok = true;
+
+        for(int j = r->start[i]; j < r->start[i + 1] && ok; j++) {
+            ok = !ext_violated(&r->cliques[r->by_last[j]], next);
+        }
+
+        if(ok) {
+            revalidate_dfs(r, i + 1, next, value == r->old ? closable : closable & ~r->through[i]);
+        }
+    }
+}
+
+/* Add every row closing none of the live constraints and at least one of the
+   removed ones, possibly more than once */
+static void revalidate(const Ext_clique* cliques, int count, int order, int u, int v, color old,
+                       const Ext_clique* all, const int* removed, int removed_count, Row_set* out) {
+    uint64_t fixed = (((uint64_t)1) << u) | (((uint64_t)1) << v);
+    uint64_t first = 0;
+    int position[GRAPH_MAX_ORDER];
+    int fill[GRAPH_MAX_ORDER + 1] = {0};
+    Revalidation r;
+    int n = 0;
+
+    r.values = old ? fixed : 0;
+    r.old = old;
+    r.out = out;
+    r.cliques = malloc(sizeof(Ext_clique) * (count + 1));
+    r.by_last = malloc(sizeof(int) * (count + 1));
+    if(r.cliques == NULL || r.by_last == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int j = 0; j < removed_count; j++) {
+        first |= all[removed[j]].mask;
+    }
+    first &= ~fixed;
+
+    r.positions = 0;
+    for(uint64_t m = first; m; m &= m - 1) {
+        r.vertex[r.positions++] = __builtin_ctzll(m);
+    }
+    for(int w = 0; w < order; w++) {
+        if(!((fixed | first) >> w & 1)) {
+            r.vertex[r.positions++] = w;
+        }
+    }
+    for(int i = 0; i < r.positions; i++) {
+        position[r.vertex[i]] = i;
+    }
+
+    /* A constraint with a fixed bit of the other color can not be closed; one
+       whose fixed bits all match it only constrains the rest */
+    for(int i = 0; i < count; i++) {
+        uint64_t rest = cliques[i].mask & ~fixed;
+
+        if((cliques[i].mask & fixed) && cliques[i].cc != old) {
+            continue;
+        }
+        if(rest == 0) {
+            goto done;
+        }
+
+        r.cliques[n].mask = 0;
+        r.cliques[n].cc = cliques[i].cc;
+        for(; rest; rest &= rest - 1) {
+            r.cliques[n].mask |= ((uint64_t)1) << position[__builtin_ctzll(rest)];
+        }
+        n++;
+    }
+
+    memset(r.start, 0, sizeof(r.start));
+    for(int i = 0; i < n; i++) {
+        r.start[63 - __builtin_clzll(r.cliques[i].mask) + 1]++;
+    }
+    for(int i = 0; i < r.positions; i++) {
+        r.start[i + 1] += r.start[i];
+    }
+    for(int i = 0; i < n; i++) {
+        int last = 63 - __builtin_clzll(r.cliques[i].mask);
+
+        r.by_last[r.start[last] + fill[last]++] = i;
+    }
+
+    /* The removed constraints are tracked 64 at a time */
+    for(int base = 0; base < removed_count; base += 64) {
+        int batch = removed_count - base < 64 ? removed_count - base : 64;
+
+        memset(r.through, 0, sizeof(r.through));
+        for(int j = 0; j < batch; j++) {
+            for(uint64_t m = all[removed[base + j]].mask & ~fixed; m; m &= m - 1) {
+                r.through[position[__builtin_ctzll(m)]] |= ((uint64_t)1) << j;
+            }
+        }
+
+        revalidate_dfs(&r, 0, 0, batch == 64 ? ~(uint64_t)0 : (((uint64_t)1) << batch) - 1);
+    }
+
+done:
+    free(r.cliques);
+    free(r.by_last);
+}
+
+/* Monochromatic 5-cliques of the base graph through edge uv */
+static uint64_t base_cliques_through(const Graph* g, int u, int v) {
+    color cc = graph_color(g, u, v);
+
+    return graph_cliques_in(g, CLIQUE_N - 2, cc, g->nbr[cc][u] & g->nbr[cc][v], NULL, NULL);
+}
+
+/* Compare the row set with a full enumeration of the instance */
+static void check_rows(const Cindex* index, Row_set* set) {
+    Row_set full = { NULL, 0, 0 };
+    Ext_clique* cliques;
+    int count;
+
+    cliques = live_cliques(index, &count);
+    ext_enumerate(cliques, count, cindex_graph(index)->order, collect_row, &full);
+    if(full.count > 0) {
+        qsort(full.rows, full.count, sizeof(uint64_t), compare_rows);
+    }
+    if(set->count > 0) {
+        qsort(set->rows, set->count, sizeof(uint64_t), compare_rows);
+    }
+
+    if(full.count != set->count ||
+       (full.count > 0 && memcmp(full.rows, set->rows, sizeof(uint64_t) * full.count) != 0)) {
+        fprintf(stderr, "Error: %d rows kept, full enumeration finds %d\n", set->count, full.count);
+        exit(EXIT_FAILURE);
+    }
+
+    free(full.rows);
+    free(cliques);
+}
+
+static void flip(Cindex* index, Row_set* set, uint64_t* base_cliques, int u, int v) {
+    const Graph* g = cindex_graph(index);
+    const Ext_clique* all;
+    const int* ids;
+    Ext_clique* cliques;
+    struct timespec start;
+    int slots, removed, added, count, kept = 0, before;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    *base_cliques -= base_cliques_through(g, u, v);
+    cindex_flip(index, u, v);
+    *base_cliques += base_cliques_through(g, u, v);
+
+    all = cindex_cliques(index, &slots);
+
+    /* Drop the rows closing an added constraint */
+    ids = cindex_added(index, &added);
+    for(int i = 0; i < set->count; i++) {
+        bool ok = true;
+
+        for(int j = 0; j < added && ok; j++) {
+            ok = !ext_violated(&all[ids[j]], set->rows[i]);
+        }
+        if(ok) {
+            set->rows[kept++] = set->rows[i];
+        }
+    }
+    before = set->count;
+    set->count = kept;
+
+    /* Revalidate the rows closing a removed constraint. A row closing several
+       batches of them is found once for each, so the new rows are
+       deduplicated */
+    ids = cindex_removed(index, &removed);
+    if(removed > 0) {
+        Row_set fresh = { NULL, 0, 0 };
+
+        cliques = live_cliques(index, &count);
+        revalidate(cliques, count, g->order, u, v, !graph_color(g, u, v), all, ids, removed, &fresh);
+
+        if(fresh.count > 0) {
+            qsort(fresh.rows, fresh.count, sizeof(uint64_t), compare_rows);
+            for(int i = 0; i < fresh.count; i++) {
+                if(i == 0 || fresh.rows[i] != fresh.rows[i - 1]) {
+                    row_add(set, fresh.rows[i]);
+                }
+            }
+        }
+
+        free(fresh.rows);
+        free(cliques);
+    }
+
+    printf("Flipped %d-%d to %s: -%d +%d constraints, -%d +%d rows, %d valid rows, "
+           "%llu base 5-cliques (%.3fms)\n",
+           u, v, graph_color(g, u, v) ? "blue" : "red", removed, added,
+           before - kept, set->count - kept, set->count,
+           (unsigned long long) *base_cliques, elapsed(&start) * 1e3);
+
+    if(check) {
+        check_rows(index, set);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = ADJ_MATRIX_FILE;
+    struct timespec start;
+    Row_set set = { NULL, 0, 0 };
+    Ext_clique* cliques;
+    Cindex* index;
+    Graph g;
+    char line[256];
+    uint64_t base_cliques;
+    int prefix = 0;
+    int opt, count;
+
+    while((opt = getopt(argc, argv, "p:c")) != -1) {
+        switch(opt) {
+        case 'p':
+            prefix = atoi(optarg);
+            break;
+        case 'c':
+            check = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind > 1) {
+        usage(argv[0]);
+    }
+    if(argc - optind == 1) {
+        path = argv[optind];
+    }
+
+    graph_load(&g, path);
+    if(prefix > 0 && prefix < g.order) {
+        Graph full = g;
+
+        graph_init(&g, prefix);
+        for(int u = 0; u < prefix; u++) {
+            for(int v = u + 1; v < prefix; v++) {
+                graph_set(&g, u, v, graph_color(&full, u, v));
+            }
+        }
+    }
+    if(g.order >= GRAPH_MAX_ORDER) {
+        fprintf(stderr, "Error: order %d is too large to extend\n", g.order);
+        exit(EXIT_FAILURE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    index = cindex_new(&g, CLIQUE_N - 1);
+    base_cliques = graph_cliques(&g, CLIQUE_N, NULL, NULL);
+    cliques = live_cliques(index, &count);
+    ext_enumerate(cliques, count, g.order, collect_row, &set);
+    free(cliques);
+
+    printf("Order %d: %d constraints, %d valid rows, %llu base 5-cliques (%.3fs)\n",
+           g.order, count, set.count, (unsigned long long) base_cliques, elapsed(&start));
+    fflush(stdout);
+
+    while(fgets(line, sizeof(line), stdin) != NULL) {
+        int u, v;
+
+        if(line[0] == 'q') {
+            break;
+        } else if(line[0] == 'f' && sscanf(line + 1, "%d %d", &u, &v) == 2) {
+            if(u < 0 || v < 0 || u >= g.order || v >= g.order || u == v) {
+                printf("No edge %d-%d\n", u, v);
+            } else {
+                flip(index, &set, &base_cliques, u, v);
+            }
+        } else if(line[0] == 'r') {
+            for(int i = 0; i < set.count; i++) {
+                ext_print_row(set.rows[i], g.order);
+                printf("\n");
+            }
+        } else if(line[0] == 'g') {
+            graph_dump(cindex_graph(index), stdout);
+        } else if(line[0] != '\n') {
+            printf("Unknown command\n");
+        }
+        fflush(stdout);
+    }
+
+    cindex_free(index);
+    free(set.rows);
+
+    return EXIT_SUCCESS;
+}
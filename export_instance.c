@@ -0,0 +1,333 @@
+/**
+ * File: export_instance.c
+ *
+ * Purpose: Write Ramsey instances for external SAT and pseudo-Boolean solvers,
+ *  as DIMACS CNF or OPB.
+ *
+ *  extension: the one-vertex extension of a base graph (default g55.42). Var
+ *   i + 1 is true when the edge from the new vertex to vertex i is blue, with
+ *   one clause per monochromatic 4-clique of the base graph, in the same order
+ *   as extend_graph. With -m the OPB instance is soft instead: each clause gets
+ *   a relaxation var and the objective minimizes the cliques closed.
+ *
+ *  coloring: the R(s, t) coloring of the complete graph on n vertices. Edge
+ *   ij, i < j, is var i * (2n - i - 1) / 2 + (j - i), true when blue. Every
+ *   s-subset must have a blue edge and every t-subset a red one.
+ *
+ * Clauses are written as they are generated, so instances with millions of
+ * clauses never sit in memory; the header counts are worked out up front.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "extension.h"
+#include "graph.h"
+
+/* Default base graph of extension instances */
+#define ADJ_MATRIX_FILE "g55.42"
+
+/* Largest complete graph a coloring instance may be written for */
+#define COLORING_MAX_ORDER 1024
+
+/* Output buffer size */
+#define OUT_BUFFER_SIZE (1 << 20)
+
+typedef enum { FORMAT_CNF, FORMAT_OPB } Format;
+
+static void usage(const char* prog);
+static uint64_t binomial(int n, int k);
+static void put_int(long long n, FILE* f);
+static void put_clause(const int* lits, int n, int relax, FILE* f);
+static void put_header(uint64_t vars, uint64_t clauses, FILE* f);
+static void export_extension(const char* path);
+static void export_coloring(int n, int s, int t);
+
+static Format format = FORMAT_CNF;
+static bool symmetry = false;
+static bool soft = false;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-f cnf|opb] [-m] extension [graph]\n"
+            "       %s [-f cnf|opb] [-y] coloring <n> <s> <t>\n"
+            "  -f  output format (default cnf)\n"
+            "  -m  soft extension instance minimizing closed cliques (opb only)\n"
+            "  -y  add symmetry breaking clauses\n", prog, prog);
+    exit(EXIT_FAILURE);
+}
+
+/* n choose k, or UINT64_MAX if it overflows */
+static uint64_t binomial(int n, int k) {
+    uint64_t r = 1;
+
+    if(k < 0 || k > n) {
+        return 0;
+    }
+    if(k > n - k) {
+        k = n - k;
+    }
+
+    for(int i = 1; i <= k; i++) {
+        /* r * (n - k + i) / i is exact since r * (n - k + i) = i * C(n - k + i, i) */
+        if(r > UINT64_MAX / (n - k + i)) {
+            return UINT64_MAX;
+        }
+        r = r * (n - k + i) / i;
+    }
+
+    return r;
+}
+
+/* fprintf is the bottleneck for large instances */
+static void put_int(long long n, FILE* f) {
+    char buf[24];
+    int i = sizeof(buf);
+    bool neg = n < 0;
+    unsigned long long u = neg ? -(unsigned long long)n : (unsigned long long)n;
+
+    do {
+        buf[--i] = '0' + u % 10;
+        u /= 10;
+    } while(u);
+
+    if(neg) {
+        buf[--i] = '-';
+    }
+
+    fwrite(buf + i, 1, sizeof(buf) - i, f);
+}
+
+/* Write one clause of DIMACS literals. A relaxation var, if not 0, is added
+   to the clause */
+static void put_clause(const int* lits, int n, int relax, FILE* f) {
+    if(format == FORMAT_CNF) {
+        for(int i = 0; i < n; i++) {
+            put_int(lits[i], f);
+            fputc(' ', f);
+        }
+        if(relax) {
+            put_int(relax, f);
+            fputc(' ', f);
+        }
+        fputs("0\n", f);
+        return;
+    }
+
+    for(int i = 0; i < n; i++) {
+        fputs(lits[i] < 0 ? "+1 ~x" : "+1 x", f);
+        put_int(abs(lits[i]), f);
+        fputc(' ', f);
+    }
+    if(relax) {
+        fputs("+1 x", f);
+        put_int(relax, f);
+        fputc(' ', f);
+    }
+    fputs(">= 1 ;\n", f);
+}
+
+/* Both formats allow the header first, which OPB requires */
+static void put_header(uint64_t vars, uint64_t clauses, FILE* f) {
+    if(format == FORMAT_CNF) {
+        fprintf(f, "p cnf %llu %llu\n", (unsigned long long) vars, (unsigned long long) clauses);
+    } else {
+        fprintf(f, "* #variable= %llu #constraint= %llu\n",
+                (unsigned long long) vars, (unsigned long long) clauses);
+    }
+}
+
+static void export_extension(const char* path) {
+    const char* c = format == FORMAT_CNF ? "c" : "*";
+    Ext_clique* cliques;
+    Graph g;
+    int count;
+    int lits[4];
+
+    graph_load(&g, path);
+    cliques = ext_from_graph(&g, 5, 5, &count);
+
+    put_header(g.order + (soft ? count : 0), count, stdout);
+    fprintf(stdout, "%s extension of %s, order %d, %d monochromatic 4-cliques\n",
+            c, path, g.order, count);
+    fprintf(stdout, "%s var i + 1 is true when the edge to vertex i is blue\n", c);
+
+    if(soft) {
+        fprintf(stdout, "* var %d + k is true when clique k is closed\n", g.order);
+
+        fputs("min: ", stdout);
+        for(int i = 0; i < count; i++) {
+            fputs("+1 x", stdout);
+            put_int(g.order + i + 1, stdout);
+            fputc(' ', stdout);
+        }
+        fputs(";\n", stdout);
+    }
+
+    for(int i = 0; i < count; i++) {
+        int n = ext_clause(&cliques[i], lits);
+
+        put_clause(lits, n, soft ? g.order + i + 1 : 0, stdout);
+    }
+
+    free(cliques);
+}
+
+/* Var of edge ij, i < j */
+static inline int edge_var(int n, int i, int j) {
+    return i * (2 * n - i - 1) / 2 + (j - i);
+}
+
+static void export_coloring(int n, int s, int t) {
+    const char* c = format == FORMAT_CNF ? "c" : "*";
+    uint64_t vars = (uint64_t) n * (n - 1) / 2;
+    uint64_t clauses = binomial(n, s) + binomial(n, t);
+    uint64_t breaking = 0;
+    int* lits = malloc(sizeof(int) * (s > t ? s * s : t * t));
+    int subset[COLORING_MAX_ORDER];
+
+    if(lits == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    if(binomial(n, s) == UINT64_MAX || binomial(n, t) == UINT64_MAX) {
+        fprintf(stderr, "Error: instance is too large\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Vertices 1..n-1 can always be relabeled so vertex 0's red edges come
+       first, and when s == t the colors can be swapped so vertex 0 has a red
+       edge, which then goes to vertex 1 */
+    if(symmetry) {
+        breaking = n - 2 + (s == t);
+    }
+
+    put_header(vars, clauses + breaking, stdout);
+    fprintf(stdout, "%s R(%d, %d) coloring of K%d\n", c, s, t, n);
+    fprintf(stdout, "%s var i * (2n - i - 1) / 2 + (j - i) is true when edge ij, i < j, is blue\n", c);
+
+    for(int pass = 0; pass < 2; pass++) {
+        int k = pass ? t : s;
+
+        /* Red k-cliques are forbidden by a blue edge, blue ones by a red edge */
+        for(int i = 0; i < k; i++) {
+            subset[i] = i;
+        }
+
+        for(;;) {
+            int m = 0;
+            int i;
+
+            for(int a = 0; a < k; a++) {
+                for(int b = a + 1; b < k; b++) {
+                    int var = edge_var(n, subset[a], subset[b]);
+
+                    lits[m++] = pass ? -var : var;
+                }
+            }
+            put_clause(lits, m, 0, stdout);
+
+            /* Next k-subset in lexicographic order */
+            for(i = k - 1; i >= 0 && subset[i] == n - k + i; i--);
+            if(i < 0) {
+                break;
+            }
+            subset[i]++;
+            for(i++; i < k; i++) {
+                subset[i] = subset[i - 1] + 1;
+            }
+        }
+    }
+
+    if(symmetry) {
+        for(int j = 1; j + 1 < n; j++) {
+            lits[0] = -edge_var(n, 0, j);
+            lits[1] = edge_var(n, 0, j + 1);
+            put_clause(lits, 2, 0, stdout);
+        }
+        if(s == t) {
+            lits[0] = -edge_var(n, 0, 1);
+            put_clause(lits, 1, 0, stdout);
+        }
+    }
+
+    free(lits);
+}
+
+int main(int argc, char** argv) {
+    static char out_buffer[OUT_BUFFER_SIZE];
+    int opt;
+
+    while((opt = getopt(argc, argv, "f:my")) != -1) {
+        switch(opt) {
+        case 'f':
+            if(strcmp(optarg, "cnf") == 0) {
+                format = FORMAT_CNF;
+            } else if(strcmp(optarg, "opb") == 0) {
+                format = FORMAT_OPB;
+            } else {
+                usage(argv[0]);
+            }
+            break;
+        case 'm':
+            soft = true;
+            break;
+        case 'y':
+            symmetry = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(optind >= argc) {
+        usage(argv[0]);
+    }
+
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    if(strcmp(argv[optind], "extension") == 0) {
+        if(argc - optind > 2) {
+            usage(argv[0]);
+        }
+        if(soft && format != FORMAT_OPB) {
+            fprintf(stderr, "Error: -m needs -f opb\n");
+            exit(EXIT_FAILURE);
+        }
+        /* The base graph is fixed, so there is no relabeling to break */
+        if(symmetry) {
+            fprintf(stderr, "Error: -y only applies to coloring instances\n");
+            exit(EXIT_FAILURE);
+        }
+        export_extension(argc - optind == 2 ? argv[optind + 1] : ADJ_MATRIX_FILE);
+    } else if(strcmp(argv[optind], "coloring") == 0) {
+        int n, s, t;
+
+        if(argc - optind != 4 || soft) {
+            usage(argv[0]);
+        }
+
+        n = atoi(argv[optind + 1]);
+        s = atoi(argv[optind + 2]);
+        t = atoi(argv[optind + 3]);
+        if(n < 2 || n > COLORING_MAX_ORDER || s < 2 || s > n || t < 2 || t > n) {
+            fprintf(stderr, "Error: need 2 <= s, t <= n <= %d\n", COLORING_MAX_ORDER);
+            exit(EXIT_FAILURE);
+        }
+        export_coloring(n, s, t);
+    } else {
+        usage(argv[0]);
+    }
+
+    if(fflush(stdout) != 0) {
+        perror("Could not write instance");
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
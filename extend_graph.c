@@ -13,11 +13,26 @@
  *  attepmted without success, the program will simply exit.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bnb.h"
+#include "cube.h"
+#include "extension.h"
+#include "local_search.h"
+#include "ramsey.h"
+#include "recolor.h"
+#include "sat.h"
+#include "session.h"
 
 /* Size of cliques to find */
 #define CLIQUE_N 5
@@ -26,598 +41,776 @@
 #define ADJ_MATRIX_FILE "g55.42"
 #define ADJ_MATRIX_ORDER 42
 
-/* Size in bits of the permutation space that will be held in memory (should be less than 32) */
-#define PERM_BLOCK_SIZE 26
-#define PERM_BLOCK_HIGH_MASK ((uint32_t)(~((1 << PERM_BLOCK_SIZE) - 1)))
-#define PERM_FILTER_PASSES 32
-#define PERM_SPACE_SIZE (1 << PERM_BLOCK_SIZE)
-
-/* Debug flags */
-#define SHOW_PERMUTATIONS 0
-#define TRACK_MAX_SUCCESS 0
-
-/* Color of each edge (0 -> red, 1 -> blue) */
-typedef uint8_t color;
-
-struct Perm_s {
-    uint32_t perm;
-    struct Perm_s* prev;
-    struct Perm_s* next;
-    uint32_t __pad;
-};
-typedef struct Perm_s Perm;
-
-static color** load_matrix(void);
-static void dump_graph(color** matrix, int order);
-static void print_bin(uint32_t n, uint8_t width);
-
-static color** expand(color** matrix, int n);
-static inline bool next_graph(color** matrix, int order);
-static inline bool is_monochromatic(uint16_t* clique, color** matrix);
-
-static bool next_n_clique(uint16_t* clique, uint16_t size);
-static bool is_n_monochromatic(uint16_t* clique, int n, color** matrix);
-static uint16_t** find_monochromatic_n_cliques(color** matrix, int order, int n, int* cliques_found);
-
-static void perm_alloc(void);
-static void perm_free(void);
-static void perm_init(void);
-static inline void perm_remove(Perm* p);
-static inline Perm* perm_next_with_mask(Perm* p, uint32_t mask, color cc);
-static inline bool perm_mask(uint16_t* clique);
-static void perm_regroup(void);
-static void perm_build_static_list(void);
-
-/* Permutation generator state */
-static Perm* perm_block = NULL;
-static Perm* perm_head = NULL;
-static Perm* perm_reset_head = NULL;
-static uint32_t perm_count = 0;
-static uint32_t* perm_filtered = NULL;
-static uint32_t* perm_filtered_start = NULL;
-static uint32_t* perm_filtered_end = NULL;
-
-static color** load_matrix(void) {
+/* Vertex replacement state shared between threads */
+typedef struct {
+    const Ext_clique* cliques;
+    int count;
+    int order;
+    const Graph* g;
+    const Graph* canon;
+
+    /* Orbit representatives to replace, and their replacement rows with
+       those giving a graph isomorphic to the original flagged */
+    const int* vertices;
+    int vertex_count;
+    uint64_t** rows;
+    bool** isomorphic;
+    int* row_counts;
+
+    pthread_mutex_t lock;
+    int next;
+} Replace_shared;
+
+/* Replacement rows of one vertex being collected */
+typedef struct {
+    const Replace_shared* shared;
+    int v;
+    uint64_t* rows;
+    bool* isomorphic;
+    int count;
+    int size;
+} Replace_job;
+
+static FILE* open_proof(void);
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static Ext_clique* build_ext_cliques(uint16_t** five_cliques, int count);
+static void build_graph(color** matrix, int order, Graph* g);
+static void dump_extension(color** matrix, int order, uint64_t row);
+static void run_local_search(color** matrix, int order, uint16_t** five_cliques, int count);
+static void run_branch_and_bound(color** matrix, int order, uint16_t** five_cliques, int count);
+static void run_cube_and_conquer(color** matrix, int order, uint16_t** five_cliques, int count);
+static void run_vertex_deleted_sequence(color** matrix, int order, uint16_t** five_cliques, int count);
+static void run_vertex_replacement(color** matrix, int order, uint16_t** five_cliques, int count);
+static void run_recoloring(color** matrix, int order, uint16_t** five_cliques, int count);
+static void run_permutation_search(Ramsey_ctx* ctx);
+
+/* Search options */
+static int search_threads = 1;
+static uint64_t search_seed = 0;
+static int cube_depth = CUBE_DEPTH;
+static const char* cube_log_path = NULL;
+static const char* proof_path = NULL;
+static int recolor_flips = -1;
+static bool pin_threads = false;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-l | -b | -s | -i | -v | -f flips] [-t threads] [-a] [-r seed] [-d depth] [-o log] [-p proof]\n", prog);
+    fprintf(stderr, "  -l  stochastic local search for a row with the fewest 5-cliques\n");
+    fprintf(stderr, "  -b  branch and bound for a row with provably fewest 5-cliques\n");
+    fprintf(stderr, "  -s  cube-and-conquer SAT search for a clique-less row\n");
+    fprintf(stderr, "  -i  incremental SAT over every vertex-deleted and one-edge recolored variant\n");
+    fprintf(stderr, "  -v  every replacement row for each vertex, up to automorphism\n");
+    fprintf(stderr, "  -f  SAT search for a row after recoloring at most flips base edges\n");
+    fprintf(stderr, "  -t  number of search threads (default: one per CPU)\n");
+    fprintf(stderr, "  -a  pin the permutation search pipeline threads to cores\n");
+    fprintf(stderr, "  -r  random seed for the local search\n");
+    fprintf(stderr, "  -d  cube splitting depth (default: %d)\n", CUBE_DEPTH);
+    fprintf(stderr, "  -o  log of finished cubes, resumed from if it exists\n");
+    fprintf(stderr, "  -p  write a proof of the -b or -s result, checked by check_proof\n");
+    exit(EXIT_FAILURE);
+}
+
+static FILE* open_proof(void) {
     FILE* f;
-    color** adj;
-    color* adj_flat;
-    int c, i;
 
-    adj = malloc(sizeof(color*) * ADJ_MATRIX_ORDER);
-    adj_flat = malloc(sizeof(color) * ADJ_MATRIX_ORDER * ADJ_MATRIX_ORDER);
-    if(adj == NULL || adj_flat == NULL) {
-        perror("Could not alloc");
-        exit(EXIT_FAILURE);
+    if(proof_path == NULL) {
+        return NULL;
     }
 
-    f = fopen(ADJ_MATRIX_FILE, "r");
+    f = fopen(proof_path, "w");
     if(f == NULL) {
-        perror("Could not open adjacency matrix");
+        perror("Could not open proof");
         exit(EXIT_FAILURE);
     }
 
-    /* Populate matrix with rows */
-    for(i = 0; i < ADJ_MATRIX_ORDER; i++) {
-        adj[i] = adj_flat + (i * ADJ_MATRIX_ORDER);
-    }
+    return f;
+}
 
-    /* Populate adjacency matrix from file */
-    c = 0;
-    i = 0;
-    while(c != EOF) {
-        c = fgetc(f);
-        if(i < ADJ_MATRIX_ORDER * ADJ_MATRIX_ORDER) {
-            if(c == '0') {
-                adj_flat[i++] = 0;
-            } else if(c == '1') {
-                adj_flat[i++] = 1;
-            }
-        } else if(c == '0' || c == '1') {
-            i++;
-            break;
-        }
-    }
+/* Seconds since start */
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
 
-    /* If we exit the loop and haven't read the correct number of values
-       "something bad" has happened */
-    if(c != EOF || i != (ADJ_MATRIX_ORDER * ADJ_MATRIX_ORDER)) {
-        fprintf(stderr, "Error: invalid matrix size\n");
+/* Convert the potential five cliques into packed clique masks for the row
+   search engines */
+static Ext_clique* build_ext_cliques(uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = malloc(sizeof(Ext_clique) * (count + 1));
+
+    if(cliques == NULL) {
+        perror("Could not alloc");
         exit(EXIT_FAILURE);
     }
 
-    fclose(f);
+    for(int i = 0; i < count; i++) {
+        cliques[i].mask = 0;
+        for(int j = 0; j < CLIQUE_N - 1; j++) {
+            cliques[i].mask |= ((uint64_t)1) << five_cliques[i][j];
+        }
+        cliques[i].cc = (color) five_cliques[i][CLIQUE_N];
+    }
 
-    return adj;
+    return cliques;
 }
 
-static void dump_graph(color** matrix, int order) {
-    for(int i = 0; i < order; i++) {
-        for(int j = 0; j < order; j++) {
-            printf("%d", matrix[i][j]);
+static void build_graph(color** matrix, int order, Graph* g) {
+    graph_init(g, order);
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            graph_set(g, u, v, matrix[u][v]);
         }
-        printf("\n");
     }
 }
 
-static void print_bin(uint32_t n, uint8_t width) {
-    for(int i = width - 1; i >= 0; i--) {
-        printf("%d", (n >> i) & 1);
+/* Dump the order by order matrix extended by the given row for the new
+   node */
+static void dump_extension(color** matrix, int order, uint64_t row) {
+    for(int i = 0; i <= order; i++) {
+        for(int j = 0; j <= order; j++) {
+            if(i == order && j == order) {
+                printf("0");
+            } else if(i == order || j == order) {
+                printf("%d", (int)((row >> (i == order ? j : i)) & 1));
+            } else {
+                printf("%d", matrix[i][j]);
+            }
+        }
+        printf("\n");
     }
-    printf("\n");
 }
 
-/* Expand the given n by n matrix to be a n + 1 by n + 1 matrix with the
-   original matrix embedded at 0, 0. New values are all initilized to 0 */
-static color** expand(color** matrix, int n) {
-    color** new_matrix = malloc((n + 1) * sizeof(color*));
-    new_matrix[0] = malloc((n + 1) * (n + 1) * sizeof(color));
-
-    for(int i = 0; i < n + 1; i++) {
-        /* Reconstruct the pointer array */
-        new_matrix[i] = new_matrix[0] + (i * (n + 1));
+static void run_local_search(color** matrix, int order, uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = build_ext_cliques(five_cliques, count);
+    struct timespec start;
+    Ls_result result;
 
-        /* Zero the last new column value */
-        new_matrix[i][n] = 0;
-    }
-    
-    for(int i = n - 1; i >= 0; i--) {
-        /* Move each row into its new place */
-        memcpy(new_matrix[i], matrix[i], n * sizeof(color));
-    }
+    printf("Local search with %d threads...", search_threads); fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ls_search(cliques, count, order, search_threads, search_seed, &result);
+    printf("done.\n");
 
-    /* Set the bottom row to all 0's */
-    memset(new_matrix[n], 0, n * sizeof(color));
+    printf("%llu flips over %llu tries in %.2fs\n",
+           (unsigned long long) result.flips,
+           (unsigned long long) result.tries,
+           elapsed(&start));
 
-    /* Free old matrix */
-    free(matrix[0]);
-    free(matrix);
+    if(result.violations == 0) {
+        printf("Found clique-less extension: \n\n");
+        dump_extension(matrix, order, result.row);
+    } else {
+        printf("Best row found: ");
+        ext_print_row(result.row, order);
+        printf(" (%d) \n", result.violations);
+    }
 
-    return new_matrix;
+    free(cliques);
 }
 
-/* Construct the next permutation of the edges of the new node. This only
-   permutes the row values of the new node (i.e. the column value shouldn't be
-   used). This is an optimization
+static void run_branch_and_bound(color** matrix, int order, uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = build_ext_cliques(five_cliques, count);
+    struct timespec start;
+    Ls_result ls;
+    Bnb_result result;
+    FILE* proof;
+
+    /* Seed the upper bound with a quick local search */
+    printf("Local search for an upper bound..."); fflush(stdout);
+    ls_search(cliques, count, order, search_threads, search_seed, &ls);
+    printf("done (%d).\n", ls.violations);
+
+    printf("Branch and bound..."); fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    proof = open_proof();
+    bnb_search(cliques, count, order, ls.row, proof, &result);
+    printf("done.\n");
+    if(proof != NULL) {
+        fclose(proof);
+        printf("Certificate written to %s\n", proof_path);
+    }
 
-   O(n), n = order of the matrix
- */
-static inline bool next_graph(color** matrix, int order) {
-    static color* row = NULL;
-    uint32_t p, i;
+    printf("%llu nodes (%llu pruned) in %.2fs, largest pruning bound %d\n",
+           (unsigned long long) result.nodes,
+           (unsigned long long) result.pruned,
+           elapsed(&start), result.max_bound);
 
-    if(row == NULL) {
-        row = matrix[order - 1];
+    /* The witness row is checked independently of the search */
+    if(ext_count_violations(cliques, count, result.row) != result.violations) {
+        fprintf(stderr, "Error: optimal row does not match its violation count\n");
+        exit(EXIT_FAILURE);
     }
 
-    if(perm_filtered == perm_filtered_end) {
-        int i = PERM_BLOCK_SIZE;
+    if(result.violations == 0) {
+        printf("Found clique-less extension: \n\n");
+        dump_extension(matrix, order, result.row);
+    } else {
+        printf("Optimal row: ");
+        ext_print_row(result.row, order);
+        printf(" (%d) \n", result.violations);
+        printf("Search exhausted: every row closes at least %d 5-cliques\n", result.violations);
+    }
 
-        while(row[i] && i != order - 1) {
-            row[i] = 0;
-            i++;
-        }
+    free(cliques);
+}
 
-        if(i == order - 1) {
-            return false;
-        }
+static void run_cube_and_conquer(color** matrix, int order, uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = build_ext_cliques(five_cliques, count);
+    struct timespec start;
+    Cube_result result;
+    FILE* proof;
 
-        row[i] = 1;
-        perm_filtered = perm_filtered_start;
+    printf("Cube and conquer with %d threads...", search_threads); fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    proof = open_proof();
+    cube_search(cliques, count, order, cube_depth, search_threads, cube_log_path, proof, &result);
+    printf("done.\n");
+    if(proof != NULL) {
+        fclose(proof);
+        if(result.status == SAT_UNSAT) {
+            printf("Proof written to %s\n", proof_path);
+        }
     }
 
-    p = *perm_filtered;
-    perm_filtered++;
+    printf("%d cubes (%d refuted by lookahead, %d resumed), %llu conflicts in %.2fs\n",
+           result.cubes, result.refuted, result.resumed,
+           (unsigned long long) result.conflicts, elapsed(&start));
 
-    for(i = 0; i < PERM_BLOCK_SIZE; i++) {
-        row[i] = (p >> i) & 1;
+    if(result.status == SAT_SAT) {
+        if(ext_count_violations(cliques, count, result.row) != 0) {
+            fprintf(stderr, "Error: solver returned a row closing a clique\n");
+            exit(EXIT_FAILURE);
+        }
+
+        printf("Found clique-less extension: \n\n");
+        dump_extension(matrix, order, result.row);
+    } else {
+        printf("Exhausted possibilities! No such extension of the current graph\n");
     }
 
-    return true;
+    free(cliques);
 }
 
-/* Check if a clique is monotone. Assumes the clique is presented in least to
-   greatest order, and that the first four nodes in the clique form a
-   monochromatic clique. Additionally, the color of the clique should be stored
-   after the clique values in clique[CLIQUE_N]
+/* Solve an instance with a fresh solver */
+static int solve_cold(const Ext_clique* cliques, int count, int order) {
+    Sat* sat = sat_new(order);
+    int lits[EXT_MAX_ORDER];
+    int status;
 
-   Worse case O(n^2), n = CLIQUE_N 
-*/
-static inline bool is_monochromatic(uint16_t* clique, color** matrix) {
-    static color* row = NULL;
-    color cc = (color) clique[CLIQUE_N];
-
-    if(row == NULL) {
-        row = matrix[clique[CLIQUE_N - 1]];
+    for(int i = 0; i < count; i++) {
+        sat_add_clause(sat, lits, ext_clause(&cliques[i], lits));
     }
+    status = sat_solve(sat, NULL, 0, 0);
+    sat_free(sat);
 
-    /* Only check the colors of the new edges */
-    for(int i = 0; i < CLIQUE_N - 1; i++) {
-        if(row[clique[i]] ^ cc) {
-            return false;
-        }
+    return status;
+}
+
+/* Solve the extension instance of the graph and of each of its vertex-deleted
+   variants, then of the graph with each single edge recolored as after one
+   local search move. Every instance is solved once in a single incremental
+   session and once with a fresh solver. A variant keeps the vertex numbering
+   of the full graph; the deleted vertex is left out of every clique and its
+   bit of the row is unconstrained */
+static void run_vertex_deleted_sequence(color** matrix, int order, uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = build_ext_cliques(five_cliques, count);
+    Ext_clique* variant = malloc(sizeof(Ext_clique) * (count + 1));
+    Session* session = session_new(order);
+    struct timespec start;
+    double incremental = 0, cold = 0;
+    int extendable = 0;
+    Graph g;
+
+    if(variant == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
     }
 
-    return true;
-}
+    /* Vertex order stands for the full graph */
+    for(int v = order; v >= 0; v--) {
+        uint64_t deleted = v == order ? 0 : ((uint64_t)1) << v;
+        uint64_t row = 0;
+        int n = 0;
+        int added, retracted, status, cold_status;
 
-/* Increment the given clique. If size = CLIQUE_N then next_clique should be
-   used because it is much faster */
-static bool next_n_clique(uint16_t* clique, uint16_t size) {
-    int i, j;
-
-    /* Think about AJD_MATRIX_ORDER bins with CLIQUE_N markers. We move the
-       right most marker by one to the right which can be moved without change
-       the relative order of the markers or causing a marker to leave the last
-       bin. When a marker is moved, all the markers to its right are moved into
-       the bins to its immediate right */
-
-    for(i = size - 1; i >= 0; i--) {
-        /* We found a marker we can move */
-        if(clique[i] < clique[i + 1] - 1) {
-            /* Move the marker */
-            clique[i]++;
-            
-            /* Move all markers further right to be after the one we just
-               moved */
-            for(j = i + 1; j < size; j++) {
-                clique[j] = clique[j - 1] + 1;
+        for(int i = 0; i < count; i++) {
+            if(!(cliques[i].mask & deleted)) {
+                variant[n++] = cliques[i];
             }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        session_update(session, variant, n, &added, &retracted);
+        status = session_solve(session, &row);
+        incremental += elapsed(&start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        cold_status = solve_cold(variant, n, order);
+        cold += elapsed(&start);
 
-            /* The clique has changed, return true */
-            return true;
+        if(status != cold_status ||
+           (status == SAT_SAT && ext_count_violations(variant, n, row) != 0)) {
+            fprintf(stderr, "Error: incremental and cold solves disagree\n");
+            exit(EXIT_FAILURE);
         }
-    }
 
-    /* Nothing could be moved (last combination) */
-    return false;
-}
+        if(v == order) {
+            printf("Full graph (%d cliques): ", n);
+        } else {
+            printf("Without vertex %2d (+%d -%d cliques): ", v, added, retracted);
+        }
 
-/* Is the given n-clique monochromatic in matrix */
-static bool is_n_monochromatic(uint16_t* clique, int n, color** matrix) {
-    color cc = matrix[clique[0]][clique[1]];
-    color* row;
-    int i, j;
-
-    for(i = 0; i < n; i++) {
-        row = matrix[clique[i]];
-        for(j = i + 1; j < n; j++) {
-            if(row[clique[j]] ^ cc) {
-                return false;
-            }
+        if(status == SAT_SAT) {
+            extendable++;
+            ext_print_row(row & ~deleted, order);
+            printf("\n");
+        } else {
+            printf("no extension\n");
         }
     }
 
-    return true;
-}
+    printf("%d of %d instances extendable, %d clauses in the session\n",
+           extendable, order + 1, session_clauses(session));
+    printf("Incremental: %.3fs, cold: %.3fs\n", incremental, cold);
+
+    /* The same session carries on through the recolored neighbors */
+    incremental = cold = 0;
+    extendable = 0;
+    build_graph(matrix, order, &g);
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            Ext_clique* near;
+            uint64_t row = 0;
+            int n, added, retracted, status, cold_status;
+
+            graph_set(&g, u, v, !graph_color(&g, u, v));
+            near = ext_from_graph(&g, CLIQUE_N, CLIQUE_N, &n);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            session_update(session, near, n, &added, &retracted);
+            status = session_solve(session, &row);
+            incremental += elapsed(&start);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            cold_status = solve_cold(near, n, order);
+            cold += elapsed(&start);
+
+            if(status != cold_status ||
+               (status == SAT_SAT && ext_count_violations(near, n, row) != 0)) {
+                fprintf(stderr, "Error: incremental and cold solves disagree\n");
+                exit(EXIT_FAILURE);
+            }
+            extendable += status == SAT_SAT;
 
-/* Find the monochrome n-cliques in matix. Return the list of n-cliques and
-   store the number of cliques found in cliques_found */
-static uint16_t** find_monochromatic_n_cliques(color** matrix, int order, int n, int* cliques_found) {
-    uint16_t* current_clique = malloc(sizeof(uint16_t) * (n + 1));
-    uint16_t** cliques = NULL;
-    uint16_t count = 0;
-    int i;
-    
-    current_clique[n] = order;
-    for(i = 0; i < n; i++) {
-        current_clique[i] = i;
-    }
-
-    do {
-        if(is_n_monochromatic(current_clique, n, matrix)) {
-            count++;
-            cliques = realloc(cliques, sizeof(uint16_t*) * count);
-            cliques[count - 1] = malloc(sizeof(uint16_t) * n);
-            memcpy(cliques[count - 1], current_clique, sizeof(uint16_t) * n);
+            graph_set(&g, u, v, !graph_color(&g, u, v));
+            free(near);
         }
-    } while(next_n_clique(current_clique, n));
-    
-    *cliques_found = count;
-    free(current_clique);
+    }
 
-    return cliques;
+    printf("%d of %d recolored neighbors extendable, %d clauses in the session\n",
+           extendable, order * (order - 1) / 2, session_clauses(session));
+    printf("Incremental: %.3fs, cold: %.3fs\n", incremental, cold);
+
+    session_free(session);
+    free(variant);
+    free(cliques);
 }
 
-static void perm_alloc(void) {
-    perm_block = malloc(sizeof(Perm) * (1 << PERM_BLOCK_SIZE));
+/* Drop bit v of a mask, moving the bits above it down by one */
+static inline uint64_t squeeze(uint64_t mask, int v) {
+    uint64_t low = (((uint64_t)1) << v) - 1;
 
-    for(uint32_t i = 0; i < 1 << PERM_BLOCK_SIZE; i++) {
-        perm_block[i].perm = i;
-    }
+    return (mask & low) | ((mask >> 1) & ~low);
 }
 
-static void perm_free(void) {
-    free(perm_block);
-    if(perm_filtered_start != NULL) {
-        free(perm_filtered_start);
-    }
+/* Open up bit v of a mask, as 0 */
+static inline uint64_t unsqueeze(uint64_t mask, int v) {
+    uint64_t low = (((uint64_t)1) << v) - 1;
+
+    return (mask & low) | ((mask & ~low) << 1);
 }
 
-static void perm_init(void) {
-    for(uint32_t i = 0; i < (1 << PERM_BLOCK_SIZE) - 1; i++) {
-        perm_block[i].next = &(perm_block[i + 1]);
+static void collect_replacement(uint64_t row, void* arg) {
+    Replace_job* job = arg;
+    const Replace_shared* s = job->shared;
+    Graph g = *s->g;
+    Graph canon;
+    int v = job->v;
+
+    if(job->count == job->size) {
+        job->size = job->size ? 2 * job->size : 16;
+        job->rows = realloc(job->rows, sizeof(uint64_t) * job->size);
+        job->isomorphic = realloc(job->isomorphic, sizeof(bool) * job->size);
+        if(job->rows == NULL || job->isomorphic == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
     }
 
-    for(uint32_t i = 1; i < 1 << PERM_BLOCK_SIZE; i++) {
-        perm_block[i].prev = &(perm_block[i - 1]);
+    row = unsqueeze(row, v);
+    for(int u = 0; u < s->order; u++) {
+        if(u != v) {
+            graph_set(&g, u, v, (row >> u) & 1);
+        }
     }
+    graph_canonical(&g, &canon, NULL);
 
-    perm_head = perm_block;
-    perm_count = 1 << PERM_BLOCK_SIZE;
-    perm_block[(1 << PERM_BLOCK_SIZE) - 1].next = NULL;
-    perm_block[0].prev = NULL;
+    job->rows[job->count] = row;
+    job->isomorphic[job->count] = memcmp(canon.nbr[1], s->canon->nbr[1],
+                                         sizeof(uint64_t) * s->order) == 0;
+    job->count++;
 }
 
-static inline void perm_remove(Perm* p) {
-    if(p->prev) {
-        p->prev->next = p->next;
-    } else {
-        perm_head = p->next;
-    }
+/* Replace the vertices in turn. A vertex's instance is the full instance
+   without the cliques through it, with its bit squeezed out of the rest */
+static void* replacement_worker(void* arg) {
+    Replace_shared* s = arg;
+    Ext_clique* variant = malloc(sizeof(Ext_clique) * (s->count + 1));
 
-    if(p->next) {
-        p->next->prev = p->prev;
+    if(variant == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
     }
 
-    p->next = p->prev = NULL;
-    perm_count--;
-}
+    for(;;) {
+        Replace_job job = { s, 0, NULL, NULL, 0, 0 };
+        int i, n = 0;
 
-static inline Perm* perm_next_with_mask(Perm* p, uint32_t mask, color cc) {
-    uint32_t x_mask = mask;
+        pthread_mutex_lock(&s->lock);
+        i = s->next++;
+        pthread_mutex_unlock(&s->lock);
 
-    if(cc) {
-        x_mask = 0;
-    }
+        if(i >= s->vertex_count) {
+            break;
+        }
+
+        job.v = s->vertices[i];
+        for(int k = 0; k < s->count; k++) {
+            if(!(s->cliques[k].mask & (((uint64_t)1) << job.v))) {
+                variant[n].mask = squeeze(s->cliques[k].mask, job.v);
+                variant[n].cc = s->cliques[k].cc;
+                n++;
+            }
+        }
+
+        ext_enumerate(variant, n, s->order - 1, collect_replacement, &job);
 
-    p = p->next;
-    while(p && ((p->perm ^ x_mask) & mask) != mask) {
-        p = p->next;
+        s->rows[i] = job.rows;
+        s->isomorphic[i] = job.isomorphic;
+        s->row_counts[i] = job.count;
     }
 
-    return p;
+    free(variant);
+    return NULL;
 }
 
-static inline bool perm_mask(uint16_t* clique) {
-    color cc = (color) clique[CLIQUE_N];
-    uint32_t mask = 0;
-    uint32_t x_mask = 0;
-    Perm* p;
-    Perm* pp;
+static void run_vertex_replacement(color** matrix, int order, uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = build_ext_cliques(five_cliques, count);
+    pthread_t* threads = malloc(sizeof(pthread_t) * search_threads);
+    int vertices[EXT_MAX_ORDER];
+    int orbits[EXT_MAX_ORDER];
+    struct timespec start;
+    Replace_shared s;
+    uint64_t automorphisms;
+    Graph g, canon;
+    int changed = 0;
+
+    if(threads == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
 
-    for(int i = 0; i < CLIQUE_N - 1; i++) {
-        if(clique[i] > PERM_BLOCK_SIZE) {
-            return false;
-        }
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
-        mask |= (((uint32_t)1) << clique[i]);
-    }
-    
-    if(!cc) {
-        x_mask = mask;
-    }
-    
-    p = perm_head;
+    build_graph(matrix, order, &g);
 
-    if(p == NULL) {
-        return false;
-    }
+    /* Vertices in the same orbit have the same replacements up to
+       isomorphism, so only the least of each orbit is replaced */
+    automorphisms = graph_canonical(&g, &canon, orbits);
 
-    if(((p->perm ^ x_mask) & mask) != mask) {
-        p = perm_next_with_mask(p, mask, cc);
+    s.cliques = cliques;
+    s.count = count;
+    s.order = order;
+    s.g = &g;
+    s.canon = &canon;
+    s.vertices = vertices;
+    s.vertex_count = 0;
+    for(int v = 0; v < order; v++) {
+        if(orbits[v] == v) {
+            vertices[s.vertex_count++] = v;
+        }
     }
+    s.rows = malloc(sizeof(uint64_t*) * s.vertex_count);
+    s.isomorphic = malloc(sizeof(bool*) * s.vertex_count);
+    s.row_counts = malloc(sizeof(int) * s.vertex_count);
+    if(s.rows == NULL || s.isomorphic == NULL || s.row_counts == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    s.next = 0;
+    pthread_mutex_init(&s.lock, NULL);
 
-    while(p) {
-        if(p->next || p->prev || p == perm_head) {
-            pp = p->next;
-            perm_remove(p);
-            p = pp;
-        }
+    printf("%llu automorphisms, replacing %d of %d vertices\n",
+           (unsigned long long) automorphisms, s.vertex_count, order);
 
-        if(p && ((p->perm ^ x_mask) & mask) != mask) {
-            p = perm_next_with_mask(p, mask, cc);
+    for(int i = 0; i < search_threads; i++) {
+        if(pthread_create(&threads[i], NULL, replacement_worker, &s) != 0) {
+            perror("Could not create thread");
+            exit(EXIT_FAILURE);
         }
     }
+    for(int i = 0; i < search_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
 
-    return true;
-}
+    for(int i = 0; i < s.vertex_count; i++) {
+        int v = vertices[i];
+        uint64_t original = 0;
+        int others = 0;
 
-static void perm_regroup(void) {
-    Perm* p = perm_head;
-    uint32_t j = 0;
-    
-    while(p) {
-        memcpy(perm_block + j, p, sizeof(Perm));
-        
-        if(perm_block[j].next) {
-            perm_block[j].next->prev = &perm_block[j];
+        for(int u = 0; u < order; u++) {
+            if(u != v && matrix[v][u]) {
+                original |= ((uint64_t)1) << u;
+            }
         }
-        if(perm_block[j].prev) {
-            perm_block[j].prev->next = &perm_block[j];
-        } else {
-            perm_head = &perm_block[j];
+
+        for(int k = 0; k < s.row_counts[i]; k++) {
+            others += s.rows[i][k] != original;
         }
-        
-        p = perm_block[j].next;
-        j++;
-    }
-}
+        changed += others > 0;
+
+        printf("Vertex %2d: %d replacement rows, %d differing from the original\n",
+               v, s.row_counts[i], others);
+
+        /* Rows are printed with the replaced vertex's own position blank */
+        for(int k = 0; k < s.row_counts[i]; k++) {
+            uint64_t row = s.rows[i][k];
+
+            if(row == original) {
+                continue;
+            }
 
-static void perm_build_static_list(void) {
-    Perm* p = perm_head;
-    uint32_t i = 0;
+            printf("  ");
+            for(int u = order - 1; u >= 0; u--) {
+                printf("%c", u == v ? '-' : '0' + (int)((row >> u) & 1));
+            }
+            printf(" (%d edges changed%s)\n", __builtin_popcountll(row ^ original),
+                   s.isomorphic[i][k] ? ", isomorphic to the original" : "");
+        }
 
-    perm_filtered = malloc(perm_count * sizeof(uint32_t));
-    while(p) {
-        perm_filtered[i] = p->perm;
-        p = p->next;
-        i++;
+        free(s.rows[i]);
+        free(s.isomorphic[i]);
     }
 
-    perm_filtered_start = perm_filtered;
-    perm_filtered_end = perm_filtered + perm_count;
+    printf("%d of %d vertices have other replacements, %.2fs\n",
+           changed, s.vertex_count, elapsed(&start));
+
+    pthread_mutex_destroy(&s.lock);
+    free(s.rows);
+    free(s.isomorphic);
+    free(s.row_counts);
+    free(threads);
+    free(cliques);
 }
 
-int main(void) {
-    /* The adjacency matrix being inspected for mono-chromatic cliques */
-    color** matrix;
+static void run_recoloring(color** matrix, int order, uint16_t** five_cliques, int count) {
+    Ext_clique* cliques = build_ext_cliques(five_cliques, count);
+    struct timespec start;
+    Recolor_result result;
+    Graph g;
 
-    /* Order of the matix (i.e. the order of the complete graph) */
-    int order = ADJ_MATRIX_ORDER;
+    build_graph(matrix, order, &g);
 
-    /* Edge check */
-    bool monochromatic = true;
+    printf("Recoloring search with up to %d flips...", recolor_flips); fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    recolor_search(&g, cliques, count, recolor_flips, &result);
+    printf("done.\n");
 
-    /* Iterator */
-    int i, j;
+    printf("%llu rounds, %llu clique clauses added, %llu conflicts in %.2fs\n",
+           (unsigned long long) result.rounds,
+           (unsigned long long) result.clauses,
+           (unsigned long long) result.conflicts,
+           elapsed(&start));
 
-    /* 4-cliques */
-    uint16_t** four_cliques;
-    int four_clique_count = 0;
+    if(result.status == SAT_SAT) {
+        /* The recolored and extended graph is checked independently of the
+           search */
+        for(int i = 0; i < result.flips; i++) {
+            int u = result.flipped[i][0];
+            int v = result.flipped[i][1];
 
-    /* Possible 5-cliques */
-    uint16_t** five_cliques;
+            matrix[u][v] = matrix[v][u] = !matrix[u][v];
+        }
+        build_graph(matrix, order, &g);
+        g.order = order + 1;
+        for(int u = 0; u < order; u++) {
+            graph_set(&g, u, order, (result.row >> u) & 1);
+        }
+        if(graph_cliques(&g, CLIQUE_N, NULL, NULL) != 0) {
+            fprintf(stderr, "Error: recolored extension has a monochromatic clique\n");
+            exit(EXIT_FAILURE);
+        }
 
-#if TRACK_MAX_SUCCESS
-    /* A permutation which fails, will fail after a set number of cliques being
-       checked. This keeps track of the largest number of cliques which had to
-       be checked to invalidate a permutation */
-    int max = 0;
-#endif
+        printf("Found clique-less extension after %d recolored edges:", result.flips);
+        for(int i = 0; i < result.flips; i++) {
+            printf(" %d-%d", result.flipped[i][0], result.flipped[i][1]);
+        }
+        printf("\n\n");
+        dump_extension(matrix, order, result.row);
+    } else {
+        printf("Exhausted possibilities! No extension with up to %d recolored edges\n", recolor_flips);
+    }
 
-    matrix = load_matrix();
-    printf("Successfully loaded matrix\n");
+    free(cliques);
+}
 
-    /* Find all four cliques in the existing graph */
-    four_cliques = find_monochromatic_n_cliques(matrix, order, CLIQUE_N - 1, &four_clique_count);
-    printf("Found %d 4-cliques\n", four_clique_count);
-
-    /* Construct a list of potential five cliques using the four cliques and the
-       new node */
-    five_cliques = malloc(sizeof(uint16_t*) * four_clique_count);
-    five_cliques[0] = malloc(sizeof(uint16_t) * 8 * four_clique_count);
-    for(i = 0; i < four_clique_count; i++) {
-        five_cliques[i] = five_cliques[0] + (i * 8);
-        memcpy(five_cliques[i], four_cliques[i], sizeof(uint16_t) * 4);
-        five_cliques[i][4] = order;
-        
-        /* Store the color of the clique as well */
-        five_cliques[i][5] = matrix[five_cliques[i][0]][five_cliques[i][1]];
-        five_cliques[i][6] = 0;
-        
-        free(four_cliques[i]);
-    }
-    free(four_cliques);
-
-    /* Expand the matrix */
-    matrix = expand(matrix, order);
-    order++;
+static void run_permutation_search(Ramsey_ctx* ctx) {
+    uint64_t total;
+    uint32_t space;
+    bool found;
 
     /* Allocate memory to the permutation generator */
     printf("Allocating perumatation filter..."); fflush(stdout);
-    perm_alloc();
-    perm_init();
+    ramsey_filter_init(ctx);
+    space = ctx->perm_count;
     printf("done.\n");
 
     /* Filter out as many permuatations as possible given the set of cliques */
     printf("Filtering..."); fflush(stdout);
-    for(i = 0; i < PERM_FILTER_PASSES; i++) {
-        for(j = i; j < four_clique_count; j += PERM_FILTER_PASSES) {
-            perm_mask(five_cliques[j]);
-        }
-
+    for(int i = 0; i < RAMSEY_FILTER_PASSES; i++) {
+        ramsey_filter_pass(ctx, i, RAMSEY_FILTER_PASSES);
         printf("."); fflush(stdout);
-        perm_regroup();
     }
 
     /* Report on filtering success */
     printf("done!\nRemoved %.2f%% of permutations (%u/%u)\n",
-           (100 * ((float)PERM_SPACE_SIZE - perm_count) / PERM_SPACE_SIZE),
-           (PERM_SPACE_SIZE - perm_count),
-           (PERM_SPACE_SIZE));
-    printf("Permutation space: %u\n",
-           ((1 << (order - PERM_BLOCK_SIZE)) * perm_count));
-    printf("Load factor: %.4f\n",
-           (((float)((1 << ((order - PERM_BLOCK_SIZE) - 16)) * perm_count)) / (1 << 20)));
-    perm_reset_head = perm_head;
-
-    /* Build the static list of permutations */
-    perm_build_static_list();
-
-    int cc;
-    int min = four_clique_count;
-
-    while(true) {
-        /* Attempt to move to the next graph */
-        if(next_graph(matrix, order) == false) {
-            printf("Exhausted possibilities! No such extension of the current graph\n");
-            break;
-        }
-
-#if SHOW_PERMUTATIONS
-        if(perm_filtered == perm_filtered_end) {
-            for(i = order - 1; i > 0; i--) {
-                printf("%d", matrix[order - 1][i - 1]);
-            }
-            printf("\n");
-        }
-#endif
+           (100 * ((float)space - ctx->perm_count) / space),
+           (space - ctx->perm_count),
+           (space));
+    /* Each filtered permutation is searched against every value of the
+       order - perm_width high entries */
+    total = (((uint64_t)1) << (ctx->order - ctx->perm_width)) * ctx->perm_count;
+    printf("Permutation space: %" PRIu64 "\n", total);
+    printf("Load factor: %.4f\n", ((double) total) / (((uint64_t)1) << 36));
+
+    /* With three threads or more the search runs as a pipeline of a
+       generator, screeners and checkers */
+    if(search_threads >= 3) {
+        int screeners = (search_threads - 1) / 2;
+        int checkers = search_threads - 1 - screeners;
+
+        printf("Pipeline with %d screeners and %d checkers\n", screeners, checkers);
+        found = ramsey_extend_pipeline(ctx, screeners, checkers, pin_threads);
+    } else {
+        found = ramsey_extend(ctx);
+    }
 
+    if(found) {
+        uint64_t row = 0;
 
-#if 0
-        /* Check all cliques under this permutation */
-        i = 0;
-        cc = 0;
-        while(i < four_clique_count) {
-            if(is_monochromatic(five_cliques[i], matrix)) {
-                cc++;
-            }
-            i++;
+        for(int i = 0; i < ctx->order; i++) {
+            row |= ((uint64_t) ctx->row[i]) << i;
         }
 
-        if(cc < min) {
-            min = cc;
-            for(int j = order - 1; j > 0; j--) {
-                printf("%d", matrix[order - 1][j - 1]);
-            }
-            printf(" (%d) \n", cc);
-        }
-#else
-        i = 0;
-        while(i < four_clique_count && !(monochromatic = is_monochromatic(five_cliques[i], matrix))) {
-            i++;
-        }
-#endif
+        printf("Found clique-less extension: \n\n");
+        dump_extension(ctx->matrix, ctx->order, row);
+    } else {
+        printf("Exhausted possibilities! No such extension of the current graph\n");
+    }
+}
 
-#if TRACK_MAX_SUCCESS
-        if(i > max) {
-            max = i;
-            for(int j = order - 1; j > 0; j--) {
-                printf("%d", matrix[order - 1][j - 1]);
-            }
-            printf(" (%d) \n", i);
-        }
-#endif
+int main(int argc, char** argv) {
+    /* The adjacency matrix being inspected for mono-chromatic cliques, and
+       the potential 5-cliques of its extension */
+    Ramsey_ctx ctx;
 
-        /* Successfully found a graph with 0 monochromatic cliques */
-        if(monochromatic == false) {
-            printf("Found clique-less extension: \n\n");
+    /* Search engine selection */
+    bool local_search = false;
+    bool branch_and_bound = false;
+    bool cube_and_conquer = false;
+    bool vertex_deleted = false;
+    bool vertex_replacement = false;
 
-            /* Populate the last column before dumping */
-            for(i = 0; i < order - 1; i++) {
-                matrix[i][order - 1] = matrix[order - 1][i];
-            }
+    int opt;
+
+    search_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    search_seed = (uint64_t) time(NULL);
 
-            dump_graph(matrix, order);
+    while((opt = getopt(argc, argv, "lbsivaf:t:r:d:o:p:")) != -1) {
+        switch(opt) {
+        case 'l':
+            local_search = true;
             break;
+        case 'b':
+            branch_and_bound = true;
+            break;
+        case 's':
+            cube_and_conquer = true;
+            break;
+        case 'i':
+            vertex_deleted = true;
+            break;
+        case 'v':
+            vertex_replacement = true;
+            break;
+        case 'f':
+            recolor_flips = atoi(optarg);
+            break;
+        case 'd':
+            cube_depth = atoi(optarg);
+            break;
+        case 'o':
+            cube_log_path = optarg;
+            break;
+        case 'p':
+            proof_path = optarg;
+            break;
+        case 'a':
+            pin_threads = true;
+            break;
+        case 't':
+            search_threads = atoi(optarg);
+            break;
+        case 'r':
+            search_seed = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
         }
     }
 
-    perm_free();
-    free(matrix[0]);
-    free(matrix);
-    free(five_cliques[0]);
-    free(five_cliques);
-    
+    if(search_threads < 1) {
+        search_threads = 1;
+    }
+
+    ramsey_init(&ctx, CLIQUE_N, RAMSEY_PERM_BITS);
+    ramsey_load(&ctx, ADJ_MATRIX_FILE, ADJ_MATRIX_ORDER);
+    printf("Successfully loaded matrix\n");
+
+    /* Find all four cliques in the existing graph, and the potential five
+       cliques they make with the new node */
+    ramsey_prepare(&ctx);
+    printf("Found %d 4-cliques\n", ctx.clique_count);
+
+    if(local_search) {
+        run_local_search(ctx.matrix, ctx.order, ctx.cliques, ctx.clique_count);
+    } else if(branch_and_bound) {
+        run_branch_and_bound(ctx.matrix, ctx.order, ctx.cliques, ctx.clique_count);
+    } else if(cube_and_conquer) {
+        run_cube_and_conquer(ctx.matrix, ctx.order, ctx.cliques, ctx.clique_count);
+    } else if(vertex_deleted) {
+        run_vertex_deleted_sequence(ctx.matrix, ctx.order, ctx.cliques, ctx.clique_count);
+    } else if(vertex_replacement) {
+        run_vertex_replacement(ctx.matrix, ctx.order, ctx.cliques, ctx.clique_count);
+    } else if(recolor_flips >= 0) {
+        run_recoloring(ctx.matrix, ctx.order, ctx.cliques, ctx.clique_count);
+    } else {
+        run_permutation_search(&ctx);
+    }
+
+    ramsey_free(&ctx);
+
     return 0;
 }
@@ -0,0 +1,213 @@
+/**
+ * File: extend_wide.c
+ *
+ * Purpose: Verification and one-vertex extension of R(s, t) colorings of any
+ *  order up to WIDE_MAX_ORDER, on the multiword bitset backend. The coloring
+ *  is checked for red K_s and blue K_t, then its red K_{s-1} and blue K_{t-1}
+ *  are enumerated as the extension instance and solved with the SAT solver.
+ *  An extension found is checked again before it is written out.
+ *
+ *  With -m the instance is first written to a compressed clique store (see
+ *  cstore.h), spilling to disk past the given budget, and the solver is fed
+ *  from a sequential scan of it.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cstore.h"
+#include "extension.h"
+#include "gen.h"
+#include "sat.h"
+#include "wide.h"
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static int clique_size[2] = { 5, 5 };
+static long store_budget = -1;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-c s,t] [-m MB] [-o out] <graph|spec>\n"
+            "  -c  clique sizes s,t (default 5,5)\n"
+            "  -m  pass the instance through a compressed clique store, spilled\n"
+            "      to disk past MB megabytes\n"
+            "  -o  write the extended coloring to out instead of stdout\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void store_clique(const int* clique, int k, color cc, void* arg) {
+    (void) k;
+    (void) cc;
+    cstore_add(arg, clique);
+}
+
+/* Enumerate the instance into a store per color, then stream it into the
+   solver. Returns the number of cliques */
+static uint64_t add_stored_instance(const Wide_graph* g, Sat* sat) {
+    struct timespec start;
+    int clique[CSTORE_MAX_K];
+    uint64_t total = 0;
+
+    for(color cc = 0; cc < 2; cc++) {
+        int k = clique_size[cc] - 1;
+        Cstore* store;
+        Cstore_scan scan;
+
+        if(k > CSTORE_MAX_K) {
+            fprintf(stderr, "Error: cliques of size %d can not be stored\n", k);
+            exit(EXIT_FAILURE);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        store = cstore_new(k, (size_t) store_budget << 20, NULL);
+        wide_cliques(g, k, cc, store_clique, store);
+        cstore_finish(store);
+
+        printf("%s K%d: %llu cliques in %llu bytes (%.2f per clique), %d blocks%s (%.3fs)\n",
+               cc ? "Blue" : "Red", k, (unsigned long long) cstore_count(store),
+               (unsigned long long) cstore_bytes(store),
+               cstore_count(store) ? (double) cstore_bytes(store) / cstore_count(store) : 0.0,
+               cstore_blocks(store), cstore_spilled(store) ? ", spilled" : "", elapsed(&start));
+
+        cstore_scan_init(store, &scan);
+        while(cstore_scan_next(&scan, clique)) {
+            ext_add_clique_clause(clique, k, cc, sat);
+        }
+
+        total += cstore_count(store);
+        cstore_free(store);
+    }
+
+    return total;
+}
+
+/* Is g an R(s, t) coloring, reporting the first failure */
+static bool verify(const Wide_graph* g) {
+    for(color cc = 0; cc < 2; cc++) {
+        if(wide_has_clique(g, clique_size[cc], cc)) {
+            printf("Coloring has a %s K%d\n", cc ? "blue" : "red", clique_size[cc]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* out_path = NULL;
+    struct timespec start;
+    Wide_graph g, ext;
+    uint64_t clauses = 0;
+    Sat* sat;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:m:o:")) != -1) {
+        switch(opt) {
+        case 'c':
+            if(sscanf(optarg, "%d,%d", &clique_size[0], &clique_size[1]) != 2 ||
+               clique_size[0] < 3 || clique_size[1] < 3) {
+                usage(argv[0]);
+            }
+            break;
+        case 'm':
+            store_budget = atol(optarg);
+            if(store_budget < 0) {
+                usage(argv[0]);
+            }
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind != 1) {
+        usage(argv[0]);
+    }
+
+    gen_load(&g, argv[optind]);
+    printf("Order %d, %d word(s) per row\n", g.order, g.words);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(!verify(&g)) {
+        exit(EXIT_FAILURE);
+    }
+    printf("Valid R(%d, %d) coloring (%.3fs)\n", clique_size[0], clique_size[1], elapsed(&start));
+
+    if(g.order == WIDE_MAX_ORDER) {
+        printf("Order %d is too large to extend\n", g.order);
+        wide_free(&g);
+        return EXIT_SUCCESS;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sat = sat_new(g.order);
+    if(store_budget >= 0) {
+        clauses = add_stored_instance(&g, sat);
+    } else {
+        for(color cc = 0; cc < 2; cc++) {
+            clauses += wide_cliques(&g, clique_size[cc] - 1, cc, ext_add_clique_clause, sat);
+        }
+    }
+    printf("Extension instance: %llu cliques (%.3fs)\n", (unsigned long long) clauses, elapsed(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(sat_solve(sat, NULL, 0, 0) != SAT_SAT) {
+        printf("No extension (%llu conflicts, %.3fs)\n",
+               (unsigned long long) sat_conflicts(sat), elapsed(&start));
+        sat_free(sat);
+        wide_free(&g);
+        return EXIT_SUCCESS;
+    }
+    printf("Extends to order %d (%llu conflicts, %.3fs)\n", g.order + 1,
+           (unsigned long long) sat_conflicts(sat), elapsed(&start));
+
+    /* The extended coloring is verified independently of the solver */
+    wide_init(&ext, g.order + 1);
+    for(int u = 0; u < g.order; u++) {
+        for(int v = u + 1; v < g.order; v++) {
+            wide_set(&ext, u, v, wide_color(&g, u, v));
+        }
+        wide_set(&ext, u, g.order, sat_value(sat, u + 1));
+    }
+    if(!verify(&ext)) {
+        fprintf(stderr, "Error: solver returned a row closing a clique\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if(out_path == NULL) {
+        wide_dump(&ext, stdout);
+    } else {
+        FILE* f = fopen(out_path, "w");
+
+        if(f == NULL) {
+            perror("Could not open output file");
+            exit(EXIT_FAILURE);
+        }
+        wide_dump(&ext, f);
+        fclose(f);
+        printf("Wrote %s\n", out_path);
+    }
+
+    sat_free(sat);
+    wide_free(&ext);
+    wide_free(&g);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "extension.h"
+
+typedef struct {
+    Ext_clique* cliques;
+    int count;
+    int size;
+
+    /* Only cliques of this color are kept, or either if 2 */
+    int keep;
+
+    /* Added to every clique */
+    uint64_t extra;
+} Ext_list;
+
+static void ext_append(const int* clique, int k, color cc, void* arg) {
+    Ext_list* list = arg;
+    Ext_clique* c;
+
+    if(list->keep != 2 && cc != list->keep) {
+        return;
+    }
+    if(list->count == list->size) {
+        list->size = list->size ? 2 * list->size : 1024;
+        list->cliques = realloc(list->cliques, sizeof(Ext_clique) * list->size);
+        if(list->cliques == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    c = &list->cliques[list->count++];
+    c->mask = list->extra;
+    c->cc = cc;
+    for(int i = 0; i < k; i++) {
+        c->mask |= ((uint64_t)1) << clique[i];
+    }
+}
+
+/* The extension instance of an R(s, t) coloring: its red (s - 1)-cliques and
+   blue (t - 1)-cliques. For s == t they are in lexicographic order, the same
+   order the 5-clique search finds them; otherwise the red ones come first.
+   s and t are at least 3 */
+Ext_clique* ext_from_graph(const Graph* g, int s, int t, int* count) {
+    Ext_list list = { NULL, 0, 0, 2, 0 };
+
+    if(s == t) {
+        graph_cliques(g, s - 1, ext_append, &list);
+    } else {
+        list.keep = 0;
+        graph_cliques(g, s - 1, ext_append, &list);
+        list.keep = 1;
+        graph_cliques(g, t - 1, ext_append, &list);
+    }
+    *count = list.count;
+
+    return list.cliques;
+}
+
+/* Append to the extension instance of g without its last vertex the cliques
+   through that vertex, giving the instance of g. The array is grown as
+   needed, size holding its capacity */
+void ext_add_vertex(const Graph* g, int s, int t, Ext_clique** cliques, int* count, int* size) {
+    int v = g->order - 1;
+    Ext_list list = { *cliques, *count, *size, 0, ((uint64_t)1) << v };
+
+    graph_cliques_in(g, s - 2, 0, g->nbr[0][v], ext_append, &list);
+    list.keep = 1;
+    graph_cliques_in(g, t - 2, 1, g->nbr[1][v], ext_append, &list);
+
+    *cliques = list.cliques;
+    *count = list.count;
+    *size = list.size;
+}
+
+/* Count the cliques closed by row
+
+   O(n), n = number of cliques
+ */
+int ext_count_violations(const Ext_clique* cliques, int count, uint64_t row) {
+    int violations = 0;
+
+    for(int i = 0; i < count; i++) {
+        if(ext_violated(&cliques[i], row)) {
+            violations++;
+        }
+    }
+
+    return violations;
+}
+
+/* Print the row most significant vertex first, matching the order rows are
+   reported by the permutation search */
+void ext_print_row(uint64_t row, int order) {
+    for(int i = order - 1; i >= 0; i--) {
+        printf("%d", (int)((row >> i) & 1));
+    }
+}
+
+/* Enumeration state */
+typedef struct {
+    const Ext_clique* cliques;
+    int order;
+
+    /* Cliques whose highest vertex is v are by_last[start[v]] up to
+       by_last[start[v + 1]] */
+    int* by_last;
+    int start[EXT_MAX_ORDER + 1];
+
+    void (*visit)(uint64_t row, void* arg);
+    void* arg;
+    uint64_t found;
+} Ext_enum;
+
+static void ext_enumerate_dfs(Ext_enum* e, int v, uint64_t row) {
+    if(v == e->order) {
+        e->found++;
+        if(e->visit != NULL) {
+            e->visit(row, e->arg);
+        }
+        return;
+    }
+
+    for(int value = 0; value < 2; value++) {
+        uint64_t next = value ? row | (((uint64_t)1) << v) : row;
+        bool ok = true;
+
+        /* Cliques ending at v are fully decided */
+        for(int i = e->start[v]; i < e->start[v + 1] && ok; i++) {
+            ok = !ext_violated(&e->cliques[e->by_last[i]], next);
+        }
+
+        if(ok) {
+            ext_enumerate_dfs(e, v + 1, next);
+        }
+    }
+}
+
+/* Call visit for every row closing no clique, in increasing order of the
+   row's reversed bits. Returns the number of rows found */
+uint64_t ext_enumerate(const Ext_clique* cliques, int count, int order,
+                       void (*visit)(uint64_t row, void* arg), void* arg) {
+    Ext_enum e;
+    int fill[EXT_MAX_ORDER + 1] = {0};
+
+    e.cliques = cliques;
+    e.order = order;
+    e.visit = visit;
+    e.arg = arg;
+    e.found = 0;
+
+    e.by_last = malloc(sizeof(int) * (count + 1));
+    if(e.by_last == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(e.start, 0, sizeof(e.start));
+    for(int i = 0; i < count; i++) {
+        e.start[63 - __builtin_clzll(cliques[i].mask) + 1]++;
+    }
+    for(int v = 0; v < order; v++) {
+        e.start[v + 1] += e.start[v];
+    }
+    for(int i = 0; i < count; i++) {
+        int v = 63 - __builtin_clzll(cliques[i].mask);
+
+        e.by_last[e.start[v] + fill[v]++] = i;
+    }
+
+    ext_enumerate_dfs(&e, 0, 0);
+
+    free(e.by_last);
+    return e.found;
+}
@@ -0,0 +1,89 @@
+/**
+ * One-vertex extension instances. Every monochromatic 5-clique of the extended
+ * graph contains the new vertex and a monochromatic 4-clique of the base
+ * graph, so an instance is just the list of base 4-cliques and their colors.
+ * A candidate row for the new vertex is packed into a uint64_t with bit i
+ * holding the color of the edge to vertex i.
+ */
+
+#ifndef EXTENSION_H
+#define EXTENSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "sat.h"
+
+/* Largest base graph whose new row fits in a packed row */
+#define EXT_MAX_ORDER 64
+
+/* A monochromatic 4-clique of the base graph as seen by the new vertex */
+typedef struct {
+    uint64_t mask;
+    color cc;
+} Ext_clique;
+
+/* Does row close the clique into a monochromatic 5-clique, i.e. does every
+   edge from the new vertex into the clique have the clique's color */
+static inline bool ext_violated(const Ext_clique* clique, uint64_t row) {
+    uint64_t same = clique->cc ? row : ~row;
+
+    return (same & clique->mask) == clique->mask;
+}
+
+/* Branching weight of a clique with the vertices of rem still open, four
+   times heavier for each vertex already assigned. Capped at EXT_WEIGHT_CAP
+   assigned vertices so scores summed over many cliques stay in range */
+#define EXT_WEIGHT_CAP 8
+
+static inline uint32_t ext_weight(const Ext_clique* clique, uint64_t rem) {
+    int assigned = __builtin_popcountll(clique->mask) - __builtin_popcountll(rem);
+
+    if(assigned > EXT_WEIGHT_CAP) {
+        assigned = EXT_WEIGHT_CAP;
+    }
+
+    return (uint32_t) 1 << (2 * assigned);
+}
+
+/* The clause forbidding the clique: some edge from the new vertex into the
+   clique must differ from the clique's color. Literals are DIMACS style, with
+   variable i + 1 true when the edge to vertex i is blue. Returns the number
+   of literals */
+static inline int ext_clause(const Ext_clique* clique, int* lits) {
+    int n = 0;
+
+    for(uint64_t m = clique->mask; m; m &= m - 1) {
+        int var = __builtin_ctzll(m) + 1;
+
+        lits[n++] = clique->cc ? -var : var;
+    }
+
+    return n;
+}
+
+/* Largest clique given as a vertex list, as many as a wide graph's vertices */
+#define EXT_MAX_CLIQUE 4096
+
+/* Forbid the new vertex closing a clique given as a vertex list: some edge
+   from it into the clique must take the other color. A clique visitor with
+   the solver as arg, with variables as for ext_clause */
+static inline void ext_add_clique_clause(const int* clique, int k, color cc, void* arg) {
+    int lits[EXT_MAX_CLIQUE];
+
+    for(int i = 0; i < k; i++) {
+        lits[i] = cc ? -(clique[i] + 1) : clique[i] + 1;
+    }
+
+    sat_add_clause(arg, lits, k);
+}
+
+Ext_clique* ext_from_graph(const Graph* g, int s, int t, int* count);
+void ext_add_vertex(const Graph* g, int s, int t, Ext_clique** cliques, int* count, int* size);
+int ext_count_violations(const Ext_clique* cliques, int count, uint64_t row);
+uint64_t ext_enumerate(const Ext_clique* cliques, int count, int order,
+                       void (*visit)(uint64_t row, void* arg), void* arg);
+void ext_print_row(uint64_t row, int order);
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ * File: find_coloring.c
+ *
+ * Purpose: Search for 2-colorings of K_n with no red K_s and no blue K_t,
+ *  restricted to block-circulant colorings (see coloring.h). Each coloring
+ *  found is written out as an adjacency matrix and, with -x, checked in
+ *  process for a one-vertex extension, so new candidate base graphs for
+ *  extend_graph come straight out of the search.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "coloring.h"
+#include "extension.h"
+#include "graph.h"
+#include "sat.h"
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+static void write_coloring(const Graph* g, int index);
+static void check_extension(const Graph* g, int s, int t);
+
+static const char* output_prefix = NULL;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-b blocks] [-c count] [-x] [-o prefix] <n> <s> <t>\n"
+            "  -b  number of circulant blocks, dividing n (default 1)\n"
+            "  -c  stop after count colorings, 0 for all (default 1)\n"
+            "  -x  check each coloring for a one-vertex extension\n"
+            "  -o  write coloring k to prefix.k instead of stdout\n"
+            "  s and t are at least 3\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void write_coloring(const Graph* g, int index) {
+    char path[4096];
+    FILE* f;
+
+    if(output_prefix == NULL) {
+        graph_dump(g, stdout);
+        return;
+    }
+
+    snprintf(path, sizeof(path), "%s.%d", output_prefix, index);
+    f = fopen(path, "w");
+    if(f == NULL) {
+        perror("Could not open output file");
+        exit(EXIT_FAILURE);
+    }
+    graph_dump(g, f);
+    fclose(f);
+
+    printf("Wrote %s\n", path);
+}
+
+/* Solve the one-vertex extension of g as an R(s, t) coloring */
+static void check_extension(const Graph* g, int s, int t) {
+    Ext_clique* cliques;
+    Sat* sat;
+    int lits[GRAPH_MAX_ORDER];
+    int count;
+
+    if(g->order == GRAPH_MAX_ORDER) {
+        printf("Order %d is too large to extend\n", g->order);
+        return;
+    }
+
+    cliques = ext_from_graph(g, s, t, &count);
+    sat = sat_new(g->order);
+    for(int i = 0; i < count; i++) {
+        sat_add_clause(sat, lits, ext_clause(&cliques[i], lits));
+    }
+
+    if(sat_solve(sat, NULL, 0, 0) == SAT_SAT) {
+        uint64_t row = 0;
+
+        for(int i = 0; i < g->order; i++) {
+            if(sat_value(sat, i + 1)) {
+                row |= ((uint64_t)1) << i;
+            }
+        }
+        printf("Extends to order %d (%d cliques) with row ", g->order + 1, count);
+        ext_print_row(row, g->order);
+        printf("\n");
+    } else {
+        printf("Does not extend (%d cliques)\n", count);
+    }
+
+    sat_free(sat);
+    free(cliques);
+}
+
+int main(int argc, char** argv) {
+    struct timespec start;
+    Coloring* coloring;
+    Graph g;
+    int blocks = 1;
+    int limit = 1;
+    bool extend = false;
+    int found = 0;
+    int opt, n, s, t;
+
+    while((opt = getopt(argc, argv, "b:c:xo:")) != -1) {
+        switch(opt) {
+        case 'b':
+            blocks = atoi(optarg);
+            break;
+        case 'c':
+            limit = atoi(optarg);
+            break;
+        case 'x':
+            extend = true;
+            break;
+        case 'o':
+            output_prefix = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind != 3) {
+        usage(argv[0]);
+    }
+
+    n = atoi(argv[optind]);
+    s = atoi(argv[optind + 1]);
+    t = atoi(argv[optind + 2]);
+    if(n < 2 || n > GRAPH_MAX_ORDER || s < 3 || t < 3 || blocks < 1 || n % blocks != 0 || limit < 0) {
+        usage(argv[0]);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    coloring = coloring_new(blocks, n / blocks, s, t);
+    printf("Searching R(%d, %d) colorings of K%d with %d circulant block(s), %d orbit vars\n",
+           s, t, n, blocks, coloring_vars(coloring));
+
+    while((limit == 0 || found < limit) &&
+          coloring_next(coloring, &g, 0) == SAT_SAT) {
+        found++;
+        printf("Coloring %d after %llu rounds, %llu clique clauses, %.2fs\n", found,
+               (unsigned long long) coloring_rounds(coloring),
+               (unsigned long long) coloring_clauses(coloring), elapsed(&start));
+
+        write_coloring(&g, found);
+        if(extend) {
+            check_extension(&g, s, t);
+        }
+
+        coloring_block(coloring);
+    }
+
+    if(limit == 0 || found < limit) {
+        printf("No %scolorings with this structure (%llu rounds, %llu clique clauses, %.2fs)\n",
+               found ? "more " : "", (unsigned long long) coloring_rounds(coloring),
+               (unsigned long long) coloring_clauses(coloring), elapsed(&start));
+    }
+
+    coloring_free(coloring);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,495 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gen.h"
+
+/* Largest degree of a field extension, since p^m <= WIDE_MAX_ORDER */
+#define GEN_MAX_DEGREE 12
+
+static void spec_error(const char* spec) {
+    fprintf(stderr, "Error: invalid generator spec %s\n", spec);
+    exit(EXIT_FAILURE);
+}
+
+/* Write q = p^m, returning p, or 0 if q is not a prime power */
+static int prime_power(int q, int* m) {
+    int p = 2;
+
+    while(p * p <= q && q % p != 0) {
+        p++;
+    }
+    if(p * p > q) {
+        p = q;
+    }
+
+    *m = 0;
+    while(q % p == 0) {
+        q /= p;
+        (*m)++;
+    }
+
+    return q == 1 ? p : 0;
+}
+
+/* Elements of GF(p^m) are polynomials over Z_p of degree below m, packed as
+   their base p digits */
+static void gf_digits(int e, int p, int m, int* digits) {
+    for(int i = 0; i < m; i++) {
+        digits[i] = e % p;
+        e /= p;
+    }
+}
+
+static int gf_pack(const int* digits, int p, int m) {
+    int e = 0;
+
+    for(int i = m - 1; i >= 0; i--) {
+        e = e * p + digits[i];
+    }
+
+    return e;
+}
+
+static int gf_sub(int a, int b, int p, int m) {
+    int da[GEN_MAX_DEGREE], db[GEN_MAX_DEGREE];
+
+    gf_digits(a, p, m, da);
+    gf_digits(b, p, m, db);
+    for(int i = 0; i < m; i++) {
+        da[i] = (da[i] - db[i] + p) % p;
+    }
+
+    return gf_pack(da, p, m);
+}
+
+/* x e modulo the monic f = x^m + low, low packed like an element */
+static int gf_times_x(int e, int low, int p, int m) {
+    int de[GEN_MAX_DEGREE], dl[GEN_MAX_DEGREE];
+    int top;
+
+    gf_digits(e, p, m, de);
+    gf_digits(low, p, m, dl);
+
+    top = de[m - 1];
+    for(int i = m - 1; i > 0; i--) {
+        de[i] = (de[i - 1] - top * dl[i] % p + p) % p;
+    }
+    de[0] = (p - top * dl[0] % p) % p;
+
+    return gf_pack(de, p, m);
+}
+
+void gen_paley(Wide_graph* g, int q) {
+    bool* square;
+    int p, m, low, e;
+
+    p = q >= 5 ? prime_power(q, &m) : 0;
+    if(p == 0 || q % 4 != 1 || q > WIDE_MAX_ORDER) {
+        fprintf(stderr, "Error: Paley colorings need a prime power order = 1 mod 4\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Find a primitive f, i.e. one where x generates the nonzero elements:
+       x^i != 1 for 0 < i < q - 1 */
+    for(low = 1; low < q; low++) {
+        int i;
+
+        if(low % p == 0) {
+            continue;
+        }
+
+        e = 1;
+        for(i = 1; i < q - 1; i++) {
+            e = gf_times_x(e, low, p, m);
+            if(e == 1) {
+                break;
+            }
+        }
+        if(i == q - 1 && gf_times_x(e, low, p, m) == 1) {
+            break;
+        }
+    }
+
+    /* The squares are the even powers of x */
+    square = calloc(q, sizeof(bool));
+    if(square == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    e = 1;
+    for(int i = 0; i < q - 1; i += 2) {
+        square[e] = true;
+        e = gf_times_x(gf_times_x(e, low, p, m), low, p, m);
+    }
+
+    wide_init(g, q);
+    for(int u = 0; u < q; u++) {
+        for(int v = u + 1; v < q; v++) {
+            if(square[gf_sub(v, u, p, m)]) {
+                wide_set(g, u, v, 1);
+            }
+        }
+    }
+
+    free(square);
+}
+
+void gen_circulant(Wide_graph* g, int order, const int* diffs, int count) {
+    bool blue[WIDE_MAX_ORDER] = { false };
+
+    if(order < 1 || order > WIDE_MAX_ORDER) {
+        fprintf(stderr, "Error: order %d is not supported\n", order);
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < count; i++) {
+        int d = (diffs[i] % order + order) % order;
+
+        if(d == 0) {
+            fprintf(stderr, "Error: difference %d is 0 mod %d\n", diffs[i], order);
+            exit(EXIT_FAILURE);
+        }
+        blue[d] = true;
+        blue[order - d] = true;
+    }
+
+    wide_init(g, order);
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            if(blue[v - u]) {
+                wide_set(g, u, v, 1);
+            }
+        }
+    }
+}
+
+static void group_split(const Gen_group* group, int x, int* parts) {
+    for(int i = group->factors - 1; i >= 0; i--) {
+        int size = group->dihedral[i] ? 2 * group->n[i] : group->n[i];
+
+        parts[i] = x % size;
+        x /= size;
+    }
+}
+
+static int group_join(const Gen_group* group, const int* parts) {
+    int x = 0;
+
+    for(int i = 0; i < group->factors; i++) {
+        x = x * (group->dihedral[i] ? 2 * group->n[i] : group->n[i]) + parts[i];
+    }
+
+    return x;
+}
+
+/* In Dn, r^i s^f r^j s^h = r^(i + (-1)^f j) s^(f + h) */
+static int group_mul(const Gen_group* group, int a, int b) {
+    int pa[GEN_MAX_FACTORS], pb[GEN_MAX_FACTORS];
+
+    group_split(group, a, pa);
+    group_split(group, b, pb);
+    for(int i = 0; i < group->factors; i++) {
+        int n = group->n[i];
+
+        if(group->dihedral[i]) {
+            int fa = pa[i] / n, fb = pb[i] / n;
+            int r = fa ? pa[i] % n - pb[i] % n : pa[i] % n + pb[i] % n;
+
+            pa[i] = (r % n + n) % n + n * (fa ^ fb);
+        } else {
+            pa[i] = (pa[i] + pb[i]) % n;
+        }
+    }
+
+    return group_join(group, pa);
+}
+
+/* Reflections are their own inverses */
+static int group_inv(const Gen_group* group, int a) {
+    int pa[GEN_MAX_FACTORS];
+
+    group_split(group, a, pa);
+    for(int i = 0; i < group->factors; i++) {
+        if(!group->dihedral[i] || pa[i] < group->n[i]) {
+            pa[i] = (group->n[i] - pa[i]) % group->n[i];
+        }
+    }
+
+    return group_join(group, pa);
+}
+
+void gen_cayley(Wide_graph* g, const Gen_group* group, const int* elements, int count) {
+    bool* blue = calloc(group->order, sizeof(bool));
+
+    if(blue == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < count; i++) {
+        if(elements[i] <= 0 || elements[i] >= group->order) {
+            fprintf(stderr, "Error: the identity can not be a connection element\n");
+            exit(EXIT_FAILURE);
+        }
+        blue[elements[i]] = true;
+        blue[group_inv(group, elements[i])] = true;
+    }
+
+    wide_init(g, group->order);
+    for(int u = 0; u < group->order; u++) {
+        int inv = group_inv(group, u);
+
+        for(int v = u + 1; v < group->order; v++) {
+            if(blue[group_mul(group, inv, v)]) {
+                wide_set(g, u, v, 1);
+            }
+        }
+    }
+
+    free(blue);
+}
+
+/* Spread a seed out with a splitmix64 step, so close seeds give unrelated
+   streams */
+static uint64_t gen_seed(uint64_t seed) {
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+
+    return z ? z : 1;
+}
+
+void gen_random(Wide_graph* g, int order, uint64_t seed) {
+    uint64_t rng = gen_seed(seed);
+
+    wide_init(g, order);
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            if(wide_rand(&rng) >> 63) {
+                wide_set(g, u, v, 1);
+            }
+        }
+    }
+}
+
+/* Selection sampling: each edge is blue with probability the blue edges
+   still needed over the edges left */
+void gen_density(Wide_graph* g, int order, double density, uint64_t seed) {
+    uint64_t rng = gen_seed(seed);
+    uint64_t left = (uint64_t) order * (order - 1) / 2;
+    uint64_t need = (uint64_t)(density * left + 0.5);
+
+    if(density < 0 || density > 1) {
+        fprintf(stderr, "Error: density %g is not in [0, 1]\n", density);
+        exit(EXIT_FAILURE);
+    }
+
+    wide_init(g, order);
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            if(wide_rand_below(&rng, left) < need) {
+                wide_set(g, u, v, 1);
+                need--;
+            }
+            left--;
+        }
+    }
+}
+
+/* A non-negative integer at *s, moving *s past it */
+static int parse_int(const char** s, const char* spec) {
+    char* end;
+    long x = strtol(*s, &end, 10);
+
+    if(end == *s || x < 0 || x > WIDE_MAX_ORDER * 2) {
+        spec_error(spec);
+    }
+    *s = end;
+
+    return (int) x;
+}
+
+/* Comma separated integers, which may be negative, up to the end of s */
+static int parse_list(const char* s, int* values, int max, const char* spec) {
+    int count = 0;
+
+    do {
+        bool negative = *s == '-';
+
+        if(count == max) {
+            spec_error(spec);
+        }
+        s += negative;
+        values[count] = parse_int(&s, spec);
+        values[count] = negative ? -values[count] : values[count];
+        count++;
+    } while(*s++ == ',');
+
+    if(s[-1] != '\0') {
+        spec_error(spec);
+    }
+
+    return count;
+}
+
+/* Factors such as Z4 or D5, separated by x, up to a colon */
+static void parse_group(const char** s, Gen_group* group, const char* spec) {
+    group->factors = 0;
+    group->order = 1;
+
+    do {
+        int i = group->factors;
+
+        if(i == GEN_MAX_FACTORS || (**s != 'Z' && **s != 'D')) {
+            spec_error(spec);
+        }
+        group->dihedral[i] = *(*s)++ == 'D';
+        group->n[i] = parse_int(s, spec);
+        if(group->n[i] < 1) {
+            spec_error(spec);
+        }
+
+        group->order *= group->dihedral[i] ? 2 * group->n[i] : group->n[i];
+        if(group->order > WIDE_MAX_ORDER) {
+            fprintf(stderr, "Error: group order is above %d\n", WIDE_MAX_ORDER);
+            exit(EXIT_FAILURE);
+        }
+        group->factors++;
+    } while(*(*s)++ == 'x');
+
+    if((*s)[-1] != ':') {
+        spec_error(spec);
+    }
+}
+
+/* Comma separated elements, each with dot separated components */
+static int parse_elements(const char* s, const Gen_group* group, int* elements, const char* spec) {
+    int count = 0;
+
+    do {
+        int parts[GEN_MAX_FACTORS];
+
+        if(count == WIDE_MAX_ORDER) {
+            spec_error(spec);
+        }
+
+        for(int i = 0; i < group->factors; i++) {
+            if(i > 0 && *s++ != '.') {
+                spec_error(spec);
+            }
+            parts[i] = parse_int(&s, spec);
+            if(parts[i] >= group->n[i]) {
+                spec_error(spec);
+            }
+            if(*s == '\'') {
+                if(!group->dihedral[i]) {
+                    spec_error(spec);
+                }
+                parts[i] += group->n[i];
+                s++;
+            }
+        }
+
+        elements[count++] = group_join(group, parts);
+    } while(*s++ == ',');
+
+    if(s[-1] != '\0') {
+        spec_error(spec);
+    }
+
+    return count;
+}
+
+bool gen_spec(Wide_graph* g, const char* spec) {
+    static const char* names[] = { "paley", "circulant", "cayley", "random", "density" };
+    const char* s = strchr(spec, ':');
+    int values[WIDE_MAX_ORDER];
+    int which = -1;
+    int order;
+
+    for(int i = 0; i < 5 && s != NULL; i++) {
+        if(strlen(names[i]) == (size_t)(s - spec) && strncmp(spec, names[i], s - spec) == 0) {
+            which = i;
+        }
+    }
+    if(which < 0) {
+        return false;
+    }
+    s++;
+
+    if(which == 2) {
+        Gen_group group;
+
+        parse_group(&s, &group, spec);
+        gen_cayley(g, &group, values, parse_elements(s, &group, values, spec));
+        return true;
+    }
+
+    order = parse_int(&s, spec);
+    if(order < 1 || order > WIDE_MAX_ORDER) {
+        spec_error(spec);
+    }
+
+    switch(which) {
+    case 0:
+        if(*s != '\0') {
+            spec_error(spec);
+        }
+        gen_paley(g, order);
+        break;
+    case 1:
+        if(*s++ != ':') {
+            spec_error(spec);
+        }
+        gen_circulant(g, order, values, parse_list(s, values, WIDE_MAX_ORDER, spec));
+        break;
+    case 3:
+        if(*s == '\0') {
+            gen_random(g, order, 1);
+        } else if(*s++ == ':') {
+            gen_random(g, order, strtoull(s, NULL, 10));
+        } else {
+            spec_error(spec);
+        }
+        break;
+    default: {
+        char* end;
+        double density;
+
+        if(*s++ != ':') {
+            spec_error(spec);
+        }
+        density = strtod(s, &end);
+        if(end == s || (*end != '\0' && *end != ':')) {
+            spec_error(spec);
+        }
+        gen_density(g, order, density, *end == ':' ? strtoull(end + 1, NULL, 10) : 1);
+        break;
+    }
+    }
+
+    return true;
+}
+
+void gen_load(Wide_graph* g, const char* arg) {
+    if(!gen_spec(g, arg)) {
+        wide_load(g, arg);
+    }
+}
+
+void gen_pack(const Wide_graph* w, Graph* g) {
+    if(w->order > GRAPH_MAX_ORDER) {
+        fprintf(stderr, "Error: graph has more than %d vertices\n", GRAPH_MAX_ORDER);
+        exit(EXIT_FAILURE);
+    }
+
+    graph_init(g, w->order);
+    for(int u = 0; u < w->order; u++) {
+        for(int v = u + 1; v < w->order; v++) {
+            graph_set(g, u, v, wide_color(w, u, v));
+        }
+    }
+}
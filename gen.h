@@ -0,0 +1,63 @@
+/**
+ * Built-in generators of colorings, producing packed graphs in memory rather
+ * than adjacency matrix files. A generator is named on the command line by a
+ * spec, and any tool taking a graph through gen_load accepts either a spec
+ * or a path:
+ *
+ *   paley:q               Paley coloring of GF(q), q a prime power = 1 mod 4:
+ *                         edge xy is blue when x - y is a nonzero square
+ *   circulant:n:d,...     circulant coloring of Z_n: edge xy is blue when
+ *                         y - x or x - y is one of the differences
+ *   cayley:G:s,...        Cayley coloring of the group G: edge xy is blue
+ *                         when x^-1 y or y^-1 x is one of the elements
+ *   random:n[:seed]       every edge blue with probability 1/2
+ *   density:n:p[:seed]    exactly round(p C(n, 2)) blue edges, uniformly
+ *
+ * G is a direct product of cyclic groups Zn and dihedral groups Dn (of order
+ * 2n) such as Z4xZ4 or D5xZ3, and an element is written with one component
+ * per factor, separated by dots: i for the ith power of the generator of Zn
+ * or the rotation r^i of Dn, and i' for the reflection r^i s. Vertices are
+ * numbered with the first component most significant.
+ */
+
+#ifndef GEN_H
+#define GEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "wide.h"
+
+/* Most factors of a Cayley group */
+#define GEN_MAX_FACTORS 8
+
+/* A product of cyclic and dihedral groups. The component of an element in a
+   dihedral factor Dn is i for r^i and n + i for r^i s */
+typedef struct {
+    int factors;
+    int n[GEN_MAX_FACTORS];
+    bool dihedral[GEN_MAX_FACTORS];
+    int order;
+} Gen_group;
+
+void gen_paley(Wide_graph* g, int q);
+void gen_circulant(Wide_graph* g, int order, const int* diffs, int count);
+
+/* Elements are vertex numbers, i.e. their components in mixed radix */
+void gen_cayley(Wide_graph* g, const Gen_group* group, const int* elements, int count);
+
+void gen_random(Wide_graph* g, int order, uint64_t seed);
+void gen_density(Wide_graph* g, int order, double density, uint64_t seed);
+
+/* Build the coloring a spec names. Returns false without touching g if arg
+   does not start with a generator name; a malformed spec is an error */
+bool gen_spec(Wide_graph* g, const char* spec);
+
+/* A generator spec, or else the path of an adjacency matrix */
+void gen_load(Wide_graph* g, const char* arg);
+
+/* Pack a coloring of at most GRAPH_MAX_ORDER vertices as a Graph */
+void gen_pack(const Wide_graph* w, Graph* g);
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * File: generate.c
+ *
+ * Purpose: Writes out the adjacency matrix of a generated coloring (see
+ *  gen.h for the specs), for the tools which still read matrix files.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gen.h"
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-o out] <spec>\n"
+            "  -o  write the matrix to out instead of stdout\n"
+            "Specs:\n"
+            "  paley:q               q a prime power = 1 mod 4\n"
+            "  circulant:n:d,...     blue differences d of Z_n\n"
+            "  cayley:G:s,...        blue elements s of G, e.g. cayley:Z4xZ4:1.0,0.1,1.1\n"
+            "                        or cayley:D5:1,0' (r^i s is written i')\n"
+            "  random:n[:seed]       fair coin per edge\n"
+            "  density:n:p[:seed]    exactly round(p C(n, 2)) blue edges\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+    const char* out_path = NULL;
+    uint64_t blue = 0;
+    Wide_graph g;
+    FILE* f = stdout;
+    int opt;
+
+    while((opt = getopt(argc, argv, "o:")) != -1) {
+        switch(opt) {
+        case 'o':
+            out_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind != 1 || !gen_spec(&g, argv[optind])) {
+        usage(argv[0]);
+    }
+
+    if(out_path != NULL) {
+        f = fopen(out_path, "w");
+        if(f == NULL) {
+            perror("Could not open output file");
+            exit(EXIT_FAILURE);
+        }
+    }
+    wide_dump(&g, f);
+
+    if(out_path != NULL) {
+        for(int v = 0; v < g.order; v++) {
+            for(int w = 0; w < g.words; w++) {
+                blue += __builtin_popcountll(wide_row(&g, 1, v)[w]);
+            }
+        }
+        fclose(f);
+        printf("Wrote %s: order %d, %llu blue edges\n", out_path, g.order,
+               (unsigned long long)(blue / 2));
+    }
+
+    wide_free(&g);
+
+    return EXIT_SUCCESS;
+}
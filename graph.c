@@ -0,0 +1,511 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+
+/* A graph of the given order with every edge red */
+void graph_init(Graph* g, int order) {
+    memset(g, 0, sizeof(Graph));
+    g->order = order;
+
+    for(int v = 0; v < order; v++) {
+        g->nbr[0][v] = graph_all(order) & ~(((uint64_t)1) << v);
+    }
+}
+
+/* Load an adjacency matrix of 0's and 1's, one row per line. The order is
+   taken from the first row */
+void graph_load(Graph* g, const char* path) {
+    FILE* f = fopen(path, "r");
+    color row[GRAPH_MAX_ORDER];
+    int order = 0;
+    int i, c;
+
+    if(f == NULL) {
+        perror("Could not open adjacency matrix");
+        exit(EXIT_FAILURE);
+    }
+
+    while((c = fgetc(f)) != EOF && c != '\n') {
+        if(c == '0' || c == '1') {
+            if(order == GRAPH_MAX_ORDER) {
+                fprintf(stderr, "Error: graph has more than %d vertices\n", GRAPH_MAX_ORDER);
+                exit(EXIT_FAILURE);
+            }
+            row[order++] = c - '0';
+        }
+    }
+
+    if(order == 0) {
+        fprintf(stderr, "Error: invalid matrix size\n");
+        exit(EXIT_FAILURE);
+    }
+
+    graph_init(g, order);
+    for(i = 1; i < order; i++) {
+        graph_set(g, 0, i, row[i]);
+    }
+
+    /* Rows below the first must agree with the entries already set */
+    i = order;
+    while((c = fgetc(f)) != EOF) {
+        int u, v;
+
+        if(c != '0' && c != '1') {
+            continue;
+        }
+        if(i == order * order) {
+            i++;
+            break;
+        }
+
+        u = i / order;
+        v = i % order;
+        if(u < v) {
+            graph_set(g, u, v, c - '0');
+        } else if(u > v && graph_color(g, u, v) != c - '0') {
+            fprintf(stderr, "Error: matrix is not symmetric at %d, %d\n", u, v);
+            exit(EXIT_FAILURE);
+        }
+        i++;
+    }
+    fclose(f);
+
+    if(i != order * order) {
+        fprintf(stderr, "Error: invalid matrix size\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void graph_dump(const Graph* g, FILE* f) {
+    for(int u = 0; u < g->order; u++) {
+        for(int v = 0; v < g->order; v++) {
+            fputc(u == v ? '0' : '0' + graph_color(g, u, v), f);
+        }
+        fputc('\n', f);
+    }
+}
+
+int graph_parse_masks(Graph* g, const char* s) {
+    char* end;
+    long order = strtol(s, &end, 10);
+
+    if(end == s || *end != ' ' || order < 1 || order > GRAPH_MAX_ORDER) {
+        return 0;
+    }
+
+    graph_init(g, order);
+    for(int v = 0; v < order; v++) {
+        uint64_t others = graph_all(order) & ~(((uint64_t)1) << v);
+
+        uint64_t mask;
+
+        /* strtoull would take a sign, turning -1 into every vertex */
+        for(s = end; *s == ' '; s++);
+        if(*s == '-' || *s == '+') {
+            return 0;
+        }
+
+        mask = strtoull(s, &end, 16);
+        if(end == s || (mask & ~others) != 0) {
+            return 0;
+        }
+        g->nbr[1][v] = mask;
+        g->nbr[0][v] = others & ~mask;
+    }
+    while(*end == ' ' || *end == '\n' || *end == '\r') {
+        end++;
+    }
+    if(*end != '\0') {
+        return 0;
+    }
+
+    for(int v = 0; v < order; v++) {
+        for(uint64_t m = g->nbr[1][v]; m; m &= m - 1) {
+            if(graph_color(g, __builtin_ctzll(m), v) != 1) {
+                return -1;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* Extend the clique, whose common neighbors of color cc above its last vertex
+   are cand, to every k-clique */
+static uint64_t graph_extend(const Graph* g, int* clique, int n, int k, color cc, uint64_t cand,
+                             void (*visit)(const int* clique, int k, color cc, void* arg), void* arg) {
+    uint64_t found = 0;
+
+    if(n == k) {
+        if(visit != NULL) {
+            visit(clique, k, cc, arg);
+        }
+        return 1;
+    }
+
+    /* Not enough candidates left to finish the clique */
+    if(__builtin_popcountll(cand) < k - n) {
+        return 0;
+    }
+
+    for(; cand; cand &= cand - 1) {
+        int v = __builtin_ctzll(cand);
+
+        clique[n] = v;
+        found += graph_extend(g, clique, n + 1, k, cc,
+                              cand & g->nbr[cc][v] & ~((((uint64_t)2) << v) - 1), visit, arg);
+    }
+
+    return found;
+}
+
+uint64_t graph_cliques(const Graph* g, int k,
+                       void (*visit)(const int* clique, int k, color cc, void* arg), void* arg) {
+    int clique[GRAPH_MAX_ORDER];
+    uint64_t found = 0;
+
+    if(k < 2) {
+        return 0;
+    }
+
+    /* The color of a clique is the color of its first edge, so cliques are
+       visited in lexicographic order across both colors */
+    for(int a = 0; a < g->order; a++) {
+        uint64_t above = graph_all(g->order) & ~((((uint64_t)2) << a) - 1);
+
+        clique[0] = a;
+        for(uint64_t bs = above; bs; bs &= bs - 1) {
+            int b = __builtin_ctzll(bs);
+            color cc = graph_color(g, a, b);
+
+            clique[1] = b;
+            found += graph_extend(g, clique, 2, k, cc,
+                                  g->nbr[cc][a] & g->nbr[cc][b] & ~((((uint64_t)2) << b) - 1),
+                                  visit, arg);
+        }
+    }
+
+    return found;
+}
+
+uint64_t graph_cliques_in(const Graph* g, int k, color cc, uint64_t within,
+                          void (*visit)(const int* clique, int k, color cc, void* arg), void* arg) {
+    int clique[GRAPH_MAX_ORDER] = {0};
+
+    return graph_extend(g, clique, 0, k, cc, within, visit, arg);
+}
+
+/* Branch and bound for a larger clique of color cc than best, the current
+   clique having size vertices and common neighbors cand. Candidates are
+   greedily colored into independent sets; a clique takes at most one vertex
+   of each, so size plus the color count bounds what a subtree can reach.
+   Vertices are tried in decreasing color order, dropping each afterwards */
+static void graph_max_clique(const Graph* g, color cc, uint64_t cand, int size, int* best) {
+    int order[GRAPH_MAX_ORDER];
+    int bound[GRAPH_MAX_ORDER];
+    int n = 0, k = 0;
+
+    for(uint64_t left = cand; left; ) {
+        uint64_t q = left;
+
+        k++;
+        while(q) {
+            int v = __builtin_ctzll(q);
+
+            q &= ~g->nbr[cc][v] & ~(((uint64_t)1) << v);
+            left &= ~(((uint64_t)1) << v);
+            order[n] = v;
+            bound[n] = k;
+            n++;
+        }
+    }
+
+    for(int i = n - 1; i >= 0; i--) {
+        int v = order[i];
+        uint64_t next;
+
+        if(size + bound[i] <= *best) {
+            return;
+        }
+
+        next = cand & g->nbr[cc][v];
+        if(next == 0) {
+            *best = size + 1 > *best ? size + 1 : *best;
+        } else {
+            graph_max_clique(g, cc, next, size + 1, best);
+        }
+        cand &= ~(((uint64_t)1) << v);
+    }
+}
+
+int graph_clique_number(const Graph* g, color cc, uint64_t within) {
+    int best = 0;
+
+    if(within) {
+        graph_max_clique(g, cc, within, 0, &best);
+    }
+
+    return best;
+}
+
+static void graph_count_all(const Graph* g, color cc, uint64_t cand, int size, uint64_t* counts) {
+    for(; cand; cand &= cand - 1) {
+        int v = __builtin_ctzll(cand);
+
+        counts[size + 1]++;
+        graph_count_all(g, cc, cand & g->nbr[cc][v] & ~((((uint64_t)2) << v) - 1), size + 1, counts);
+    }
+}
+
+void graph_clique_counts(const Graph* g, color cc, uint64_t within, uint64_t* counts) {
+    memset(counts, 0, sizeof(uint64_t) * (GRAPH_MAX_ORDER + 1));
+    counts[0] = 1;
+    graph_count_all(g, cc, within, 0, counts);
+}
+
+/* Canonical labeling search state */
+typedef struct {
+    const Graph* g;
+
+    /* Vertices individualized on the way to the current node */
+    int path[GRAPH_MAX_ORDER];
+
+    /* Blue rows of the first leaf and of the least relabeling found, with
+       the labelings giving them and the paths leading to them */
+    uint64_t first[GRAPH_MAX_ORDER];
+    int first_lab[GRAPH_MAX_ORDER];
+    int first_path[GRAPH_MAX_ORDER];
+    int first_depth;
+    uint64_t best[GRAPH_MAX_ORDER];
+    int best_lab[GRAPH_MAX_ORDER];
+    int best_path[GRAPH_MAX_ORDER];
+    int best_depth;
+    bool have_best;
+
+    /* Union-find over vertices joined by the automorphisms found, each
+       vertex pointing toward the least of its orbit */
+    int* orbits;
+    uint64_t automorphisms;
+} Graph_canon;
+
+static int graph_orbit_find(int* orbits, int v) {
+    while(orbits[v] != v) {
+        orbits[v] = orbits[orbits[v]];
+        v = orbits[v];
+    }
+
+    return v;
+}
+
+/* Refine the ordered partition, cell[v] being the index of v's cell, until
+   every vertex in a cell has the same number of blue neighbors in each cell.
+   Cells are split by sorting on those counts, so the result only depends on
+   the graph up to isomorphism. Returns the number of cells */
+static int graph_refine(const Graph* g, int* cell, int cells) {
+    uint8_t sig[GRAPH_MAX_ORDER][GRAPH_MAX_ORDER + 1];
+    int idx[GRAPH_MAX_ORDER];
+    int n = g->order;
+
+    for(;;) {
+        uint64_t members[GRAPH_MAX_ORDER] = {0};
+        int next = 0;
+
+        for(int v = 0; v < n; v++) {
+            members[cell[v]] |= ((uint64_t)1) << v;
+        }
+
+        for(int v = 0; v < n; v++) {
+            sig[v][0] = cell[v];
+            for(int c = 0; c < cells; c++) {
+                sig[v][c + 1] = __builtin_popcountll(g->nbr[1][v] & members[c]);
+            }
+        }
+
+        /* Insertion sort is plenty for 64 vertices */
+        for(int i = 0; i < n; i++) {
+            int v = i;
+            int j = i;
+
+            for(; j > 0 && memcmp(sig[idx[j - 1]], sig[v], cells + 1) > 0; j--) {
+                idx[j] = idx[j - 1];
+            }
+            idx[j] = v;
+        }
+
+        for(int i = 0; i < n; i++) {
+            if(i > 0 && memcmp(sig[idx[i - 1]], sig[idx[i]], cells + 1) != 0) {
+                next++;
+            }
+            cell[idx[i]] = next;
+        }
+
+        if(next + 1 == cells) {
+            return cells;
+        }
+        cells = next + 1;
+    }
+}
+
+/* Join the orbits of the automorphism taking the labeling from onto to */
+static void graph_canon_automorphism(Graph_canon* c, const int* from, const int* to) {
+    for(int i = 0; i < c->g->order; i++) {
+        int a = graph_orbit_find(c->orbits, from[i]);
+        int b = graph_orbit_find(c->orbits, to[i]);
+
+        if(a < b) {
+            c->orbits[b] = a;
+        } else if(b < a) {
+            c->orbits[a] = b;
+        }
+    }
+}
+
+/* Depth of the node where two individualization paths part */
+static int graph_canon_common(const int* a, int a_depth, const int* b, int b_depth) {
+    int d = 0;
+
+    while(d < a_depth && d < b_depth && a[d] == b[d]) {
+        d++;
+    }
+
+    return d;
+}
+
+/* Compare the leaf against the first and least relabelings. A leaf equal to
+   one of them gives an automorphism, which maps the subtree the two paths
+   part at onto itself, so the rest of the current branch there holds nothing
+   new: the depth of that node is returned to unwind to. Otherwise the leaf's
+   own depth */
+static int graph_canon_leaf(Graph_canon* c, const int* cell, int depth) {
+    const Graph* g = c->g;
+    uint64_t rows[GRAPH_MAX_ORDER];
+    int lab[GRAPH_MAX_ORDER];
+    int cmp = 0;
+
+    for(int v = 0; v < g->order; v++) {
+        lab[cell[v]] = v;
+    }
+
+    for(int i = 0; i < g->order; i++) {
+        rows[i] = 0;
+        for(uint64_t m = g->nbr[1][lab[i]]; m; m &= m - 1) {
+            rows[i] |= ((uint64_t)1) << cell[__builtin_ctzll(m)];
+        }
+
+        if(cmp == 0 && c->have_best && rows[i] != c->best[i]) {
+            cmp = rows[i] < c->best[i] ? -1 : 1;
+        }
+    }
+
+    if(!c->have_best) {
+        memcpy(c->first, rows, sizeof(uint64_t) * g->order);
+        memcpy(c->first_lab, lab, sizeof(int) * g->order);
+        memcpy(c->first_path, c->path, sizeof(int) * depth);
+        c->first_depth = depth;
+    } else if(memcmp(rows, c->first, sizeof(uint64_t) * g->order) == 0) {
+        graph_canon_automorphism(c, c->first_lab, lab);
+        return graph_canon_common(c->path, depth, c->first_path, c->first_depth);
+    } else if(cmp == 0) {
+        graph_canon_automorphism(c, c->best_lab, lab);
+        return graph_canon_common(c->path, depth, c->best_path, c->best_depth);
+    }
+
+    if(!c->have_best || cmp < 0) {
+        memcpy(c->best, rows, sizeof(uint64_t) * g->order);
+        memcpy(c->best_lab, lab, sizeof(int) * g->order);
+        memcpy(c->best_path, c->path, sizeof(int) * depth);
+        c->best_depth = depth;
+        c->have_best = true;
+    }
+
+    return depth;
+}
+
+/* Individualize each vertex of the first non-singleton cell in turn. Every
+   automorphism found so far was found below the node, so on the path to the
+   first leaf they all fix the vertices individualized above it: a vertex in
+   the orbit of a lesser one gives an equivalent subtree and is skipped, and
+   the orbit of the first path's vertex is the orbit under the stabilizer
+   there, a factor of the group order. Returns the depth to unwind to */
+static int graph_canon_search(Graph_canon* c, const int* cell, int cells, int depth) {
+    int n = c->g->order;
+    int size[GRAPH_MAX_ORDER] = {0};
+    int next[GRAPH_MAX_ORDER];
+    int target = -1;
+    bool on_first;
+
+    if(cells == n) {
+        return graph_canon_leaf(c, cell, depth);
+    }
+
+    on_first = !c->have_best ||
+        graph_canon_common(c->path, depth, c->first_path, c->first_depth) == depth;
+
+    for(int v = 0; v < n; v++) {
+        size[cell[v]]++;
+    }
+    for(target = 0; size[target] == 1; target++);
+
+    for(int v = 0; v < n; v++) {
+        int back;
+
+        if(cell[v] != target || (on_first && graph_orbit_find(c->orbits, v) != v)) {
+            continue;
+        }
+
+        for(int u = 0; u < n; u++) {
+            next[u] = cell[u] + (cell[u] > target || (cell[u] == target && u != v));
+        }
+        c->path[depth] = v;
+        back = graph_canon_search(c, next, graph_refine(c->g, next, cells + 1), depth + 1);
+        if(back < depth) {
+            return back;
+        }
+    }
+
+    if(on_first) {
+        int root = graph_orbit_find(c->orbits, c->first_path[depth]);
+        uint64_t orbit = 0;
+
+        for(int v = 0; v < n; v++) {
+            orbit += graph_orbit_find(c->orbits, v) == root;
+        }
+        if(__builtin_mul_overflow(c->automorphisms, orbit, &c->automorphisms)) {
+            c->automorphisms = UINT64_MAX;
+        }
+    }
+
+    return depth;
+}
+
+uint64_t graph_canonical(const Graph* g, Graph* canon, int* orbits) {
+    int cell[GRAPH_MAX_ORDER] = {0};
+    int own[GRAPH_MAX_ORDER];
+    Graph_canon c;
+
+    c.g = g;
+    c.have_best = false;
+    c.orbits = orbits != NULL ? orbits : own;
+    c.automorphisms = 1;
+
+    for(int v = 0; v < g->order; v++) {
+        c.orbits[v] = v;
+    }
+
+    graph_canon_search(&c, cell, graph_refine(g, cell, 1), 0);
+
+    graph_init(canon, g->order);
+    for(int i = 0; i < g->order; i++) {
+        canon->nbr[1][i] = c.best[i];
+        canon->nbr[0][i] = graph_all(g->order) & ~c.best[i] & ~(((uint64_t)1) << i);
+    }
+
+    if(orbits != NULL) {
+        for(int v = 0; v < g->order; v++) {
+            orbits[v] = graph_orbit_find(orbits, v);
+        }
+    }
+
+    return c.automorphisms;
+}
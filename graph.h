@@ -0,0 +1,84 @@
+/**
+ * Two-colorings of complete graphs of up to 64 vertices, packed as one
+ * neighbor mask per vertex and color. Used by the tools which take graphs of
+ * any order rather than the fixed ADJ_MATRIX_ORDER matrix.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Color of each edge (0 -> red, 1 -> blue) */
+typedef uint8_t color;
+
+/* Largest order a graph can be packed for */
+#define GRAPH_MAX_ORDER 64
+
+typedef struct {
+    int order;
+
+    /* nbr[c][v] has bit u set when edge uv has color c */
+    uint64_t nbr[2][GRAPH_MAX_ORDER];
+} Graph;
+
+static inline color graph_color(const Graph* g, int u, int v) {
+    return (g->nbr[1][u] >> v) & 1;
+}
+
+static inline void graph_set(Graph* g, int u, int v, color c) {
+    uint64_t bu = ((uint64_t)1) << u;
+    uint64_t bv = ((uint64_t)1) << v;
+
+    g->nbr[c][u] |= bv;
+    g->nbr[!c][u] &= ~bv;
+    g->nbr[c][v] |= bu;
+    g->nbr[!c][v] &= ~bu;
+}
+
+/* Every vertex below order */
+static inline uint64_t graph_all(int order) {
+    return order == 64 ? ~(uint64_t)0 : (((uint64_t)1) << order) - 1;
+}
+
+void graph_init(Graph* g, int order);
+void graph_load(Graph* g, const char* path);
+void graph_dump(const Graph* g, FILE* f);
+
+/* Parse a mask line: the order, then the blue neighbors of each vertex in
+   hex, as grow writes its runs. Returns 1 for a coloring, -1 for masks
+   which are not symmetric, and 0 if s is not a mask line, including masks
+   with a sign or with bits on the diagonal or at or above the order */
+int graph_parse_masks(Graph* g, const char* s);
+
+/* Call visit for every monochromatic k-clique, in lexicographic order.
+   Returns the number of cliques found */
+uint64_t graph_cliques(const Graph* g, int k,
+                       void (*visit)(const int* clique, int k, color cc, void* arg), void* arg);
+
+/* The same for the k-cliques of color cc among the vertices of within */
+uint64_t graph_cliques_in(const Graph* g, int k, color cc, uint64_t within,
+                          void (*visit)(const int* clique, int k, color cc, void* arg), void* arg);
+
+/* Size of the largest clique of color cc among the vertices of within */
+int graph_clique_number(const Graph* g, color cc, uint64_t within);
+
+/* Count the cliques of color cc among the vertices of within by size, in one
+   pass: counts[k] is the number of k-cliques, for k up to GRAPH_MAX_ORDER */
+void graph_clique_counts(const Graph* g, color cc, uint64_t within, uint64_t* counts);
+
+/* Relabel g canonically, so isomorphic graphs give identical canon. The
+   ordered partition of the vertices is refined by blue neighbor counts and
+   the individualizations of the first non-singleton cell are tried, keeping
+   the least relabeling. As in nauty, a leaf equal to the first or least one
+   gives an automorphism, which cuts off the rest of its branch, and on the
+   first path vertices in an orbit already found are skipped, so large
+   groups cost about order^2 leaves rather than one per automorphism. If
+   orbits is given each vertex is mapped to the least vertex of its orbit
+   under the automorphism group. Returns the order of the automorphism group,
+   UINT64_MAX if it does not fit */
+uint64_t graph_canonical(const Graph* g, Graph* canon, int* orbits);
+
+#endif
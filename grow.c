@@ -0,0 +1,644 @@
+/**
+ * File: grow.c
+ *
+ * Purpose: Depth-first growth of R(s, t) colorings from a seed. Every
+ *  one-vertex extension of the current coloring is enumerated, extensions
+ *  isomorphic to a coloring already seen are dropped, and the search recurses
+ *  into the rest. Colorings with no extension are maximal and are recorded.
+ *
+ *  The extension instance of a coloring (its red (s - 1)-cliques and blue
+ *  (t - 1)-cliques) is kept for each level of the search. A child's instance
+ *  is its parent's plus the cliques through the new vertex, found among the
+ *  new vertex's neighbors, so nothing is enumerated from scratch below the
+ *  seed.
+ *
+ *  The run lives in a directory so it survives restarts:
+ *
+ *   frontier  the search path, checkpointed every so many expansions: each
+ *             level's coloring and the extension rows still to be visited,
+ *             the lengths of seen and maximal at the checkpoint, the run's
+ *             options and its counters
+ *   seen      canonical form of every coloring generated, appended to
+ *   maximal   colorings found to have no extension, appended to
+ *
+ *  On restart seen and maximal are cut back to their lengths at the last
+ *  checkpoint, since anything after belongs to expansions being redone, and
+ *  the counters carry on from the checkpoint. Options given again must match
+ *  the run's.
+ *
+ *  Colorings are written one per line as their order and the hex blue
+ *  neighbor mask of each vertex.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "extension.h"
+#include "graph.h"
+
+/* Default base graph */
+#define ADJ_MATRIX_FILE "g55.42"
+
+/* Colorings expanded between frontier checkpoints */
+#define GROW_CHECKPOINT_INTERVAL 1000
+
+/* One level of the search path */
+typedef struct {
+    Graph g;
+
+    /* Extension instance of g */
+    Ext_clique* cliques;
+    int count;
+    int size;
+
+    /* Extension rows still to be visited */
+    uint64_t* pending;
+    int pending_count;
+    int pending_size;
+} Grow_level;
+
+/* Canonical form of a coloring already seen */
+typedef struct {
+    uint64_t hash;
+    int order;
+    uint64_t* rows;
+} Grow_seen;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+static void write_graph(const Graph* g, FILE* f);
+static bool read_graph(Graph* g, FILE* f);
+static bool seen_insert(const Graph* canon, bool record);
+static void level_index(Grow_level* child, const Grow_level* parent);
+static uint64_t level_expand(Grow_level* level);
+static void checkpoint(void);
+static bool resume(void);
+
+/* Options, 0 until given or restored from the frontier */
+static int clique_size[2] = { 0, 0 };
+static int max_order = 0;
+static int interval = 0;
+static const char* run_dir = NULL;
+
+static Grow_level levels[GRAPH_MAX_ORDER + 1];
+static int depth = 0;
+
+static Grow_seen* seen = NULL;
+static uint64_t seen_cap = 0;
+static uint64_t seen_count = 0;
+static FILE* seen_file = NULL;
+static FILE* maximal_file = NULL;
+
+/* Colorings generated and found maximal at each order, expansions made and
+   the largest order reached, over the whole run */
+static uint64_t generated[GRAPH_MAX_ORDER + 1];
+static uint64_t maximal[GRAPH_MAX_ORDER + 1];
+static uint64_t expansions = 0;
+static int largest = 0;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-c s,t] [-p n] [-m max_order] [-i interval] <dir> [seed]\n"
+            "  -c  clique sizes s,t of the colorings (default 5,5)\n"
+            "  -p  seed with the coloring induced on the first n vertices of seed\n"
+            "  -m  do not extend colorings of this order (default %d)\n"
+            "  -i  expansions between frontier checkpoints (default %d)\n"
+            "A run is resumed from dir if it has a frontier, ignoring the seed and\n"
+            "keeping the run's -c and -m, which must match if given again\n",
+            prog, GRAPH_MAX_ORDER, GROW_CHECKPOINT_INTERVAL);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void write_graph(const Graph* g, FILE* f) {
+    fprintf(f, "%d", g->order);
+    for(int v = 0; v < g->order; v++) {
+        fprintf(f, " %llx", (unsigned long long) g->nbr[1][v]);
+    }
+    fprintf(f, "\n");
+}
+
+static bool read_graph(Graph* g, FILE* f) {
+    int order;
+
+    if(fscanf(f, "%d", &order) != 1 || order < 1 || order > GRAPH_MAX_ORDER) {
+        return false;
+    }
+
+    graph_init(g, order);
+    for(int v = 0; v < order; v++) {
+        unsigned long long row;
+
+        if(fscanf(f, "%llx", &row) != 1) {
+            return false;
+        }
+        g->nbr[1][v] = row & graph_all(order) & ~(((uint64_t)1) << v);
+        g->nbr[0][v] = graph_all(order) & ~g->nbr[1][v] & ~(((uint64_t)1) << v);
+    }
+
+    return true;
+}
+
+static uint64_t seen_hash(const Graph* canon) {
+    uint64_t h = canon->order * 0x9e3779b97f4a7c15ULL;
+
+    for(int v = 0; v < canon->order; v++) {
+        h = (h ^ canon->nbr[1][v]) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+
+    return h;
+}
+
+static Grow_seen* seen_find(uint64_t hash, const Graph* canon) {
+    uint64_t i = hash & (seen_cap - 1);
+
+    while(seen[i].rows != NULL &&
+          (seen[i].hash != hash || seen[i].order != canon->order ||
+           memcmp(seen[i].rows, canon->nbr[1], sizeof(uint64_t) * canon->order) != 0)) {
+        i = (i + 1) & (seen_cap - 1);
+    }
+
+    return &seen[i];
+}
+
+/* Add a canonical form to the seen set, and to the seen file if record is
+   set. Returns false if it was already there */
+static bool seen_insert(const Graph* canon, bool record) {
+    uint64_t hash = seen_hash(canon);
+    Grow_seen* entry;
+
+    if(2 * (seen_count + 1) > seen_cap) {
+        Grow_seen* old = seen;
+        uint64_t old_cap = seen_cap;
+
+        seen_cap = old_cap ? 2 * old_cap : 1024;
+        seen = calloc(seen_cap, sizeof(Grow_seen));
+        if(seen == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+
+        for(uint64_t i = 0; i < old_cap; i++) {
+            if(old[i].rows != NULL) {
+                uint64_t j = old[i].hash & (seen_cap - 1);
+
+                while(seen[j].rows != NULL) {
+                    j = (j + 1) & (seen_cap - 1);
+                }
+                seen[j] = old[i];
+            }
+        }
+        free(old);
+    }
+
+    entry = seen_find(hash, canon);
+    if(entry->rows != NULL) {
+        return false;
+    }
+
+    entry->hash = hash;
+    entry->order = canon->order;
+    entry->rows = malloc(sizeof(uint64_t) * canon->order);
+    if(entry->rows == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(entry->rows, canon->nbr[1], sizeof(uint64_t) * canon->order);
+    seen_count++;
+
+    if(record) {
+        write_graph(canon, seen_file);
+    }
+
+    return true;
+}
+
+/* Build the extension instance of child, whose coloring is parent's plus one
+   vertex, or of a seed if parent is NULL */
+static void level_index(Grow_level* child, const Grow_level* parent) {
+    if(parent == NULL) {
+        free(child->cliques);
+        child->cliques = ext_from_graph(&child->g, clique_size[0], clique_size[1], &child->count);
+        child->size = child->count;
+        return;
+    }
+
+    if(child->size < parent->count) {
+        child->size = parent->count;
+        child->cliques = realloc(child->cliques, sizeof(Ext_clique) * child->size);
+        if(child->cliques == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(child->cliques, parent->cliques, sizeof(Ext_clique) * parent->count);
+    child->count = parent->count;
+
+    ext_add_vertex(&child->g, clique_size[0], clique_size[1], &child->cliques, &child->count, &child->size);
+}
+
+static void add_pending(uint64_t row, void* arg) {
+    Grow_level* level = arg;
+    Graph child;
+    Graph canon;
+    int n = level->g.order;
+
+    child = level->g;
+    child.order = n + 1;
+    child.nbr[0][n] = 0;
+    child.nbr[1][n] = 0;
+    for(int v = 0; v < n; v++) {
+        child.nbr[0][v] &= ~(((uint64_t)1) << n);
+        child.nbr[1][v] &= ~(((uint64_t)1) << n);
+        graph_set(&child, v, n, (row >> v) & 1);
+    }
+
+    graph_canonical(&child, &canon, NULL);
+    if(!seen_insert(&canon, true)) {
+        return;
+    }
+    generated[n + 1]++;
+
+    if(level->pending_count == level->pending_size) {
+        level->pending_size = level->pending_size ? 2 * level->pending_size : 64;
+        level->pending = realloc(level->pending, sizeof(uint64_t) * level->pending_size);
+        if(level->pending == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    level->pending[level->pending_count++] = row;
+}
+
+/* Enumerate the extensions of a level's coloring, keeping those not seen
+   before. Returns the number of extensions, seen or not */
+static uint64_t level_expand(Grow_level* level) {
+    level->pending_count = 0;
+
+    if(level->g.order >= max_order) {
+        return 0;
+    }
+
+    return ext_enumerate(level->cliques, level->count, level->g.order, add_pending, level);
+}
+
+static FILE* open_run_file(const char* name, const char* mode) {
+    char path[4096];
+    FILE* f;
+
+    snprintf(path, sizeof(path), "%s/%s", run_dir, name);
+    f = fopen(path, mode);
+    if(f == NULL && mode[0] != 'r') {
+        perror("Could not open run file");
+        exit(EXIT_FAILURE);
+    }
+
+    return f;
+}
+
+static void sync_run_file(FILE* f) {
+    if(fflush(f) != 0 || fsync(fileno(f)) != 0) {
+        perror("Could not write run file");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Replace the frontier with the current search path */
+static void checkpoint(void) {
+    char tmp[4096];
+    char path[4096];
+    FILE* f;
+
+    sync_run_file(seen_file);
+    sync_run_file(maximal_file);
+
+    f = open_run_file("frontier.tmp", "w");
+    fprintf(f, "p grow %d %d %d %ld %ld\n", clique_size[0], clique_size[1], depth,
+            ftell(seen_file), ftell(maximal_file));
+    fprintf(f, "m %d %d %llu %d\n", max_order, interval,
+            (unsigned long long) expansions, largest);
+    for(int i = 0; i <= GRAPH_MAX_ORDER; i++) {
+        if(generated[i] || maximal[i]) {
+            fprintf(f, "o %d %llu %llu\n", i, (unsigned long long) generated[i],
+                    (unsigned long long) maximal[i]);
+        }
+    }
+    for(int i = 0; i < depth; i++) {
+        fprintf(f, "l %d\n", levels[i].pending_count);
+        write_graph(&levels[i].g, f);
+        for(int k = 0; k < levels[i].pending_count; k++) {
+            fprintf(f, "%llx\n", (unsigned long long) levels[i].pending[k]);
+        }
+    }
+
+    if(fflush(f) != 0 || fsync(fileno(f)) != 0 || fclose(f) != 0) {
+        perror("Could not write frontier");
+        exit(EXIT_FAILURE);
+    }
+
+    snprintf(tmp, sizeof(tmp), "%s/frontier.tmp", run_dir);
+    snprintf(path, sizeof(path), "%s/frontier", run_dir);
+    if(rename(tmp, path) != 0) {
+        perror("Could not replace frontier");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void truncate_run_file(const char* name, long length) {
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s/%s", run_dir, name);
+    if(truncate(path, length) != 0) {
+        perror("Could not truncate run file");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Check an option given again against the run's, or restore it */
+static void resume_option(int* option, int saved, const char* name) {
+    if(*option != 0 && *option != saved) {
+        fprintf(stderr, "Error: the run was started with %s %d\n", name, saved);
+        exit(EXIT_FAILURE);
+    }
+    *option = saved;
+}
+
+/* Load the seen set, search path and counters of an earlier run. Returns
+   false if the run directory has no frontier */
+static bool resume(void) {
+    FILE* f = open_run_file("frontier", "r");
+    long seen_length, maximal_length;
+    unsigned long long runs, found;
+    Graph g;
+    int s, t, n, m, i;
+    char tag;
+
+    if(f == NULL) {
+        return false;
+    }
+
+    if(fscanf(f, " p grow %d %d %d %ld %ld", &s, &t, &n, &seen_length, &maximal_length) != 5 ||
+       n < 0 || n > GRAPH_MAX_ORDER) {
+        fprintf(stderr, "Error: malformed frontier\n");
+        exit(EXIT_FAILURE);
+    }
+    if(clique_size[0] != 0 && (clique_size[0] != s || clique_size[1] != t)) {
+        fprintf(stderr, "Error: the run was started with clique sizes %d,%d\n", s, t);
+        exit(EXIT_FAILURE);
+    }
+    clique_size[0] = s;
+    clique_size[1] = t;
+
+    if(fscanf(f, " m %d %d %llu %d", &m, &i, &runs, &largest) != 4 || m < 1 || i < 1) {
+        fprintf(stderr, "Error: malformed frontier\n");
+        exit(EXIT_FAILURE);
+    }
+    resume_option(&max_order, m, "-m");
+    if(interval == 0) {
+        interval = i;
+    }
+    expansions = runs;
+
+    while(fscanf(f, " %c", &tag) == 1 && tag == 'o') {
+        if(fscanf(f, "%d %llu %llu", &i, &runs, &found) != 3 || i < 0 || i > GRAPH_MAX_ORDER) {
+            fprintf(stderr, "Error: malformed frontier\n");
+            exit(EXIT_FAILURE);
+        }
+        generated[i] = runs;
+        maximal[i] = found;
+    }
+    if(!feof(f)) {
+        ungetc(tag, f);
+    }
+
+    for(depth = 0; depth < n; depth++) {
+        Grow_level* level = &levels[depth];
+        int pending;
+
+        if(fscanf(f, " l %d", &pending) != 1 || pending < 0 || !read_graph(&level->g, f)) {
+            fprintf(stderr, "Error: malformed frontier\n");
+            exit(EXIT_FAILURE);
+        }
+
+        level->pending = malloc(sizeof(uint64_t) * (pending + 1));
+        if(level->pending == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+        level->pending_size = pending + 1;
+        level->pending_count = pending;
+        for(int k = 0; k < pending; k++) {
+            unsigned long long row;
+
+            if(fscanf(f, "%llx", &row) != 1) {
+                fprintf(stderr, "Error: malformed frontier\n");
+                exit(EXIT_FAILURE);
+            }
+            level->pending[k] = row;
+        }
+
+        level_index(level, depth ? &levels[depth - 1] : NULL);
+    }
+    fclose(f);
+
+    truncate_run_file("seen", seen_length);
+    truncate_run_file("maximal", maximal_length);
+
+    f = open_run_file("seen", "r");
+    if(f == NULL) {
+        perror("Could not open seen");
+        exit(EXIT_FAILURE);
+    }
+    while(read_graph(&g, f)) {
+        seen_insert(&g, false);
+    }
+    fclose(f);
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    struct timespec start;
+    const char* seed_path = ADJ_MATRIX_FILE;
+    int prefix = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:p:m:i:")) != -1) {
+        switch(opt) {
+        case 'c':
+            if(sscanf(optarg, "%d,%d", &clique_size[0], &clique_size[1]) != 2 ||
+               clique_size[0] < 3 || clique_size[1] < 3) {
+                usage(argv[0]);
+            }
+            break;
+        case 'p':
+            prefix = atoi(optarg);
+            break;
+        case 'm':
+            max_order = atoi(optarg);
+            if(max_order < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 'i':
+            interval = atoi(optarg);
+            if(interval < 1) {
+                usage(argv[0]);
+            }
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind != 1 && argc - optind != 2) {
+        usage(argv[0]);
+    }
+    run_dir = argv[optind];
+    if(argc - optind == 2) {
+        seed_path = argv[optind + 1];
+    }
+    if(max_order > GRAPH_MAX_ORDER) {
+        usage(argv[0]);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if(resume()) {
+        /* Positions in append mode are only defined after a seek */
+        seen_file = open_run_file("seen", "a");
+        maximal_file = open_run_file("maximal", "a");
+        fseek(seen_file, 0, SEEK_END);
+        fseek(maximal_file, 0, SEEK_END);
+        printf("Resumed R(%d, %d) growth at depth %d, %llu colorings seen\n",
+               clique_size[0], clique_size[1], depth, (unsigned long long) seen_count);
+    } else {
+        Grow_level* root = &levels[0];
+        uint64_t extensions;
+        Graph canon;
+
+        if(clique_size[0] == 0) {
+            clique_size[0] = clique_size[1] = 5;
+        }
+        if(max_order == 0) {
+            max_order = GRAPH_MAX_ORDER;
+        }
+        if(interval == 0) {
+            interval = GROW_CHECKPOINT_INTERVAL;
+        }
+
+        graph_load(&root->g, seed_path);
+        if(prefix > 0 && prefix < root->g.order) {
+            Graph full = root->g;
+
+            graph_init(&root->g, prefix);
+            for(int u = 0; u < prefix; u++) {
+                for(int v = u + 1; v < prefix; v++) {
+                    graph_set(&root->g, u, v, graph_color(&full, u, v));
+                }
+            }
+        }
+
+        /* Everything grown from the seed, the seed included, is recorded as
+           an R(s, t) coloring, so the seed must be one */
+        if(graph_clique_number(&root->g, 0, graph_all(root->g.order)) >= clique_size[0] ||
+           graph_clique_number(&root->g, 1, graph_all(root->g.order)) >= clique_size[1]) {
+            fprintf(stderr, "Error: the seed of order %d has a red K%d or a blue K%d\n",
+                    root->g.order, clique_size[0], clique_size[1]);
+            exit(EXIT_FAILURE);
+        }
+
+        seen_file = open_run_file("seen", "w");
+        maximal_file = open_run_file("maximal", "w");
+
+        level_index(root, NULL);
+        graph_canonical(&root->g, &canon, NULL);
+        seen_insert(&canon, true);
+        generated[root->g.order]++;
+        extensions = level_expand(root);
+        depth = 1;
+
+        printf("Growing R(%d, %d) colorings from %s, order %d, %llu extensions\n",
+               clique_size[0], clique_size[1], seed_path, root->g.order,
+               (unsigned long long) extensions);
+        if(extensions == 0 && root->g.order < max_order) {
+            maximal[root->g.order]++;
+            write_graph(&root->g, maximal_file);
+        }
+        checkpoint();
+    }
+
+    while(depth > 0) {
+        Grow_level* parent = &levels[depth - 1];
+        Grow_level* child = &levels[depth];
+        uint64_t extensions;
+        uint64_t row;
+        int n = parent->g.order;
+
+        if(parent->pending_count == 0) {
+            depth--;
+            continue;
+        }
+
+        row = parent->pending[--parent->pending_count];
+        child->g = parent->g;
+        child->g.order = n + 1;
+        child->g.nbr[0][n] = 0;
+        child->g.nbr[1][n] = 0;
+        for(int v = 0; v < n; v++) {
+            graph_set(&child->g, v, n, (row >> v) & 1);
+        }
+
+        level_index(child, parent);
+        extensions = level_expand(child);
+
+        if(child->g.order > largest) {
+            largest = child->g.order;
+        }
+
+        /* Extensions which were all seen before still make it non-maximal */
+        if(child->pending_count > 0) {
+            depth++;
+        } else if(extensions == 0 && child->g.order < max_order) {
+            maximal[child->g.order]++;
+            write_graph(&child->g, maximal_file);
+        }
+
+        if(++expansions % interval == 0) {
+            checkpoint();
+            printf("%llu expansions, depth %d, order %d, %llu colorings seen, %.2fs\n",
+                   (unsigned long long) expansions, depth, child->g.order,
+                   (unsigned long long) seen_count, elapsed(&start));
+            fflush(stdout);
+        }
+    }
+
+    checkpoint();
+
+    printf("Done after %llu expansions, largest order reached %d, %.2fs\n",
+           (unsigned long long) expansions, largest, elapsed(&start));
+    for(int i = 0; i <= GRAPH_MAX_ORDER; i++) {
+        if(generated[i] || maximal[i]) {
+            printf("  order %d: %llu colorings, %llu maximal\n", i,
+                   (unsigned long long) generated[i], (unsigned long long) maximal[i]);
+        }
+    }
+
+    fclose(seen_file);
+    fclose(maximal_file);
+
+    return EXIT_SUCCESS;
+}
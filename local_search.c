@@ -0,0 +1,333 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "local_search.h"
+
+/* Flips between checks of whether another thread has finished */
+#define LS_POLL_INTERVAL 4096
+
+/* State shared between the search threads */
+typedef struct {
+    const Ext_clique* cliques;
+    int count;
+    int order;
+
+    /* Cliques containing each vertex v are occ[occ_start[v]] up to
+       occ[occ_start[v + 1]] */
+    int* occ;
+    int occ_start[EXT_MAX_ORDER + 1];
+
+    pthread_mutex_t lock;
+    uint64_t best_row;
+    int best;
+    bool done;
+    uint64_t flips;
+    uint64_t tries;
+} Ls_shared;
+
+/* Per thread search state */
+typedef struct {
+    Ls_shared* shared;
+    pthread_t thread;
+    uint64_t rng;
+
+    uint64_t row;
+
+    /* Number of vertices in each clique whose edge to the new vertex differs
+       from the clique's color. A clique is closed when this reaches 0 */
+    uint8_t* true_count;
+
+    /* Number of cliques each vertex is the only differing edge for, i.e. the
+       number of cliques flipping that vertex would close */
+    int brk[EXT_MAX_ORDER];
+
+    /* Closed cliques, and the position of each clique in that list */
+    int* viol;
+    int* viol_pos;
+    int viol_count;
+} Ls_thread;
+
+/* xorshift64* */
+static inline uint64_t ls_rand(uint64_t* s) {
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 2685821657736338717ULL;
+}
+
+/* Uniform value in [0, n) */
+static inline uint32_t ls_rand_below(uint64_t* s, uint32_t n) {
+    return (uint32_t)(((ls_rand(s) >> 32) * n) >> 32);
+}
+
+/* Vertices of the clique whose edge to the new vertex differs from the
+   clique's color */
+static inline uint64_t ls_true_bits(const Ext_clique* clique, uint64_t row) {
+    return (clique->cc ? ~row : row) & clique->mask;
+}
+
+static inline void ls_viol_add(Ls_thread* t, int c) {
+    t->viol_pos[c] = t->viol_count;
+    t->viol[t->viol_count++] = c;
+}
+
+static inline void ls_viol_remove(Ls_thread* t, int c) {
+    int last = t->viol[--t->viol_count];
+
+    t->viol[t->viol_pos[c]] = last;
+    t->viol_pos[last] = t->viol_pos[c];
+}
+
+/* Start a new try from a uniformly random row */
+static void ls_restart(Ls_thread* t) {
+    const Ls_shared* s = t->shared;
+    uint64_t full = s->order == 64 ? ~(uint64_t)0 : (((uint64_t)1) << s->order) - 1;
+
+    t->row = ls_rand(&t->rng) & full;
+    t->viol_count = 0;
+    for(int v = 0; v < s->order; v++) {
+        t->brk[v] = 0;
+    }
+
+    for(int c = 0; c < s->count; c++) {
+        uint64_t tb = ls_true_bits(&s->cliques[c], t->row);
+
+        t->true_count[c] = __builtin_popcountll(tb);
+        if(t->true_count[c] == 0) {
+            ls_viol_add(t, c);
+        } else if(t->true_count[c] == 1) {
+            t->brk[__builtin_ctzll(tb)]++;
+        }
+    }
+}
+
+/* Flip the edge to vertex v, updating only the cliques which contain v
+
+   O(n), n = number of cliques containing v
+ */
+static inline void ls_flip(Ls_thread* t, int v) {
+    const Ls_shared* s = t->shared;
+    uint64_t bit = ((uint64_t)1) << v;
+    color old = (t->row >> v) & 1;
+
+    t->row ^= bit;
+
+    for(int i = s->occ_start[v]; i < s->occ_start[v + 1]; i++) {
+        int c = s->occ[i];
+        const Ext_clique* clique = &s->cliques[c];
+
+        if(old != clique->cc) {
+            /* v stops differing from the clique color */
+            t->true_count[c]--;
+            if(t->true_count[c] == 0) {
+                ls_viol_add(t, c);
+                t->brk[v]--;
+            } else if(t->true_count[c] == 1) {
+                t->brk[__builtin_ctzll(ls_true_bits(clique, t->row))]++;
+            }
+        } else {
+            /* v starts differing from the clique color */
+            t->true_count[c]++;
+            if(t->true_count[c] == 1) {
+                ls_viol_remove(t, c);
+                t->brk[v]++;
+            } else if(t->true_count[c] == 2) {
+                t->brk[__builtin_ctzll(ls_true_bits(clique, t->row) & ~bit)]--;
+            }
+        }
+    }
+}
+
+/* Pick a closed clique at random and flip one of its vertices: a vertex which
+   breaks nothing if there is one, otherwise a random vertex with probability
+   LS_NOISE and the vertex with the lowest break count otherwise */
+static inline void ls_step(Ls_thread* t) {
+    int c = t->viol[ls_rand_below(&t->rng, t->viol_count)];
+    uint64_t mask = t->shared->cliques[c].mask;
+    int vertices[EXT_MAX_ORDER];
+    int n = 0;
+    int best = -1;
+    int best_brk = INT_MAX;
+    int ties = 0;
+
+    while(mask) {
+        int v = __builtin_ctzll(mask);
+
+        mask &= mask - 1;
+        vertices[n++] = v;
+
+        if(t->brk[v] < best_brk) {
+            best = v;
+            best_brk = t->brk[v];
+            ties = 1;
+        } else if(t->brk[v] == best_brk && ls_rand_below(&t->rng, ++ties) == 0) {
+            best = v;
+        }
+    }
+
+    if(best_brk > 0 && ls_rand_below(&t->rng, 1000) < LS_NOISE) {
+        best = vertices[ls_rand_below(&t->rng, n)];
+    }
+
+    ls_flip(t, best);
+}
+
+/* Publish the thread's current row if it beats the global best. Returns the
+   global best */
+static int ls_report(Ls_thread* t) {
+    Ls_shared* s = t->shared;
+    int best;
+
+    pthread_mutex_lock(&s->lock);
+    if(t->viol_count < s->best) {
+        s->best = t->viol_count;
+        s->best_row = t->row;
+        if(s->best == 0) {
+            s->done = true;
+        }
+    }
+    best = s->best;
+    pthread_mutex_unlock(&s->lock);
+
+    return best;
+}
+
+static void* ls_worker(void* arg) {
+    Ls_thread* t = arg;
+    Ls_shared* s = t->shared;
+    uint64_t flips = 0;
+    uint64_t tries = 0;
+    bool done = false;
+    int best = s->count + 1;
+
+    while(!done && tries < LS_MAX_TRIES) {
+        ls_restart(t);
+        tries++;
+
+        for(uint32_t flip = 0; ; flip++) {
+            if(t->viol_count < best) {
+                best = ls_report(t);
+            }
+
+            if(t->viol_count == 0 || flip == LS_MAX_FLIPS) {
+                break;
+            }
+
+            if(flip % LS_POLL_INTERVAL == 0) {
+                pthread_mutex_lock(&s->lock);
+                done = s->done;
+                best = s->best;
+                pthread_mutex_unlock(&s->lock);
+
+                if(done) {
+                    break;
+                }
+            }
+
+            ls_step(t);
+            flips++;
+        }
+
+        done = done || t->viol_count == 0;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    s->flips += flips;
+    s->tries += tries;
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+
+/* Search for a row closing as few cliques as possible using the given number
+   of threads. The best row found is stored in result */
+void ls_search(const Ext_clique* cliques, int count, int order, int threads,
+               uint64_t seed, Ls_result* result) {
+    Ls_shared s;
+    Ls_thread* workers;
+    int i, v;
+
+    s.cliques = cliques;
+    s.count = count;
+    s.order = order;
+    s.best = count + 1;
+    s.best_row = 0;
+    s.done = false;
+    s.flips = 0;
+    s.tries = 0;
+    pthread_mutex_init(&s.lock, NULL);
+
+    /* Build the vertex to clique index, sized by the cliques' vertices */
+    for(v = 0; v <= order; v++) {
+        s.occ_start[v] = 0;
+    }
+    for(i = 0; i < count; i++) {
+        for(uint64_t m = cliques[i].mask; m; m &= m - 1) {
+            s.occ_start[__builtin_ctzll(m) + 1]++;
+        }
+    }
+    for(v = 0; v < order; v++) {
+        s.occ_start[v + 1] += s.occ_start[v];
+    }
+
+    s.occ = malloc(sizeof(int) * (s.occ_start[order] + 1));
+    workers = malloc(sizeof(Ls_thread) * threads);
+    if(s.occ == NULL || workers == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < count; i++) {
+        for(uint64_t m = cliques[i].mask; m; m &= m - 1) {
+            v = __builtin_ctzll(m);
+            s.occ[s.occ_start[v]++] = i;
+        }
+    }
+    for(v = order; v > 0; v--) {
+        s.occ_start[v] = s.occ_start[v - 1];
+    }
+    s.occ_start[0] = 0;
+
+    for(i = 0; i < threads; i++) {
+        Ls_thread* t = &workers[i];
+
+        t->shared = &s;
+        t->rng = seed + 0x9e3779b97f4a7c15ULL * (i + 1);
+        if(t->rng == 0) {
+            t->rng = 1;
+        }
+
+        t->true_count = malloc(sizeof(uint8_t) * (count + 1));
+        t->viol = malloc(sizeof(int) * (count + 1));
+        t->viol_pos = malloc(sizeof(int) * (count + 1));
+        if(t->true_count == NULL || t->viol == NULL || t->viol_pos == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+
+        if(pthread_create(&t->thread, NULL, ls_worker, t) != 0) {
+            perror("Could not start search thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        free(workers[i].true_count);
+        free(workers[i].viol);
+        free(workers[i].viol_pos);
+    }
+
+    result->row = s.best_row;
+    result->violations = s.best;
+    result->flips = s.flips;
+    result->tries = s.tries;
+
+    pthread_mutex_destroy(&s.lock);
+    free(workers);
+    free(s.occ);
+}
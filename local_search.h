@@ -0,0 +1,37 @@
+/**
+ * WalkSAT-style stochastic local search for a new row which closes as few of
+ * an instance's cliques as possible. Each thread runs independent tries from
+ * random rows, keeping per-vertex break counts up to date as bits are flipped.
+ * The search stops as soon as any thread reaches zero violations.
+ */
+
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include <stdint.h>
+
+#include "extension.h"
+
+/* Flips made from a random row before restarting */
+#define LS_MAX_FLIPS 100000
+
+/* Restarts made by each thread before giving up */
+#define LS_MAX_TRIES 10
+
+/* Probability (per mille) of a random walk move when no free flip exists */
+#define LS_NOISE 200
+
+typedef struct {
+    /* Best row found and the number of cliques it closes */
+    uint64_t row;
+    int violations;
+
+    /* Work done over all threads */
+    uint64_t flips;
+    uint64_t tries;
+} Ls_result;
+
+void ls_search(const Ext_clique* cliques, int count, int order, int threads,
+               uint64_t seed, Ls_result* result);
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * File: profile.c
+ *
+ * Purpose: Clique profile of a coloring. For each color it reports the clique
+ *  number, found by bitset branch and bound with greedy coloring bounds, and
+ *  the number of monochromatic K_3 up to K_omega, counted in a single pass.
+ *
+ *  It also runs the sanity check done on every candidate R(s, t) coloring:
+ *  in a red/blue coloring with no red K_s and no blue K_t, the red neighbors
+ *  of a vertex have no red K_{s-1} and no blue K_t, i.e. they form an
+ *  R(s - 1, t) coloring, and likewise the blue neighbors form an R(s, t - 1)
+ *  coloring. Every vertex failing this is listed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+/* Default graph */
+#define ADJ_MATRIX_FILE "g55.42"
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static int clique_size[2] = { 5, 5 };
+static const char* color_name[2] = { "Red", "Blue" };
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-c s,t] [-v] [graph]\n"
+            "  -c  clique sizes s,t to check against (default 5,5)\n"
+            "  -v  print the neighborhood check of every vertex\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char** argv) {
+    const char* path = ADJ_MATRIX_FILE;
+    struct timespec start;
+    uint64_t counts[GRAPH_MAX_ORDER + 1];
+    uint64_t all;
+    bool verbose = false;
+    int omega[2];
+    int failed = 0;
+    Graph g;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:v")) != -1) {
+        switch(opt) {
+        case 'c':
+            if(sscanf(optarg, "%d,%d", &clique_size[0], &clique_size[1]) != 2 ||
+               clique_size[0] < 3 || clique_size[1] < 3) {
+                usage(argv[0]);
+            }
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind > 1) {
+        usage(argv[0]);
+    }
+    if(argc - optind == 1) {
+        path = argv[optind];
+    }
+
+    graph_load(&g, path);
+    all = graph_all(g.order);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    printf("Order %d\n", g.order);
+    for(color cc = 0; cc < 2; cc++) {
+        uint64_t edges = 0;
+
+        for(int v = 0; v < g.order; v++) {
+            edges += __builtin_popcountll(g.nbr[cc][v]);
+        }
+
+        omega[cc] = graph_clique_number(&g, cc, all);
+        graph_clique_counts(&g, cc, all, counts);
+
+        printf("%-4s %llu edges, clique number %d:", color_name[cc],
+               (unsigned long long)(edges / 2), omega[cc]);
+        for(int k = 3; k <= omega[cc]; k++) {
+            printf(" K%d %llu", k, (unsigned long long) counts[k]);
+        }
+        printf("\n");
+    }
+
+    /* Red neighborhoods must avoid red K_{s-1} and blue K_t, blue ones red
+       K_s and blue K_{t-1} */
+    printf("Neighborhoods: red must be R(%d, %d), blue R(%d, %d)\n",
+           clique_size[0] - 1, clique_size[1], clique_size[0], clique_size[1] - 1);
+    for(int v = 0; v < g.order; v++) {
+        int red[2], blue[2];
+        bool ok;
+
+        for(color cc = 0; cc < 2; cc++) {
+            red[cc] = graph_clique_number(&g, cc, g.nbr[0][v]);
+            blue[cc] = graph_clique_number(&g, cc, g.nbr[1][v]);
+        }
+
+        ok = red[0] < clique_size[0] - 1 && red[1] < clique_size[1] &&
+             blue[0] < clique_size[0] && blue[1] < clique_size[1] - 1;
+        failed += !ok;
+
+        if(verbose || !ok) {
+            printf("  Vertex %2d: red degree %2d (clique numbers %d/%d), "
+                   "blue degree %2d (clique numbers %d/%d)%s\n", v,
+                   __builtin_popcountll(g.nbr[0][v]), red[0], red[1],
+                   __builtin_popcountll(g.nbr[1][v]), blue[0], blue[1],
+                   ok ? "" : " FAIL");
+        }
+    }
+
+    if(omega[0] < clique_size[0] && omega[1] < clique_size[1] && failed == 0) {
+        printf("Valid R(%d, %d) coloring, all neighborhoods pass (%.3fs)\n",
+               clique_size[0], clique_size[1], elapsed(&start));
+    } else {
+        printf("Not an R(%d, %d) coloring: %d of %d neighborhoods fail (%.3fs)\n",
+               clique_size[0], clique_size[1], failed, g.order, elapsed(&start));
+    }
+
+    return failed == 0 && omega[0] < clique_size[0] && omega[1] < clique_size[1] ?
+           EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,573 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ramsey.h"
+
+/* Allocate an order by order matrix, every entry 0 */
+static color** matrix_alloc(int order) {
+    color** matrix = malloc(sizeof(color*) * (order + 1));
+    color* flat = calloc((size_t) order * order + 1, sizeof(color));
+
+    if(matrix == NULL || flat == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < order; i++) {
+        matrix[i] = flat + (i * order);
+    }
+    matrix[order] = flat;
+
+    return matrix;
+}
+
+static void matrix_free(color** matrix, int order) {
+    if(matrix != NULL) {
+        free(matrix[order]);
+        free(matrix);
+    }
+}
+
+/* Make the matrix order by order, keeping its memory if the order is
+   unchanged. Whatever was derived from the old matrix is dropped */
+static void matrix_resize(Ramsey_ctx* ctx, int order) {
+    if(ctx->matrix == NULL || ctx->order != order) {
+        matrix_free(ctx->matrix, ctx->order);
+        free(ctx->row);
+        ctx->matrix = matrix_alloc(order);
+        ctx->row = malloc(sizeof(color) * (order + 1));
+        if(ctx->row == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+        ctx->order = order;
+    }
+
+    if(ctx->cliques != NULL) {
+        free(ctx->cliques[0]);
+        free(ctx->cliques);
+    }
+    ctx->cliques = NULL;
+    ctx->clique_count = 0;
+    ctx->perm_filtering = ctx->perm_ready = false;
+}
+
+/* Increment the given clique, with clique[size] one past the last vertex */
+static inline bool next_n_clique(uint16_t* clique, uint16_t size) {
+    int i, j;
+
+    /* Think about order bins with size markers. We move the right most
+       marker by one to the right which can be moved without change the
+       relative order of the markers or causing a marker to leave the last
+       bin. When a marker is moved, all the markers to its right are moved into
+       the bins to its immediate right */
+
+    for(i = size - 1; i >= 0; i--) {
+        /* We found a marker we can move */
+        if(clique[i] < clique[i + 1] - 1) {
+            /* Move the marker */
+            clique[i]++;
+
+            /* Move all markers further right to be after the one we just
+               moved */
+            for(j = i + 1; j < size; j++) {
+                clique[j] = clique[j - 1] + 1;
+            }
+
+            /* The clique has changed, return true */
+            return true;
+        }
+    }
+
+    /* Nothing could be moved (last combination) */
+    return false;
+}
+
+/* Is the given n-clique monochromatic in matrix */
+static inline bool is_n_monochromatic(const uint16_t* clique, int n, color** matrix) {
+    color cc = matrix[clique[0]][clique[1]];
+    color* row;
+    int i, j;
+
+    for(i = 0; i < n; i++) {
+        row = matrix[clique[i]];
+        for(j = i + 1; j < n; j++) {
+            if(row[clique[j]] ^ cc) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Construct the next permutation of the edges of the new node. This only
+   permutes the row values of the new node (i.e. the column value shouldn't be
+   used). This is an optimization. The position in the filtered list is
+   passed by the caller, so the search keeps it in a register
+
+   O(n), n = order of the matrix
+ */
+static inline bool next_graph(const Ramsey_ctx* ctx, color* row, uint32_t** filtered) {
+    const int width = ctx->perm_width;
+    uint32_t p;
+    int i;
+
+    if(*filtered == ctx->perm_filtered_end) {
+        i = width;
+
+        while(row[i] && i != ctx->order) {
+            row[i] = 0;
+            i++;
+        }
+
+        if(i == ctx->order) {
+            return false;
+        }
+
+        row[i] = 1;
+        *filtered = ctx->perm_filtered_start;
+    }
+
+    p = **filtered;
+    (*filtered)++;
+
+    for(i = 0; i < width; i++) {
+        row[i] = (p >> i) & 1;
+    }
+
+    return true;
+}
+
+/* Check if a potential n-clique is monotone. The clique's base is
+   monochromatic in its color, so only the edges to the new vertex are
+   checked
+
+   Worse case O(n), n = clique_n
+*/
+static inline bool is_monochromatic(const color* row, const uint16_t* clique, int n) {
+    color cc = (color) clique[n];
+
+    for(int i = 0; i < n - 1; i++) {
+        if(row[clique[i]] ^ cc) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static inline void perm_remove(Ramsey_ctx* ctx, Ramsey_perm* p) {
+    if(p->prev) {
+        p->prev->next = p->next;
+    } else {
+        ctx->perm_head = p->next;
+    }
+
+    if(p->next) {
+        p->next->prev = p->prev;
+    }
+
+    p->next = p->prev = NULL;
+    ctx->perm_count--;
+}
+
+static inline Ramsey_perm* perm_next_with_mask(Ramsey_perm* p, uint32_t mask, color cc) {
+    uint32_t x_mask = mask;
+
+    if(cc) {
+        x_mask = 0;
+    }
+
+    p = p->next;
+    while(p && ((p->perm ^ x_mask) & mask) != mask) {
+        p = p->next;
+    }
+
+    return p;
+}
+
+/* Remove the permutations closing the clique, if it lies in the low bits */
+static bool perm_mask(Ramsey_ctx* ctx, const uint16_t* clique) {
+    color cc = (color) clique[ctx->clique_n];
+    uint32_t mask = 0;
+    uint32_t x_mask = 0;
+    Ramsey_perm* p;
+    Ramsey_perm* pp;
+
+    for(int i = 0; i < ctx->clique_n - 1; i++) {
+        if(clique[i] >= ctx->perm_width) {
+            return false;
+        }
+
+        mask |= (((uint32_t)1) << clique[i]);
+    }
+
+    if(!cc) {
+        x_mask = mask;
+    }
+
+    p = ctx->perm_head;
+
+    if(p == NULL) {
+        return false;
+    }
+
+    if(((p->perm ^ x_mask) & mask) != mask) {
+        p = perm_next_with_mask(p, mask, cc);
+    }
+
+    while(p) {
+        if(p->next || p->prev || p == ctx->perm_head) {
+            pp = p->next;
+            perm_remove(ctx, p);
+            p = pp;
+        }
+
+        if(p && ((p->perm ^ x_mask) & mask) != mask) {
+            p = perm_next_with_mask(p, mask, cc);
+        }
+    }
+
+    return true;
+}
+
+static void perm_regroup(Ramsey_ctx* ctx) {
+    Ramsey_perm* p = ctx->perm_head;
+    uint32_t j = 0;
+
+    while(p) {
+        memcpy(ctx->perm_block + j, p, sizeof(Ramsey_perm));
+
+        if(ctx->perm_block[j].next) {
+            ctx->perm_block[j].next->prev = &ctx->perm_block[j];
+        }
+        if(ctx->perm_block[j].prev) {
+            ctx->perm_block[j].prev->next = &ctx->perm_block[j];
+        } else {
+            ctx->perm_head = &ctx->perm_block[j];
+        }
+
+        p = ctx->perm_block[j].next;
+        j++;
+    }
+}
+
+static void perm_build_static_list(Ramsey_ctx* ctx) {
+    Ramsey_perm* p = ctx->perm_head;
+    uint32_t i = 0;
+
+    free(ctx->perm_filtered_start);
+    ctx->perm_filtered = malloc((ctx->perm_count + 1) * sizeof(uint32_t));
+    if(ctx->perm_filtered == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    while(p) {
+        ctx->perm_filtered[i] = p->perm;
+        p = p->next;
+        i++;
+    }
+
+    ctx->perm_filtered_start = ctx->perm_filtered;
+    ctx->perm_filtered_end = ctx->perm_filtered + ctx->perm_count;
+}
+
+void ramsey_init(Ramsey_ctx* ctx, int clique_n, int perm_bits) {
+    memset(ctx, 0, sizeof(Ramsey_ctx));
+    ctx->clique_n = clique_n;
+    ctx->perm_bits = perm_bits;
+}
+
+void ramsey_free(Ramsey_ctx* ctx) {
+    free(ctx->perm_block);
+    free(ctx->perm_filtered_start);
+    matrix_free(ctx->matrix, ctx->order);
+    free(ctx->row);
+    if(ctx->cliques != NULL) {
+        free(ctx->cliques[0]);
+        free(ctx->cliques);
+    }
+    ramsey_init(ctx, ctx->clique_n, ctx->perm_bits);
+}
+
+void ramsey_load(Ramsey_ctx* ctx, const char* path, int order) {
+    FILE* f;
+    color* adj_flat;
+    int c, i;
+
+    matrix_resize(ctx, order);
+    adj_flat = ctx->matrix[order];
+
+    f = fopen(path, "r");
+    if(f == NULL) {
+        perror("Could not open adjacency matrix");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Populate adjacency matrix from file */
+    c = 0;
+    i = 0;
+    while(c != EOF) {
+        c = fgetc(f);
+        if(i < order * order) {
+            if(c == '0') {
+                adj_flat[i++] = 0;
+            } else if(c == '1') {
+                adj_flat[i++] = 1;
+            }
+        } else if(c == '0' || c == '1') {
+            i++;
+            break;
+        }
+    }
+
+    /* If we exit the loop and haven't read the correct number of values
+       "something bad" has happened */
+    if(c != EOF || i != (order * order)) {
+        fprintf(stderr, "Error: invalid matrix size\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fclose(f);
+}
+
+void ramsey_from_graph(Ramsey_ctx* ctx, const Graph* g) {
+    matrix_resize(ctx, g->order);
+
+    for(int u = 0; u < g->order; u++) {
+        for(int v = 0; v < g->order; v++) {
+            ctx->matrix[u][v] = u != v && graph_color(g, u, v);
+        }
+    }
+}
+
+/* Scan the n-subsets of the matrix in lexicographic order for monochromatic
+   cliques, collecting them in cliques, or stopping at the first one if it is
+   NULL. Returns the number found */
+static inline int scan_cliques(const Ramsey_ctx* ctx, int n, uint16_t*** cliques) {
+    uint16_t current_clique[n + 1];
+    int found = 0, size = 0;
+    int i;
+
+    if(n > ctx->order) {
+        return 0;
+    }
+
+    current_clique[n] = ctx->order;
+    for(i = 0; i < n; i++) {
+        current_clique[i] = i;
+    }
+
+    do {
+        if(is_n_monochromatic(current_clique, n, ctx->matrix)) {
+            if(cliques == NULL) {
+                return 1;
+            }
+            if(found == size) {
+                size = size ? 2 * size : 64;
+                *cliques = realloc(*cliques, sizeof(uint16_t*) * size);
+                if(*cliques == NULL) {
+                    perror("Could not alloc");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (*cliques)[found] = malloc(sizeof(uint16_t) * n);
+            if((*cliques)[found] == NULL) {
+                perror("Could not alloc");
+                exit(EXIT_FAILURE);
+            }
+            memcpy((*cliques)[found], current_clique, sizeof(uint16_t) * n);
+            found++;
+        }
+    } while(next_n_clique(current_clique, n));
+
+    return found;
+}
+
+/* The scan with the clique size a constant for the sizes searched in
+   practice, so the clique loops are unrolled */
+static int scan_cliques_n(const Ramsey_ctx* ctx, int n, uint16_t*** cliques) {
+    switch(n) {
+    case 3:
+        return scan_cliques(ctx, 3, cliques);
+    case 4:
+        return scan_cliques(ctx, 4, cliques);
+    case 5:
+        return scan_cliques(ctx, 5, cliques);
+    default:
+        return scan_cliques(ctx, n, cliques);
+    }
+}
+
+uint16_t** ramsey_enumerate(const Ramsey_ctx* ctx, int n, int* count) {
+    uint16_t** cliques = NULL;
+
+    *count = scan_cliques_n(ctx, n, &cliques);
+
+    return cliques;
+}
+
+void ramsey_free_cliques(uint16_t** cliques, int count) {
+    for(int i = 0; i < count; i++) {
+        free(cliques[i]);
+    }
+    free(cliques);
+}
+
+bool ramsey_verify(const Ramsey_ctx* ctx) {
+    return scan_cliques_n(ctx, ctx->clique_n, NULL) == 0;
+}
+
+void ramsey_prepare(Ramsey_ctx* ctx) {
+    int n = ctx->clique_n;
+    uint16_t** base;
+    int count;
+
+    if(ctx->cliques != NULL) {
+        free(ctx->cliques[0]);
+        free(ctx->cliques);
+    }
+
+    /* Any monochromatic clique through the new vertex has one of these as
+       the rest of its vertices */
+    base = ramsey_enumerate(ctx, n - 1, &count);
+
+    ctx->cliques = malloc(sizeof(uint16_t*) * (count + 1));
+    if(ctx->cliques == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    ctx->cliques[0] = malloc(sizeof(uint16_t) * (n + 1) * (count + 1));
+    if(ctx->cliques[0] == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < count; i++) {
+        ctx->cliques[i] = ctx->cliques[0] + (i * (n + 1));
+        memcpy(ctx->cliques[i], base[i], sizeof(uint16_t) * (n - 1));
+        ctx->cliques[i][n - 1] = ctx->order;
+
+        /* Store the color of the clique as well */
+        ctx->cliques[i][n] = ctx->matrix[base[i][0]][base[i][1]];
+    }
+    ctx->clique_count = count;
+    ctx->perm_filtering = ctx->perm_ready = false;
+
+    ramsey_free_cliques(base, count);
+}
+
+void ramsey_filter_init(Ramsey_ctx* ctx) {
+    uint32_t size;
+
+    /* The filter covers at most the whole of the new row */
+    ctx->perm_width = ctx->perm_bits < ctx->order ? ctx->perm_bits : ctx->order;
+    size = ((uint32_t)1) << ctx->perm_width;
+
+    if(size > ctx->perm_size) {
+        free(ctx->perm_block);
+        ctx->perm_block = malloc(sizeof(Ramsey_perm) * size);
+        if(ctx->perm_block == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+        ctx->perm_size = size;
+    }
+
+    for(uint32_t i = 0; i < size; i++) {
+        ctx->perm_block[i].perm = i;
+        ctx->perm_block[i].next = i + 1 < size ? &ctx->perm_block[i + 1] : NULL;
+        ctx->perm_block[i].prev = i > 0 ? &ctx->perm_block[i - 1] : NULL;
+    }
+
+    ctx->perm_head = ctx->perm_block;
+    ctx->perm_count = size;
+    ctx->perm_filtering = true;
+    ctx->perm_ready = false;
+}
+
+void ramsey_filter_pass(Ramsey_ctx* ctx, int pass, int passes) {
+    for(int j = pass; j < ctx->clique_count; j += passes) {
+        perm_mask(ctx, ctx->cliques[j]);
+    }
+
+    perm_regroup(ctx);
+}
+
+void ramsey_filter(Ramsey_ctx* ctx) {
+    if(ctx->cliques == NULL) {
+        ramsey_prepare(ctx);
+    }
+    if(!ctx->perm_filtering && !ctx->perm_ready) {
+        ramsey_filter_init(ctx);
+        for(int i = 0; i < RAMSEY_FILTER_PASSES; i++) {
+            ramsey_filter_pass(ctx, i, RAMSEY_FILTER_PASSES);
+        }
+    }
+
+    /* Build the static list of permutations, kept for the next search */
+    if(!ctx->perm_ready) {
+        perm_build_static_list(ctx);
+        ctx->perm_filtering = false;
+        ctx->perm_ready = true;
+    }
+}
+
+/* Search the rows of the new vertex for one closing none of the potential
+   n-cliques. The row, the cliques and their count are held in locals, as
+   stores to the row could otherwise alias the context */
+static inline bool extend_search(Ramsey_ctx* ctx, int n) {
+    color* row = ctx->row;
+    uint16_t** cliques = ctx->cliques;
+    const int count = ctx->clique_count;
+    uint32_t* filtered = ctx->perm_filtered_start;
+    int i;
+
+    while(next_graph(ctx, row, &filtered)) {
+        i = 0;
+        while(i < count && !is_monochromatic(row, cliques[i], n)) {
+            i++;
+        }
+
+        /* Successfully found a graph with 0 monochromatic cliques */
+        if(i == count) {
+            ctx->perm_filtered = filtered;
+            return true;
+        }
+    }
+
+    ctx->perm_filtered = filtered;
+    return false;
+}
+
+/* The search with the clique size a constant for the sizes searched in
+   practice, as scan_cliques_n() does */
+static bool extend_search_n(Ramsey_ctx* ctx, int n) {
+    switch(n) {
+    case 3:
+        return extend_search(ctx, 3);
+    case 4:
+        return extend_search(ctx, 4);
+    case 5:
+        return extend_search(ctx, 5);
+    default:
+        return extend_search(ctx, n);
+    }
+}
+
+bool ramsey_extend(Ramsey_ctx* ctx) {
+    ramsey_filter(ctx);
+
+    /* With every permutation filtered out there is no row to find */
+    if(ctx->perm_count == 0) {
+        return false;
+    }
+
+    memset(ctx->row, 0, sizeof(color) * (ctx->order + 1));
+
+    return extend_search_n(ctx, ctx->clique_n);
+}
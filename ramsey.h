@@ -0,0 +1,114 @@
+/**
+ * The color matrix engine behind find_cliques and extend_graph: loading a
+ * matrix, enumerating and checking its monochromatic cliques, and the
+ * permutation search for a one-vertex extension. All state, including the
+ * permutation filter, lives in a Ramsey_ctx, so any number of searches can
+ * run in one process, each on its own thread.
+ *
+ * The extension search enumerates the rows of the new vertex in two parts.
+ * The low perm_bits entries come from the permutation filter, a list of
+ * every value from which the patterns closing a monochromatic clique within
+ * those vertices have been removed; the high entries are counted through
+ * every value. Each row is then checked against the potential cliques.
+ */
+
+#ifndef RAMSEY_H
+#define RAMSEY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "graph.h"
+
+/* Default size in bits of the permutation space held in memory (at most
+   31), and the number of passes filtering it */
+#define RAMSEY_PERM_BITS 26
+#define RAMSEY_FILTER_PASSES 32
+
+struct Ramsey_perm_s {
+    uint32_t perm;
+    struct Ramsey_perm_s* prev;
+    struct Ramsey_perm_s* next;
+    uint32_t __pad;
+};
+typedef struct Ramsey_perm_s Ramsey_perm;
+
+typedef struct {
+    /* Size of the monochromatic cliques avoided */
+    int clique_n;
+
+    /* The coloring, order rows of order entries */
+    color** matrix;
+    int order;
+
+    /* Potential cliques of the extension: the vertices of a monochromatic
+       (clique_n - 1)-clique and the new vertex, followed by the color */
+    uint16_t** cliques;
+    int clique_count;
+
+    /* Permutation filter over the low perm_width entries of the new row, at
+       most perm_bits. The block is scratch space for filtering, of
+       perm_size entries, and is reused for the next graph. The filtered
+       list is kept until the potential cliques change, so searching the
+       same graph again skips the filter */
+    int perm_bits;
+    int perm_width;
+    bool perm_filtering;
+    bool perm_ready;
+    Ramsey_perm* perm_block;
+    Ramsey_perm* perm_head;
+    uint32_t perm_size;
+    uint32_t perm_count;
+    uint32_t* perm_filtered;
+    uint32_t* perm_filtered_start;
+    uint32_t* perm_filtered_end;
+
+    /* Row of the new vertex, order + 1 entries with the new vertex last,
+       holding the extension found */
+    color* row;
+} Ramsey_ctx;
+
+void ramsey_init(Ramsey_ctx* ctx, int clique_n, int perm_bits);
+void ramsey_free(Ramsey_ctx* ctx);
+
+/* Load the order by order matrix at path. Exits if it cannot be read or has
+   any other size */
+void ramsey_load(Ramsey_ctx* ctx, const char* path, int order);
+void ramsey_from_graph(Ramsey_ctx* ctx, const Graph* g);
+
+/* The monochromatic n-cliques of the matrix in lexicographic order, each n
+   vertices. The number found is stored in count */
+uint16_t** ramsey_enumerate(const Ramsey_ctx* ctx, int n, int* count);
+void ramsey_free_cliques(uint16_t** cliques, int count);
+
+/* Is the matrix free of monochromatic clique_n-cliques */
+bool ramsey_verify(const Ramsey_ctx* ctx);
+
+/* Find the potential cliques of the extension. clique_n may be changed
+   before preparing again */
+void ramsey_prepare(Ramsey_ctx* ctx);
+
+/* Build the permutation filter, then remove the patterns of one in every
+   passes potential cliques, starting with the pass-th, and compact it */
+void ramsey_filter_init(Ramsey_ctx* ctx);
+void ramsey_filter_pass(Ramsey_ctx* ctx, int pass, int passes);
+
+/* Prepare, filter and list the filtered permutations, whichever has not
+   been done since the potential cliques changed */
+void ramsey_filter(Ramsey_ctx* ctx);
+
+/* Search for a row of a new vertex closing no potential clique, preparing
+   and filtering first if that has not been done. Returns true with the row
+   in row, or false with the search exhausted. The matrix is unchanged */
+bool ramsey_extend(Ramsey_ctx* ctx);
+
+/* The same search split into a pipeline of threads: one generates the
+   candidate rows from the filtered permutations, screeners drop those
+   closing one of the most constraining potential cliques, and checkers test
+   the survivors against the rest. The stages pass batches of rows through
+   lock-free ring buffers, and with pin each thread is bound to a core.
+   Any row found may be returned, not only the first. Matrices of more than
+   64 vertices are searched by ramsey_extend */
+bool ramsey_extend_pipeline(Ramsey_ctx* ctx, int screeners, int checkers, bool pin);
+
+#endif
@@ -0,0 +1,448 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "extension.h"
+#include "ramsey.h"
+
+/* Candidate rows per batch, and batches in flight between the stages (a
+   power of two) */
+#define PIPE_BATCH 1024
+#define PIPE_BATCHES 64
+
+/* Potential cliques checked by the screeners, and the candidate rows sampled
+   to rank the cliques by how many rows each rejects */
+#define PIPE_SCREEN_CLIQUES 32
+#define PIPE_SCREEN_SAMPLES 4096
+
+/* Keeps the ring indices on their own cache lines */
+#define PIPE_CACHE_LINE 64
+
+typedef struct {
+    int count;
+    uint64_t rows[PIPE_BATCH];
+} Pipe_batch;
+
+typedef struct {
+    uint64_t seq;
+    Pipe_batch* batch;
+} Ring_cell;
+
+/* Bounded lock-free ring, any number of producers and consumers. Each cell
+   carries a sequence number telling whether it is ready to be written or
+   read at the current lap, so a push or pop is a single compare and swap on
+   its index */
+typedef struct {
+    Ring_cell* cells;
+    uint64_t mask;
+    char __pad0[PIPE_CACHE_LINE];
+    uint64_t head;
+    char __pad1[PIPE_CACHE_LINE];
+    uint64_t tail;
+    char __pad2[PIPE_CACHE_LINE];
+} Ring;
+
+/* State shared between the stages */
+typedef struct {
+    Ramsey_ctx* ctx;
+    int screeners;
+    int checkers;
+    bool pin;
+    int cpus;
+
+    /* The most constraining potential cliques, then the rest */
+    Ext_clique* cliques;
+    int screen_count;
+    int clique_count;
+
+    /* Empty batches, batches of candidates for the screeners, and batches of
+       survivors for the checkers. A NULL batch tells a stage to finish */
+    Ring free;
+    Ring candidates;
+    Ring survivors;
+    Pipe_batch* batches;
+
+    int screeners_left;
+    int found;
+    uint64_t row;
+} Pipeline;
+
+typedef struct {
+    Pipeline* pipe;
+    pthread_t thread;
+    int id;
+} Pipe_thread;
+
+static void ring_init(Ring* r, uint64_t size) {
+    r->cells = malloc(sizeof(Ring_cell) * size);
+    if(r->cells == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(uint64_t i = 0; i < size; i++) {
+        r->cells[i].seq = i;
+        r->cells[i].batch = NULL;
+    }
+
+    r->mask = size - 1;
+    r->head = 0;
+    r->tail = 0;
+}
+
+static bool ring_try_push(Ring* r, Pipe_batch* batch) {
+    uint64_t pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+
+    while(true) {
+        Ring_cell* cell = &r->cells[pos & r->mask];
+        uint64_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t) (seq - pos);
+
+        if(diff == 0) {
+            if(__atomic_compare_exchange_n(&r->head, &pos, pos + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->batch = batch;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if(diff < 0) {
+            /* Full */
+            return false;
+        } else {
+            pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static bool ring_try_pop(Ring* r, Pipe_batch** batch) {
+    uint64_t pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+
+    while(true) {
+        Ring_cell* cell = &r->cells[pos & r->mask];
+        uint64_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t) (seq - (pos + 1));
+
+        if(diff == 0) {
+            if(__atomic_compare_exchange_n(&r->tail, &pos, pos + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *batch = cell->batch;
+                __atomic_store_n(&cell->seq, pos + r->mask + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if(diff < 0) {
+            /* Empty */
+            return false;
+        } else {
+            pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* A stage waiting on a neighbour gives up its core, as stages may share one */
+static void ring_push(Ring* r, Pipe_batch* batch) {
+    while(!ring_try_push(r, batch)) {
+        sched_yield();
+    }
+}
+
+static Pipe_batch* ring_pop(Ring* r) {
+    Pipe_batch* batch;
+
+    while(!ring_try_pop(r, &batch)) {
+        sched_yield();
+    }
+
+    return batch;
+}
+
+static bool pipe_found(Pipeline* pipe) {
+    return __atomic_load_n(&pipe->found, __ATOMIC_ACQUIRE);
+}
+
+/* Bind the calling thread to a core, the threads dealt round the cores */
+static void pipe_pin(Pipeline* pipe, int id) {
+#ifdef __linux__
+    cpu_set_t set;
+
+    if(!pipe->pin) {
+        return;
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(id % pipe->cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void) pipe;
+    (void) id;
+#endif
+}
+
+/* Stage 1: the filtered permutations under every value of the high entries,
+   in the order ramsey_extend searches them */
+static void* pipe_generate(void* arg) {
+    Pipe_thread* t = arg;
+    Pipeline* pipe = t->pipe;
+    Ramsey_ctx* ctx = pipe->ctx;
+    int width = ctx->perm_width;
+    uint64_t highs = (uint64_t) 1 << (ctx->order - width);
+    Pipe_batch* batch = NULL;
+
+    pipe_pin(pipe, t->id);
+
+    for(uint64_t high = 0; high < highs && !pipe_found(pipe); high++) {
+        for(const uint32_t* p = ctx->perm_filtered_start; p != ctx->perm_filtered_end; p++) {
+            if(batch == NULL) {
+                batch = ring_pop(&pipe->free);
+                batch->count = 0;
+            }
+
+            batch->rows[batch->count++] = (high << width) | *p;
+
+            if(batch->count == PIPE_BATCH) {
+                ring_push(&pipe->candidates, batch);
+                batch = NULL;
+
+                if(pipe_found(pipe)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if(batch != NULL) {
+        ring_push(&pipe->candidates, batch);
+    }
+
+    for(int i = 0; i < pipe->screeners; i++) {
+        ring_push(&pipe->candidates, NULL);
+    }
+
+    return NULL;
+}
+
+/* Stage 2: drop the rows closing one of the screened cliques, compacting the
+   survivors to the front of the batch */
+static void* pipe_screen(void* arg) {
+    Pipe_thread* t = arg;
+    Pipeline* pipe = t->pipe;
+    Pipe_batch* batch;
+
+    pipe_pin(pipe, t->id);
+
+    while((batch = ring_pop(&pipe->candidates)) != NULL) {
+        int kept = 0;
+
+        if(!pipe_found(pipe)) {
+            for(int i = 0; i < batch->count; i++) {
+                uint64_t row = batch->rows[i];
+                int j = 0;
+
+                while(j < pipe->screen_count && !ext_violated(&pipe->cliques[j], row)) {
+                    j++;
+                }
+
+                if(j == pipe->screen_count) {
+                    batch->rows[kept++] = row;
+                }
+            }
+        }
+
+        batch->count = kept;
+        ring_push(kept ? &pipe->survivors : &pipe->free, batch);
+    }
+
+    /* The last screener out tells the checkers to finish */
+    if(__atomic_sub_fetch(&pipe->screeners_left, 1, __ATOMIC_ACQ_REL) == 0) {
+        for(int i = 0; i < pipe->checkers; i++) {
+            ring_push(&pipe->survivors, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+/* Stage 3: check the survivors against the remaining cliques */
+static void* pipe_check(void* arg) {
+    Pipe_thread* t = arg;
+    Pipeline* pipe = t->pipe;
+    Pipe_batch* batch;
+
+    pipe_pin(pipe, t->id);
+
+    while((batch = ring_pop(&pipe->survivors)) != NULL) {
+        for(int i = 0; i < batch->count && !pipe_found(pipe); i++) {
+            uint64_t row = batch->rows[i];
+            int j = pipe->screen_count;
+
+            while(j < pipe->clique_count && !ext_violated(&pipe->cliques[j], row)) {
+                j++;
+            }
+
+            if(j == pipe->clique_count) {
+                int expected = 0;
+
+                if(__atomic_compare_exchange_n(&pipe->found, &expected, 1, false,
+                                               __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    pipe->row = row;
+                }
+            }
+        }
+
+        ring_push(&pipe->free, batch);
+    }
+
+    return NULL;
+}
+
+/* Potential cliques as masks of the new row, ordered with the ones rejecting
+   the most sampled candidates first */
+static Ext_clique* pipe_rank_cliques(const Ramsey_ctx* ctx) {
+    int count = ctx->clique_count;
+    Ext_clique* cliques = malloc(sizeof(Ext_clique) * (count + 1));
+    int* rejects = calloc(count + 1, sizeof(int));
+    uint64_t highs = (uint64_t) 1 << (ctx->order - ctx->perm_width);
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+
+    if(cliques == NULL || rejects == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < count; i++) {
+        const uint16_t* clique = ctx->cliques[i];
+
+        cliques[i].mask = 0;
+        for(int j = 0; j < ctx->clique_n - 1; j++) {
+            cliques[i].mask |= (uint64_t) 1 << clique[j];
+        }
+        cliques[i].cc = (color) clique[ctx->clique_n];
+    }
+
+    for(int s = 0; s < PIPE_SCREEN_SAMPLES; s++) {
+        uint64_t row;
+
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        row = ((rng >> 32) % highs) << ctx->perm_width;
+        row |= ctx->perm_filtered_start[(rng & 0xffffffff) % ctx->perm_count];
+
+        for(int i = 0; i < count; i++) {
+            rejects[i] += ext_violated(&cliques[i], row);
+        }
+    }
+
+    /* Selection of the top PIPE_SCREEN_CLIQUES, the rest keep their order */
+    for(int i = 0; i < count && i < PIPE_SCREEN_CLIQUES; i++) {
+        int best = i;
+
+        for(int j = i + 1; j < count; j++) {
+            if(rejects[j] > rejects[best]) {
+                best = j;
+            }
+        }
+
+        Ext_clique c = cliques[i];
+        int r = rejects[i];
+
+        cliques[i] = cliques[best];
+        rejects[i] = rejects[best];
+        cliques[best] = c;
+        rejects[best] = r;
+    }
+
+    free(rejects);
+    return cliques;
+}
+
+bool ramsey_extend_pipeline(Ramsey_ctx* ctx, int screeners, int checkers, bool pin) {
+    Pipeline pipe;
+    Pipe_thread* threads;
+    int thread_count = 1 + screeners + checkers;
+    uint64_t ring_size = 1;
+    int i;
+
+    if(ctx->order > EXT_MAX_ORDER || screeners < 1 || checkers < 1) {
+        return ramsey_extend(ctx);
+    }
+
+    ramsey_filter(ctx);
+
+    if(ctx->perm_count == 0) {
+        return false;
+    }
+
+    pipe.ctx = ctx;
+    pipe.screeners = screeners;
+    pipe.checkers = checkers;
+    pipe.pin = pin;
+    pipe.cpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if(pipe.cpus < 1) {
+        pipe.cpus = 1;
+    }
+
+    pipe.cliques = pipe_rank_cliques(ctx);
+    pipe.clique_count = ctx->clique_count;
+    pipe.screen_count = pipe.clique_count < PIPE_SCREEN_CLIQUES ? pipe.clique_count
+                                                                : PIPE_SCREEN_CLIQUES;
+
+    /* Room for every batch and the finishing NULLs in each ring */
+    while(ring_size < (uint64_t) (PIPE_BATCHES + screeners + checkers)) {
+        ring_size *= 2;
+    }
+    ring_init(&pipe.free, ring_size);
+    ring_init(&pipe.candidates, ring_size);
+    ring_init(&pipe.survivors, ring_size);
+
+    pipe.batches = malloc(sizeof(Pipe_batch) * PIPE_BATCHES);
+    threads = malloc(sizeof(Pipe_thread) * thread_count);
+    if(pipe.batches == NULL || threads == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(i = 0; i < PIPE_BATCHES; i++) {
+        ring_push(&pipe.free, &pipe.batches[i]);
+    }
+
+    pipe.screeners_left = screeners;
+    pipe.found = 0;
+    pipe.row = 0;
+
+    for(i = 0; i < thread_count; i++) {
+        void* (*stage)(void*) = i == 0 ? pipe_generate
+                              : i <= screeners ? pipe_screen
+                              : pipe_check;
+
+        threads[i].pipe = &pipe;
+        threads[i].id = i;
+        if(pthread_create(&threads[i].thread, NULL, stage, &threads[i]) != 0) {
+            perror("Could not start pipeline thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(i = 0; i < thread_count; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+
+    if(pipe.found) {
+        for(i = 0; i < ctx->order; i++) {
+            ctx->row[i] = (pipe.row >> i) & 1;
+        }
+        ctx->row[ctx->order] = 0;
+    }
+
+    free(pipe.cliques);
+    free(pipe.batches);
+    free(pipe.free.cells);
+    free(pipe.candidates.cells);
+    free(pipe.survivors.cells);
+    free(threads);
+
+    return pipe.found;
+}
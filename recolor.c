@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "recolor.h"
+#include "sat.h"
+
+/* Search state */
+typedef struct {
+    const Graph* base;
+    int order;
+    int max_flips;
+    Sat* sat;
+
+    /* First flip and counter variables; edge uv, u < v, has flip variable
+       flip_var + its index among the base edges */
+    int flip_var;
+    int counter_var;
+    int edges;
+
+    /* The base graph with the current flips and row applied, and its flipped
+       edges */
+    Graph g;
+    int flipped[RECOLOR_MAX_FLIPS][2];
+    int flips;
+
+    /* Flipped edge the cliques being visited go through, or -1 for the new
+       vertex */
+    int through;
+    int found;
+
+    uint64_t rounds;
+    uint64_t clauses;
+} Recolor;
+
+static inline int recolor_edge_var(const Recolor* r, int u, int v) {
+    return r->flip_var + u * (2 * r->order - u - 1) / 2 + (v - u - 1);
+}
+
+/* Counter variable set when at least j + 1 of the first i + 1 flip variables
+   are set */
+static inline int recolor_counter_var(const Recolor* r, int i, int j) {
+    return r->counter_var + i * (r->max_flips + 1) + j;
+}
+
+/* Sequential counter over the flip variables, up to max_flips + 1. Only the
+   upward implications are needed to bound the count from above */
+static void recolor_add_counter(Recolor* r) {
+    int lits[3];
+
+    for(int i = 0; i < r->edges; i++) {
+        int f = r->flip_var + i;
+
+        lits[0] = -f;
+        lits[1] = recolor_counter_var(r, i, 0);
+        sat_add_clause(r->sat, lits, 2);
+
+        if(i == 0) {
+            continue;
+        }
+
+        for(int j = 0; j <= r->max_flips; j++) {
+            lits[0] = -recolor_counter_var(r, i - 1, j);
+            lits[1] = recolor_counter_var(r, i, j);
+            sat_add_clause(r->sat, lits, 2);
+
+            if(j > 0) {
+                lits[0] = -f;
+                lits[1] = -recolor_counter_var(r, i - 1, j - 1);
+                lits[2] = recolor_counter_var(r, i, j);
+                sat_add_clause(r->sat, lits, 3);
+            }
+        }
+    }
+}
+
+/* Forbid the monochromatic clique: one of its edges to the new vertex must
+   take the other color, or one of its base edges must end up the other
+   color, which is a flip for the edges of color cc in the base graph and no
+   flip for the others */
+static void recolor_forbid(Recolor* r, const int* clique, int k, color cc) {
+    int lits[GRAPH_MAX_ORDER * (GRAPH_MAX_ORDER - 1) / 2];
+    int n = 0;
+
+    for(int a = 0; a < k; a++) {
+        for(int b = a + 1; b < k; b++) {
+            int u = clique[a] < clique[b] ? clique[a] : clique[b];
+            int v = clique[a] < clique[b] ? clique[b] : clique[a];
+
+            if(v == r->order) {
+                lits[n++] = cc ? -(u + 1) : u + 1;
+            } else {
+                int var = recolor_edge_var(r, u, v);
+
+                lits[n++] = graph_color(r->base, u, v) == cc ? var : -var;
+            }
+        }
+    }
+
+    sat_add_clause(r->sat, lits, n);
+    r->clauses++;
+}
+
+static void recolor_visit(const int* clique, int k, color cc, void* arg) {
+    Recolor* r = arg;
+    int full[5];
+    uint64_t mask = 0;
+
+    for(int i = 0; i < k; i++) {
+        full[i] = clique[i];
+    }
+    if(r->through < 0) {
+        full[k++] = r->order;
+    } else {
+        full[k++] = r->flipped[r->through][0];
+        full[k++] = r->flipped[r->through][1];
+    }
+
+    /* A clique through several flipped edges is only forbidden for the first
+       of them, and one through the new vertex was forbidden before them */
+    for(int i = 0; i < k; i++) {
+        mask |= ((uint64_t)1) << full[i];
+    }
+    for(int i = 0; i < r->through; i++) {
+        uint64_t edge = (((uint64_t)1) << r->flipped[i][0]) | (((uint64_t)1) << r->flipped[i][1]);
+
+        if((mask & edge) == edge) {
+            return;
+        }
+    }
+
+    recolor_forbid(r, full, k, cc);
+    r->found++;
+}
+
+/* Apply the model to the base graph and forbid the monochromatic 5-cliques
+   it creates. Only cliques through the new vertex or a flipped edge can be
+   new, so those are the only ones searched */
+static int recolor_check(Recolor* r) {
+    int n = r->order;
+    uint64_t base = graph_all(n);
+
+    r->g = *r->base;
+    r->g.order = n + 1;
+    r->flips = 0;
+    for(int u = 0; u < n; u++) {
+        for(int v = u + 1; v < n; v++) {
+            if(sat_value(r->sat, recolor_edge_var(r, u, v))) {
+                graph_set(&r->g, u, v, !graph_color(r->base, u, v));
+                r->flipped[r->flips][0] = u;
+                r->flipped[r->flips][1] = v;
+                r->flips++;
+            }
+        }
+        graph_set(&r->g, u, n, sat_value(r->sat, u + 1));
+    }
+
+    r->found = 0;
+    for(color cc = 0; cc < 2; cc++) {
+        r->through = -1;
+        graph_cliques_in(&r->g, 4, cc, r->g.nbr[cc][n] & base, recolor_visit, r);
+
+        for(int i = 0; i < r->flips; i++) {
+            int u = r->flipped[i][0];
+            int v = r->flipped[i][1];
+
+            if(graph_color(&r->g, u, v) != cc) {
+                continue;
+            }
+            r->through = i;
+            graph_cliques_in(&r->g, 3, cc, r->g.nbr[cc][u] & r->g.nbr[cc][v] & base, recolor_visit, r);
+        }
+    }
+
+    return r->found;
+}
+
+void recolor_search(const Graph* g, const Ext_clique* cliques, int count, int max_flips,
+                    Recolor_result* result) {
+    int lits[EXT_MAX_ORDER + 6];
+    Recolor r;
+
+    if(max_flips < 0 || max_flips > RECOLOR_MAX_FLIPS) {
+        fprintf(stderr, "Error: at most %d flips are supported\n", RECOLOR_MAX_FLIPS);
+        exit(EXIT_FAILURE);
+    }
+    if(g->order >= GRAPH_MAX_ORDER) {
+        fprintf(stderr, "Error: order %d is too large to extend\n", g->order);
+        exit(EXIT_FAILURE);
+    }
+
+    r.base = g;
+    r.order = g->order;
+    r.max_flips = max_flips;
+    r.edges = r.order * (r.order - 1) / 2;
+    r.flip_var = r.order + 1;
+    r.counter_var = r.flip_var + r.edges;
+    r.sat = sat_new(r.counter_var + r.edges * (max_flips + 1) - 1);
+    r.rounds = 0;
+    r.clauses = 0;
+
+    recolor_add_counter(&r);
+
+    /* Each base 4-clique is broken by the row or by any flip of its edges */
+    for(int i = 0; i < count; i++) {
+        int n = ext_clause(&cliques[i], lits);
+        int vertices[4];
+        int k = 0;
+
+        for(uint64_t m = cliques[i].mask; m; m &= m - 1) {
+            vertices[k++] = __builtin_ctzll(m);
+        }
+        for(int a = 0; a < k; a++) {
+            for(int b = a + 1; b < k; b++) {
+                lits[n++] = recolor_edge_var(&r, vertices[a], vertices[b]);
+            }
+        }
+        sat_add_clause(r.sat, lits, n);
+    }
+
+    result->status = SAT_UNSAT;
+    for(int flips = 0; flips <= max_flips && result->status != SAT_SAT; flips++) {
+        int bound = -recolor_counter_var(&r, r.edges - 1, flips);
+
+        while(sat_solve(r.sat, &bound, r.edges > 0, 0) == SAT_SAT) {
+            r.rounds++;
+
+            if(recolor_check(&r) == 0) {
+                result->status = SAT_SAT;
+                break;
+            }
+        }
+    }
+
+    if(result->status == SAT_SAT) {
+        result->row = 0;
+        for(int u = 0; u < r.order; u++) {
+            if(sat_value(r.sat, u + 1)) {
+                result->row |= ((uint64_t)1) << u;
+            }
+        }
+        result->flips = r.flips;
+        for(int i = 0; i < r.flips; i++) {
+            result->flipped[i][0] = r.flipped[i][0];
+            result->flipped[i][1] = r.flipped[i][1];
+        }
+    }
+
+    result->rounds = r.rounds;
+    result->clauses = r.clauses;
+    result->conflicts = sat_conflicts(r.sat);
+
+    sat_free(r.sat);
+}
@@ -0,0 +1,44 @@
+/**
+ * Extension with bounded recoloring of the base graph. Besides the row of the
+ * new vertex, up to a given number of base edges may change color, which
+ * finds the near misses where no row works for the graph as it is.
+ *
+ * The SAT encoding has the row variables of ext_clause, then one flip
+ * variable per base edge, and a sequential counter over the flip variables
+ * bounding how many may be set. Each base 4-clique is forbidden up front, now
+ * broken either by the row or by flipping one of its edges. The cliques that
+ * flips create are added lazily: after every solve, the monochromatic
+ * 5-cliques through the new vertex or through a flipped edge are forbidden
+ * and the solve is repeated. The number of flips allowed is raised one at a
+ * time under assumptions, so the first solution uses as few flips as any.
+ */
+
+#ifndef RECOLOR_H
+#define RECOLOR_H
+
+#include <stdint.h>
+
+#include "extension.h"
+#include "graph.h"
+
+/* Most recolored edges a search can allow */
+#define RECOLOR_MAX_FLIPS 16
+
+typedef struct {
+    /* SAT_SAT with the row and the fewest flips, or SAT_UNSAT if no row
+       works with the flips allowed */
+    int status;
+    uint64_t row;
+    int flips;
+    int flipped[RECOLOR_MAX_FLIPS][2];
+
+    /* Solve rounds and clique clauses added after the first solve */
+    uint64_t rounds;
+    uint64_t clauses;
+    uint64_t conflicts;
+} Recolor_result;
+
+void recolor_search(const Graph* g, const Ext_clique* cliques, int count, int max_flips,
+                    Recolor_result* result);
+
+#endif
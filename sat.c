@@ -0,0 +1,804 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sat.h"
+
+/* Conflicts between restarts, scaled by the Luby sequence */
+#define SAT_RESTART_BASE 100
+
+/* Activity decay factors */
+#define SAT_VAR_DECAY 0.95
+#define SAT_CLAUSE_DECAY 0.999
+
+/* Learnt clauses kept before the first database reduction, and the increase
+   in that limit after each reduction */
+#define SAT_LEARNT_BASE 2000
+#define SAT_LEARNT_GROWTH 500
+
+/* Internally a literal is 2 * (var - 1), plus 1 when negated */
+#define SAT_LIT(d) ((d) > 0 ? 2 * ((d) - 1) : 2 * (-(d) - 1) + 1)
+#define SAT_VAR(l) ((l) >> 1)
+#define SAT_NEG(l) ((l) ^ 1)
+
+/* Internal result of a search between restarts */
+#define SAT_RESTART (-1)
+
+typedef struct {
+    int size;
+    int lbd;
+    bool learnt;
+    bool deleted;
+    float activity;
+    int lits[];
+} Sat_clause;
+
+/* Clauses watching a literal. A clause watches its first two literals */
+typedef struct {
+    Sat_clause** data;
+    int size;
+    int cap;
+} Sat_watches;
+
+struct Sat_s {
+    int vars;
+    int cap;
+    bool ok;
+
+    /* Per literal: 1 true, -1 false, 0 unassigned */
+    int8_t* value;
+    Sat_watches* watches;
+
+    /* Per variable */
+    int* level;
+    Sat_clause** reason;
+    double* activity;
+    int8_t* phase;
+    int8_t* seen;
+    int* heap_pos;
+    uint32_t* level_stamp;
+    int8_t* model;
+
+    /* Assignment trail, and where each decision level starts */
+    int* trail;
+    int trail_size;
+    int qhead;
+    int* trail_lim;
+    int levels;
+
+    /* Decision heap ordered by activity */
+    int* heap;
+    int heap_size;
+    double var_inc;
+    double clause_inc;
+    uint32_t stamp;
+
+    Sat_clause** clauses;
+    int clause_count;
+    int clause_cap;
+    Sat_clause** learnts;
+    int learnt_count;
+    int learnt_cap;
+    int max_learnts;
+
+    /* Scratch space for conflict analysis and clause addition */
+    int* buf;
+    int* buf2;
+
+    /* DRUP proof output, if any */
+    FILE* proof;
+    char* proof_buf;
+    size_t proof_cap;
+
+    uint64_t conflicts;
+    uint64_t decisions;
+    uint64_t propagations;
+};
+
+static void* sat_alloc(void* p, size_t size) {
+    p = realloc(p, size);
+    if(p == NULL && size > 0) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    return p;
+}
+
+/* Make room for at least vars variables */
+static void sat_grow(Sat* s, int vars) {
+    int cap = s->cap;
+
+    if(vars <= cap) {
+        return;
+    }
+    while(cap < vars) {
+        cap = cap ? 2 * cap : 16;
+    }
+
+    s->value = sat_alloc(s->value, 2 * cap * sizeof(int8_t));
+    s->watches = sat_alloc(s->watches, 2 * cap * sizeof(Sat_watches));
+    s->level = sat_alloc(s->level, cap * sizeof(int));
+    s->reason = sat_alloc(s->reason, cap * sizeof(Sat_clause*));
+    s->activity = sat_alloc(s->activity, cap * sizeof(double));
+    s->phase = sat_alloc(s->phase, cap * sizeof(int8_t));
+    s->seen = sat_alloc(s->seen, cap * sizeof(int8_t));
+    s->heap_pos = sat_alloc(s->heap_pos, cap * sizeof(int));
+    s->level_stamp = sat_alloc(s->level_stamp, (cap + 1) * sizeof(uint32_t));
+    s->model = sat_alloc(s->model, cap * sizeof(int8_t));
+    s->trail = sat_alloc(s->trail, cap * sizeof(int));
+    s->trail_lim = sat_alloc(s->trail_lim, (cap + 1) * sizeof(int));
+    s->heap = sat_alloc(s->heap, cap * sizeof(int));
+    s->buf = sat_alloc(s->buf, (cap + 1) * sizeof(int));
+    s->buf2 = sat_alloc(s->buf2, (cap + 1) * sizeof(int));
+
+    for(int v = s->cap; v < cap; v++) {
+        s->value[2 * v] = s->value[2 * v + 1] = 0;
+        memset(&s->watches[2 * v], 0, 2 * sizeof(Sat_watches));
+        s->level[v] = 0;
+        s->reason[v] = NULL;
+        s->activity[v] = 0;
+        s->phase[v] = 1;
+        s->seen[v] = 0;
+        s->heap_pos[v] = -1;
+        s->model[v] = 0;
+    }
+    for(int l = s->cap; l <= cap; l++) {
+        s->level_stamp[l] = 0;
+    }
+
+    s->cap = cap;
+}
+
+/* Write a lemma, or a deletion, to the proof as one line. Lines are written
+   with a single fwrite so solvers sharing a proof file do not interleave */
+static void proof_write(Sat* s, const int* lits, int n, bool deletion) {
+    size_t len = 0;
+
+    if(s->proof == NULL) {
+        return;
+    }
+
+    if(s->proof_cap < (size_t) n * 12 + 4) {
+        s->proof_cap = (size_t) n * 12 + 4;
+        s->proof_buf = sat_alloc(s->proof_buf, s->proof_cap);
+    }
+
+    if(deletion) {
+        len += sprintf(s->proof_buf + len, "d ");
+    }
+    for(int i = 0; i < n; i++) {
+        int v = SAT_VAR(lits[i]) + 1;
+
+        len += sprintf(s->proof_buf + len, "%d ", (lits[i] & 1) ? -v : v);
+    }
+    len += sprintf(s->proof_buf + len, "0\n");
+
+    fwrite(s->proof_buf, 1, len, s->proof);
+}
+
+static inline bool heap_before(const Sat* s, int a, int b) {
+    return s->activity[a] > s->activity[b];
+}
+
+static void heap_up(Sat* s, int i) {
+    int v = s->heap[i];
+
+    while(i > 0 && heap_before(s, v, s->heap[(i - 1) / 2])) {
+        s->heap[i] = s->heap[(i - 1) / 2];
+        s->heap_pos[s->heap[i]] = i;
+        i = (i - 1) / 2;
+    }
+    s->heap[i] = v;
+    s->heap_pos[v] = i;
+}
+
+static void heap_down(Sat* s, int i) {
+    int v = s->heap[i];
+
+    while(2 * i + 1 < s->heap_size) {
+        int child = 2 * i + 1;
+
+        if(child + 1 < s->heap_size && heap_before(s, s->heap[child + 1], s->heap[child])) {
+            child++;
+        }
+        if(!heap_before(s, s->heap[child], v)) {
+            break;
+        }
+        s->heap[i] = s->heap[child];
+        s->heap_pos[s->heap[i]] = i;
+        i = child;
+    }
+    s->heap[i] = v;
+    s->heap_pos[v] = i;
+}
+
+static void heap_insert(Sat* s, int v) {
+    if(s->heap_pos[v] >= 0) {
+        return;
+    }
+    s->heap[s->heap_size] = v;
+    s->heap_pos[v] = s->heap_size++;
+    heap_up(s, s->heap_pos[v]);
+}
+
+static int heap_pop(Sat* s) {
+    int v = s->heap[0];
+
+    s->heap_pos[v] = -1;
+    if(--s->heap_size > 0) {
+        s->heap[0] = s->heap[s->heap_size];
+        s->heap_pos[s->heap[0]] = 0;
+        heap_down(s, 0);
+    }
+
+    return v;
+}
+
+static void var_bump(Sat* s, int v) {
+    if((s->activity[v] += s->var_inc) > 1e100) {
+        for(int i = 0; i < s->vars; i++) {
+            s->activity[i] *= 1e-100;
+        }
+        s->var_inc *= 1e-100;
+    }
+    if(s->heap_pos[v] >= 0) {
+        heap_up(s, s->heap_pos[v]);
+    }
+}
+
+static void clause_bump(Sat* s, Sat_clause* c) {
+    if((c->activity += s->clause_inc) > 1e20) {
+        for(int i = 0; i < s->learnt_count; i++) {
+            s->learnts[i]->activity *= 1e-20;
+        }
+        s->clause_inc *= 1e-20;
+    }
+}
+
+static void watch(Sat* s, int lit, Sat_clause* c) {
+    Sat_watches* w = &s->watches[lit];
+
+    if(w->size == w->cap) {
+        w->cap = w->cap ? 2 * w->cap : 4;
+        w->data = sat_alloc(w->data, w->cap * sizeof(Sat_clause*));
+    }
+    w->data[w->size++] = c;
+}
+
+static Sat_clause* clause_new(Sat* s, const int* lits, int n, bool learnt) {
+    Sat_clause* c = sat_alloc(NULL, sizeof(Sat_clause) + n * sizeof(int));
+    Sat_clause*** list = learnt ? &s->learnts : &s->clauses;
+    int* count = learnt ? &s->learnt_count : &s->clause_count;
+    int* cap = learnt ? &s->learnt_cap : &s->clause_cap;
+
+    c->size = n;
+    c->lbd = n;
+    c->learnt = learnt;
+    c->deleted = false;
+    c->activity = 0;
+    memcpy(c->lits, lits, n * sizeof(int));
+
+    if(*count == *cap) {
+        *cap = *cap ? 2 * *cap : 64;
+        *list = sat_alloc(*list, *cap * sizeof(Sat_clause*));
+    }
+    (*list)[(*count)++] = c;
+
+    watch(s, c->lits[0], c);
+    watch(s, c->lits[1], c);
+
+    return c;
+}
+
+static inline void enqueue(Sat* s, int lit, Sat_clause* reason) {
+    int v = SAT_VAR(lit);
+
+    s->value[lit] = 1;
+    s->value[SAT_NEG(lit)] = -1;
+    s->level[v] = s->levels;
+    s->reason[v] = reason;
+    s->trail[s->trail_size++] = lit;
+}
+
+static void cancel_until(Sat* s, int level) {
+    if(s->levels <= level) {
+        return;
+    }
+
+    for(int i = s->trail_size - 1; i >= s->trail_lim[level]; i--) {
+        int lit = s->trail[i];
+        int v = SAT_VAR(lit);
+
+        s->value[lit] = s->value[SAT_NEG(lit)] = 0;
+        s->reason[v] = NULL;
+        s->phase[v] = lit & 1;
+        heap_insert(s, v);
+    }
+
+    s->trail_size = s->qhead = s->trail_lim[level];
+    s->levels = level;
+}
+
+/* Propagate every enqueued assignment. Returns the conflicting clause, if
+   any */
+static Sat_clause* propagate(Sat* s) {
+    while(s->qhead < s->trail_size) {
+        int false_lit = SAT_NEG(s->trail[s->qhead++]);
+        Sat_watches* ws = &s->watches[false_lit];
+        int i = 0, j = 0;
+
+        s->propagations++;
+
+        while(i < ws->size) {
+            Sat_clause* c = ws->data[i++];
+            int* lits = c->lits;
+            int k;
+
+            /* Keep the false literal in the second position */
+            if(lits[0] == false_lit) {
+                lits[0] = lits[1];
+                lits[1] = false_lit;
+            }
+
+            if(s->value[lits[0]] == 1) {
+                ws->data[j++] = c;
+                continue;
+            }
+
+            /* Look for a new literal to watch */
+            for(k = 2; k < c->size; k++) {
+                if(s->value[lits[k]] != -1) {
+                    lits[1] = lits[k];
+                    lits[k] = false_lit;
+                    watch(s, lits[1], c);
+                    break;
+                }
+            }
+            if(k < c->size) {
+                continue;
+            }
+
+            /* Unit or conflicting */
+            ws->data[j++] = c;
+            if(s->value[lits[0]] == -1) {
+                while(i < ws->size) {
+                    ws->data[j++] = ws->data[i++];
+                }
+                ws->size = j;
+                s->qhead = s->trail_size;
+                return c;
+            }
+            enqueue(s, lits[0], c);
+        }
+
+        ws->size = j;
+    }
+
+    return NULL;
+}
+
+/* Is lit implied by literals already in the learnt clause */
+static bool redundant(Sat* s, int lit) {
+    Sat_clause* c = s->reason[SAT_VAR(lit)];
+
+    if(c == NULL) {
+        return false;
+    }
+
+    for(int i = 1; i < c->size; i++) {
+        int v = SAT_VAR(c->lits[i]);
+
+        if(!s->seen[v] && s->level[v] > 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* First UIP conflict analysis. The learnt clause is left in buf, asserting
+   literal first, and its size returned. The backtrack level is stored in
+   level */
+static int analyze(Sat* s, Sat_clause* confl, int* level) {
+    int* out = s->buf;
+    int n = 1;
+    int path = 0;
+    int lit = -1;
+    int idx = s->trail_size - 1;
+    int m, i, j;
+
+    do {
+        if(confl->learnt) {
+            clause_bump(s, confl);
+        }
+
+        for(i = (lit == -1) ? 0 : 1; i < confl->size; i++) {
+            int q = confl->lits[i];
+            int v = SAT_VAR(q);
+
+            if(!s->seen[v] && s->level[v] > 0) {
+                var_bump(s, v);
+                s->seen[v] = 1;
+                if(s->level[v] >= s->levels) {
+                    path++;
+                } else {
+                    out[n++] = q;
+                }
+            }
+        }
+
+        while(!s->seen[SAT_VAR(s->trail[idx])]) {
+            idx--;
+        }
+        lit = s->trail[idx--];
+        confl = s->reason[SAT_VAR(lit)];
+        s->seen[SAT_VAR(lit)] = 0;
+        path--;
+    } while(path > 0);
+
+    out[0] = SAT_NEG(lit);
+
+    /* Drop literals implied by the rest of the clause */
+    memcpy(s->buf2, out, n * sizeof(int));
+    m = n;
+    for(i = j = 1; i < n; i++) {
+        if(!redundant(s, out[i])) {
+            out[j++] = out[i];
+        }
+    }
+    n = j;
+    for(i = 1; i < m; i++) {
+        s->seen[SAT_VAR(s->buf2[i])] = 0;
+    }
+
+    /* Put a literal from the highest remaining level second */
+    *level = 0;
+    if(n > 1) {
+        int max = 1;
+
+        for(i = 2; i < n; i++) {
+            if(s->level[SAT_VAR(out[i])] > s->level[SAT_VAR(out[max])]) {
+                max = i;
+            }
+        }
+        lit = out[max];
+        out[max] = out[1];
+        out[1] = lit;
+        *level = s->level[SAT_VAR(lit)];
+    }
+
+    return n;
+}
+
+/* Number of distinct decision levels in a clause */
+static int clause_lbd(Sat* s, const int* lits, int n) {
+    int lbd = 0;
+
+    s->stamp++;
+    for(int i = 0; i < n; i++) {
+        int l = s->level[SAT_VAR(lits[i])];
+
+        if(s->level_stamp[l] != s->stamp) {
+            s->level_stamp[l] = s->stamp;
+            lbd++;
+        }
+    }
+
+    return lbd;
+}
+
+static int learnt_cmp(const void* a, const void* b) {
+    const Sat_clause* x = *(Sat_clause* const*) a;
+    const Sat_clause* y = *(Sat_clause* const*) b;
+
+    if(x->lbd != y->lbd) {
+        return y->lbd - x->lbd;
+    }
+
+    return (x->activity > y->activity) - (x->activity < y->activity);
+}
+
+/* Remove the worse half of the learnt clauses, keeping those which are the
+   reason for an assignment or have a low LBD */
+static void reduce_db(Sat* s) {
+    int i, j;
+
+    qsort(s->learnts, s->learnt_count, sizeof(Sat_clause*), learnt_cmp);
+
+    for(i = 0; i < s->learnt_count / 2; i++) {
+        Sat_clause* c = s->learnts[i];
+        int v = SAT_VAR(c->lits[0]);
+        bool locked = s->reason[v] == c && s->value[c->lits[0]] == 1;
+
+        if(!locked && c->lbd > 2) {
+            c->deleted = true;
+        }
+    }
+
+    for(int l = 0; l < 2 * s->vars; l++) {
+        Sat_watches* w = &s->watches[l];
+
+        for(i = j = 0; i < w->size; i++) {
+            if(!w->data[i]->deleted) {
+                w->data[j++] = w->data[i];
+            }
+        }
+        w->size = j;
+    }
+
+    for(i = j = 0; i < s->learnt_count; i++) {
+        if(s->learnts[i]->deleted) {
+            proof_write(s, s->learnts[i]->lits, s->learnts[i]->size, true);
+            free(s->learnts[i]);
+        } else {
+            s->learnts[j++] = s->learnts[i];
+        }
+    }
+    s->learnt_count = j;
+    s->max_learnts += SAT_LEARNT_GROWTH;
+}
+
+/* Next unassigned variable by activity, as a literal in its saved phase */
+static int pick_branch(Sat* s) {
+    while(s->heap_size > 0) {
+        int v = heap_pop(s);
+
+        if(s->value[2 * v] == 0) {
+            return 2 * v + s->phase[v];
+        }
+    }
+
+    return -1;
+}
+
+static double luby(int i) {
+    int size = 1, seq = 0;
+
+    while(size < i + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while(size - 1 != i) {
+        size = (size - 1) >> 1;
+        seq--;
+        i = i % size;
+    }
+
+    return 1 << seq;
+}
+
+/* Search until a result is known, the restart limit is reached or the total
+   conflict limit is reached */
+static int search(Sat* s, const int* assumptions, int n, uint64_t restart_limit, uint64_t conflict_limit) {
+    uint64_t restart_conflicts = 0;
+
+    while(true) {
+        Sat_clause* confl = propagate(s);
+
+        if(confl != NULL) {
+            int level, size;
+
+            s->conflicts++;
+            restart_conflicts++;
+
+            if(s->levels == 0) {
+                proof_write(s, NULL, 0, false);
+                s->ok = false;
+                return SAT_UNSAT;
+            }
+
+            size = analyze(s, confl, &level);
+            cancel_until(s, level);
+            proof_write(s, s->buf, size, false);
+
+            if(size == 1) {
+                enqueue(s, s->buf[0], NULL);
+            } else {
+                Sat_clause* c = clause_new(s, s->buf, size, true);
+
+                c->lbd = clause_lbd(s, s->buf, size);
+                clause_bump(s, c);
+                enqueue(s, s->buf[0], c);
+            }
+
+            s->var_inc /= SAT_VAR_DECAY;
+            s->clause_inc /= SAT_CLAUSE_DECAY;
+        } else {
+            int next = -1;
+
+            if(conflict_limit && s->conflicts >= conflict_limit) {
+                return SAT_UNKNOWN;
+            }
+            if(restart_conflicts >= restart_limit) {
+                return SAT_RESTART;
+            }
+            if(s->learnt_count - s->trail_size >= s->max_learnts) {
+                reduce_db(s);
+            }
+
+            /* Assumptions take the first decision levels */
+            while(s->levels < n) {
+                int p = SAT_LIT(assumptions[s->levels]);
+
+                if(s->value[p] == 1) {
+                    s->trail_lim[s->levels++] = s->trail_size;
+                } else if(s->value[p] == -1) {
+                    return SAT_UNSAT;
+                } else {
+                    next = p;
+                    break;
+                }
+            }
+
+            if(next == -1) {
+                next = pick_branch(s);
+
+                if(next == -1) {
+                    for(int v = 0; v < s->vars; v++) {
+                        s->model[v] = s->value[2 * v] == 1;
+                    }
+                    return SAT_SAT;
+                }
+            }
+
+            s->decisions++;
+            s->trail_lim[s->levels++] = s->trail_size;
+            enqueue(s, next, NULL);
+        }
+    }
+}
+
+Sat* sat_new(int vars) {
+    Sat* s = sat_alloc(NULL, sizeof(Sat));
+
+    memset(s, 0, sizeof(Sat));
+    s->ok = true;
+    s->var_inc = 1;
+    s->clause_inc = 1;
+    s->max_learnts = SAT_LEARNT_BASE;
+
+    while(s->vars < vars) {
+        sat_new_var(s);
+    }
+
+    return s;
+}
+
+void sat_free(Sat* s) {
+    for(int i = 0; i < s->clause_count; i++) {
+        free(s->clauses[i]);
+    }
+    for(int i = 0; i < s->learnt_count; i++) {
+        free(s->learnts[i]);
+    }
+    for(int l = 0; l < 2 * s->cap; l++) {
+        free(s->watches[l].data);
+    }
+
+    free(s->value);
+    free(s->watches);
+    free(s->level);
+    free(s->reason);
+    free(s->activity);
+    free(s->phase);
+    free(s->seen);
+    free(s->heap_pos);
+    free(s->level_stamp);
+    free(s->model);
+    free(s->trail);
+    free(s->trail_lim);
+    free(s->heap);
+    free(s->buf);
+    free(s->buf2);
+    free(s->proof_buf);
+    free(s->clauses);
+    free(s->learnts);
+    free(s);
+}
+
+int sat_new_var(Sat* s) {
+    sat_grow(s, s->vars + 1);
+    heap_insert(s, s->vars);
+
+    return ++s->vars;
+}
+
+void sat_set_proof(Sat* s, FILE* proof) {
+    s->proof = proof;
+}
+
+int sat_vars(const Sat* s) {
+    return s->vars;
+}
+
+bool sat_add_clause(Sat* s, const int* lits, int n) {
+    int* c;
+    int i, j, k;
+
+    if(!s->ok) {
+        return false;
+    }
+
+    for(i = 0; i < n; i++) {
+        int v = lits[i] > 0 ? lits[i] : -lits[i];
+
+        while(s->vars < v) {
+            sat_new_var(s);
+        }
+    }
+
+    cancel_until(s, 0);
+
+    /* Drop duplicate and false literals, and the whole clause if it is a
+       tautology or already satisfied */
+    c = s->buf;
+    for(i = k = 0; i < n; i++) {
+        int lit = SAT_LIT(lits[i]);
+
+        if(s->value[lit] == 1) {
+            return true;
+        }
+        if(s->value[lit] == -1) {
+            continue;
+        }
+        for(j = 0; j < k; j++) {
+            if(c[j] == lit) {
+                break;
+            }
+            if(c[j] == SAT_NEG(lit)) {
+                return true;
+            }
+        }
+        if(j == k) {
+            c[k++] = lit;
+        }
+    }
+
+    if(k == 0) {
+        s->ok = false;
+    } else if(k == 1) {
+        enqueue(s, c[0], NULL);
+        s->ok = propagate(s) == NULL;
+    } else {
+        clause_new(s, c, k, false);
+    }
+
+    return s->ok;
+}
+
+int sat_solve(Sat* s, const int* assumptions, int n, uint64_t conflict_limit) {
+    int status = SAT_RESTART;
+    uint64_t limit = conflict_limit ? s->conflicts + conflict_limit : 0;
+
+    if(!s->ok) {
+        return SAT_UNSAT;
+    }
+
+    if(s->max_learnts < s->clause_count / 3) {
+        s->max_learnts = s->clause_count / 3;
+    }
+
+    for(int restarts = 0; status == SAT_RESTART; restarts++) {
+        status = search(s, assumptions, n, (uint64_t)(luby(restarts) * SAT_RESTART_BASE), limit);
+        cancel_until(s, 0);
+    }
+
+    return status;
+}
+
+bool sat_value(const Sat* s, int var) {
+    return s->model[var - 1];
+}
+
+uint64_t sat_conflicts(const Sat* s) {
+    return s->conflicts;
+}
+
+uint64_t sat_decisions(const Sat* s) {
+    return s->decisions;
+}
+
+uint64_t sat_propagations(const Sat* s) {
+    return s->propagations;
+}
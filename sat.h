@@ -0,0 +1,54 @@
+/**
+ * A small CDCL SAT solver: two watched literals, first UIP clause learning
+ * with minimization, VSIDS decisions with phase saving, Luby restarts and
+ * learnt clause database reduction. Literals are DIMACS style, i.e. variable
+ * v (numbered from 1) is the literal v and its negation is -v. Solving under
+ * assumptions leaves the solver reusable, so clauses may be added between
+ * calls and learnt clauses are kept.
+ *
+ * Learnt clauses, and their deletion, can be logged to a DRUP proof. Every
+ * lemma is implied by unit propagation from the clauses added and the
+ * lemmas before it.
+ */
+
+#ifndef SAT_H
+#define SAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Results of sat_solve */
+#define SAT_UNKNOWN 0
+#define SAT_SAT 10
+#define SAT_UNSAT 20
+
+typedef struct Sat_s Sat;
+
+Sat* sat_new(int vars);
+void sat_free(Sat* s);
+
+/* Add a fresh variable and return its number */
+int sat_new_var(Sat* s);
+int sat_vars(const Sat* s);
+
+/* Add a clause of n literals. Returns false once the formula is known to be
+   unsatisfiable without assumptions */
+bool sat_add_clause(Sat* s, const int* lits, int n);
+
+/* Solve under the given assumption literals. A conflict limit of 0 means no
+   limit; SAT_UNKNOWN is returned when the limit is reached */
+int sat_solve(Sat* s, const int* assumptions, int n, uint64_t conflict_limit);
+
+/* Log learnt clauses to proof, or stop logging if proof is NULL */
+void sat_set_proof(Sat* s, FILE* proof);
+
+/* Value of a variable in the model found by the last successful solve */
+bool sat_value(const Sat* s, int var);
+
+/* Search statistics */
+uint64_t sat_conflicts(const Sat* s);
+uint64_t sat_decisions(const Sat* s);
+uint64_t sat_propagations(const Sat* s);
+
+#endif
@@ -0,0 +1,694 @@
+/**
+ * File: serve.c
+ *
+ * Purpose: Long-lived service running extension, count and verify jobs sent
+ *  over a Unix domain socket, so a pipeline submitting many small jobs pays
+ *  for startup and filter memory once. Each line a client sends is a job:
+ *
+ *   <id> extend <k> <graph>      a row for a new vertex closing no
+ *                                monochromatic k-clique, by the libramsey
+ *                                permutation search
+ *   <id> count <k> <graph>       the red and blue k-cliques
+ *   <id> verify <s>,<t> <graph>  whether there is no red K_s and no blue K_t
+ *   <id> stats                   jobs run and extension cache hits so far
+ *
+ *  The id is any word, echoed at the start of the result, and the graph is
+ *  either a mask line (the order and the hex blue neighbor mask of each
+ *  vertex, as grow writes its runs) or the path of an adjacency matrix. Jobs
+ *  are run by a pool of threads in the order received, and each result is
+ *  written back as soon as it is ready, so the results of one client can
+ *  come back in another order:
+ *
+ *   <id> row <entries>  or  <id> none
+ *   <id> red <count> blue <count>
+ *   <id> ok  or  <id> red K<s>  or  <id> blue K<t>
+ *   <id> error <message>
+ *
+ *  Extension contexts are kept warm in a cache keyed by graph and k. A job
+ *  on a graph seen recently reuses its potential cliques and filtered
+ *  permutations, and a new graph takes over the least recently used context
+ *  along with its filter memory.
+ *
+ *  With -c the program is a client instead, sending the jobs on stdin and
+ *  writing the results to stdout.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "graph.h"
+#include "ramsey.h"
+
+/* Default number of extension contexts kept warm */
+#define SERVE_CACHE_SIZE 32
+
+/* Default permutation filter size of an extension context. Every cached
+   context keeps its own filter memory, so this is well below
+   RAMSEY_PERM_BITS */
+#define SERVE_PERM_BITS 16
+
+/* Longest job id echoed back */
+#define SERVE_MAX_ID 64
+
+/* Longest result line */
+#define SERVE_MAX_LINE 256
+
+#define SERVE_EXTEND 0
+#define SERVE_COUNT 1
+#define SERVE_VERIFY 2
+
+/* A client. It is closed once the client has stopped sending and every job
+   it sent has been answered */
+typedef struct {
+    int fd;
+    FILE* in;
+    pthread_mutex_t lock;
+    int pending;
+    bool done;
+} Serve_conn;
+
+typedef struct Serve_job_s {
+    Serve_conn* conn;
+    char id[SERVE_MAX_ID + 1];
+    int kind;
+    int size[2];
+    Graph g;
+    struct Serve_job_s* next;
+} Serve_job;
+
+/* An extension context with the graph and clique size it was prepared for */
+typedef struct {
+    Ramsey_ctx ctx;
+    Graph g;
+    int k;
+    bool valid;
+    bool busy;
+    uint64_t used;
+} Serve_entry;
+
+static void usage(const char* prog);
+
+static const char* socket_path = NULL;
+
+/* Jobs waiting for a thread */
+static Serve_job* queue_head = NULL;
+static Serve_job* queue_tail = NULL;
+static uint64_t jobs_done = 0;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+
+/* Warm extension contexts */
+static Serve_entry* cache = NULL;
+static int cache_size = SERVE_CACHE_SIZE;
+static uint64_t cache_clock = 0;
+static uint64_t cache_hits = 0;
+static uint64_t cache_misses = 0;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cache_cond = PTHREAD_COND_INITIALIZER;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-t threads] [-b bits] [-n contexts] <socket>\n"
+            "       %s -c <socket>\n"
+            "  -t  number of job threads (default number of processors)\n"
+            "  -b  permutation filter size in bits of an extension (default %d)\n"
+            "  -n  extension contexts kept warm, at least one per thread (default %d)\n"
+            "  -c  send the jobs on stdin to a running service and print the results\n",
+            prog, prog, SERVE_PERM_BITS, SERVE_CACHE_SIZE);
+    exit(EXIT_FAILURE);
+}
+
+static void on_signal(int sig) {
+    (void) sig;
+    unlink(socket_path);
+    _exit(EXIT_SUCCESS);
+}
+
+static bool write_all(int fd, const char* buf, size_t len) {
+    while(len > 0) {
+        ssize_t n = write(fd, buf, len);
+
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+/* Write one result line. A client which has gone away is ignored */
+static void reply(Serve_conn* conn, const char* id, const char* fmt, ...) {
+    char line[SERVE_MAX_LINE];
+    va_list args;
+    int len;
+
+    len = snprintf(line, sizeof(line), "%s ", id);
+    va_start(args, fmt);
+    len += vsnprintf(line + len, sizeof(line) - len - 1, fmt, args);
+    va_end(args);
+    if(len > (int) sizeof(line) - 2) {
+        len = sizeof(line) - 2;
+    }
+    line[len++] = '\n';
+
+    pthread_mutex_lock(&conn->lock);
+    write_all(conn->fd, line, len);
+    pthread_mutex_unlock(&conn->lock);
+}
+
+/* The client has stopped sending, or one of its jobs is answered */
+static void conn_finish(Serve_conn* conn, bool job) {
+    bool close;
+
+    pthread_mutex_lock(&conn->lock);
+    if(job) {
+        conn->pending--;
+    } else {
+        conn->done = true;
+    }
+    close = conn->done && conn->pending == 0;
+    pthread_mutex_unlock(&conn->lock);
+
+    if(close) {
+        fclose(conn->in);
+        pthread_mutex_destroy(&conn->lock);
+        free(conn);
+    }
+}
+
+static bool same_graph(const Graph* a, const Graph* b) {
+    return a->order == b->order &&
+           memcmp(a->nbr[1], b->nbr[1], sizeof(uint64_t) * a->order) == 0;
+}
+
+/* Check out the context for g and k, preparing the least recently used one
+   if none is warm */
+static Serve_entry* cache_get(const Graph* g, int k) {
+    Serve_entry* e = NULL;
+    bool hit = false;
+
+    pthread_mutex_lock(&cache_lock);
+    while(e == NULL) {
+        Serve_entry* lru = NULL;
+        bool wait = false;
+
+        for(int i = 0; i < cache_size; i++) {
+            Serve_entry* c = &cache[i];
+
+            if(c->valid && c->k == k && same_graph(&c->g, g)) {
+                if(c->busy) {
+                    wait = true;
+                } else {
+                    e = c;
+                    hit = true;
+                }
+                break;
+            }
+            if(!c->busy && (lru == NULL || !c->valid || (lru->valid && c->used < lru->used))) {
+                lru = c;
+            }
+        }
+
+        /* Another job is on the same graph; its context will be warm */
+        if(wait) {
+            pthread_cond_wait(&cache_cond, &cache_lock);
+        } else if(e == NULL) {
+            e = lru;
+            e->g = *g;
+            e->k = k;
+            e->valid = true;
+        }
+    }
+    e->busy = true;
+    if(hit) {
+        cache_hits++;
+    } else {
+        cache_misses++;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    if(!hit) {
+        e->ctx.clique_n = k;
+        ramsey_from_graph(&e->ctx, g);
+        ramsey_prepare(&e->ctx);
+    }
+
+    return e;
+}
+
+static void cache_put(Serve_entry* e) {
+    pthread_mutex_lock(&cache_lock);
+    e->busy = false;
+    e->used = ++cache_clock;
+    pthread_cond_broadcast(&cache_cond);
+    pthread_mutex_unlock(&cache_lock);
+}
+
+static void run_job(Serve_job* job) {
+    const Graph* g = &job->g;
+
+    switch(job->kind) {
+    case SERVE_EXTEND: {
+        Serve_entry* e = cache_get(g, job->size[0]);
+        char row[GRAPH_MAX_ORDER + 1];
+        bool found = ramsey_extend(&e->ctx);
+
+        for(int v = 0; v < g->order; v++) {
+            row[v] = '0' + e->ctx.row[v];
+        }
+        row[g->order] = '\0';
+        cache_put(e);
+
+        if(found) {
+            reply(job->conn, job->id, "row %s", row);
+        } else {
+            reply(job->conn, job->id, "none");
+        }
+        break;
+    }
+    case SERVE_COUNT: {
+        uint64_t count[2];
+
+        for(color cc = 0; cc < 2; cc++) {
+            count[cc] = graph_cliques_in(g, job->size[0], cc, graph_all(g->order), NULL, NULL);
+        }
+        reply(job->conn, job->id, "red %llu blue %llu",
+              (unsigned long long) count[0], (unsigned long long) count[1]);
+        break;
+    }
+    default: {
+        int bad = -1;
+
+        for(color cc = 0; cc < 2 && bad < 0; cc++) {
+            if(graph_clique_number(g, cc, graph_all(g->order)) >= job->size[cc]) {
+                bad = cc;
+            }
+        }
+        if(bad < 0) {
+            reply(job->conn, job->id, "ok");
+        } else {
+            reply(job->conn, job->id, "%s K%d", bad ? "blue" : "red", job->size[bad]);
+        }
+    }
+    }
+}
+
+static void* worker(void* arg) {
+    (void) arg;
+
+    for(;;) {
+        Serve_job* job;
+
+        pthread_mutex_lock(&queue_lock);
+        while(queue_head == NULL) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        job = queue_head;
+        queue_head = job->next;
+        if(queue_head == NULL) {
+            queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&queue_lock);
+
+        run_job(job);
+
+        pthread_mutex_lock(&queue_lock);
+        jobs_done++;
+        pthread_mutex_unlock(&queue_lock);
+
+        conn_finish(job->conn, true);
+        free(job);
+    }
+
+    return NULL;
+}
+
+static void submit(Serve_job* job) {
+    pthread_mutex_lock(&job->conn->lock);
+    job->conn->pending++;
+    pthread_mutex_unlock(&job->conn->lock);
+
+    job->next = NULL;
+    pthread_mutex_lock(&queue_lock);
+    if(queue_tail == NULL) {
+        queue_head = job;
+    } else {
+        queue_tail->next = job;
+    }
+    queue_tail = job;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+/* Read the adjacency matrix at path, as graph_load does but reporting a bad
+   matrix rather than exiting. Returns NULL or why it could not be read */
+static const char* read_matrix(const char* path, Graph* g) {
+    FILE* f = fopen(path, "r");
+    color entries[GRAPH_MAX_ORDER * GRAPH_MAX_ORDER];
+    int order = 0, count = 0;
+    bool first = true;
+    int c;
+
+    if(f == NULL) {
+        return "could not open adjacency matrix";
+    }
+
+    while((c = fgetc(f)) != EOF) {
+        if(c == '\n' && count > 0) {
+            first = false;
+        }
+        if(c != '0' && c != '1') {
+            continue;
+        }
+        if(count == GRAPH_MAX_ORDER * GRAPH_MAX_ORDER || (first && count == GRAPH_MAX_ORDER)) {
+            fclose(f);
+            return "graph has more than 64 vertices";
+        }
+        entries[count++] = c - '0';
+        order += first;
+    }
+    fclose(f);
+
+    if(order == 0 || count != order * order) {
+        return "invalid matrix size";
+    }
+
+    graph_init(g, order);
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            if(entries[u * order + v] != entries[v * order + u]) {
+                return "matrix is not symmetric";
+            }
+            graph_set(g, u, v, entries[u * order + v]);
+        }
+    }
+
+    return NULL;
+}
+
+/* Parse a job line into job. Returns NULL or why it is not a job */
+static const char* parse_job(char* line, Serve_job* job) {
+    char* rest;
+    char* verb = strtok_r(line, " ", &rest);
+    char* size = strtok_r(NULL, " ", &rest);
+    char* graph = rest;
+    int masks;
+
+    if(verb == NULL) {
+        return "missing job";
+    }
+    if(strcmp(verb, "extend") == 0) {
+        job->kind = SERVE_EXTEND;
+    } else if(strcmp(verb, "count") == 0) {
+        job->kind = SERVE_COUNT;
+    } else if(strcmp(verb, "verify") == 0) {
+        job->kind = SERVE_VERIFY;
+    } else {
+        return "unknown job";
+    }
+
+    if(size == NULL || *graph == '\0') {
+        return "missing clique size or graph";
+    }
+    if(job->kind == SERVE_VERIFY) {
+        if(sscanf(size, "%d,%d", &job->size[0], &job->size[1]) != 2 ||
+           job->size[0] < 2 || job->size[1] < 2) {
+            return "clique sizes are not s,t with s, t >= 2";
+        }
+    } else {
+        job->size[0] = job->size[1] = atoi(size);
+        if(job->size[0] < 2 + (job->kind == SERVE_EXTEND) || job->size[0] > GRAPH_MAX_ORDER) {
+            return job->kind == SERVE_EXTEND ? "clique size is not between 3 and 64" :
+                                               "clique size is not between 2 and 64";
+        }
+    }
+
+    while(*graph == ' ') {
+        graph++;
+    }
+    masks = graph_parse_masks(&job->g, graph);
+    if(masks < 0) {
+        return "masks are not symmetric";
+    }
+    if(masks == 0) {
+        return read_matrix(graph, &job->g);
+    }
+
+    return NULL;
+}
+
+/* Read the jobs of one client until it stops sending */
+static void* reader(void* arg) {
+    Serve_conn* conn = arg;
+    char* line = NULL;
+    size_t line_size = 0;
+    ssize_t len;
+
+    while((len = getline(&line, &line_size, conn->in)) != -1) {
+        Serve_job* job;
+        const char* why;
+        char* rest;
+        char* id;
+
+        while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+            line[--len] = '\0';
+        }
+        id = strtok_r(line, " ", &rest);
+        if(id == NULL) {
+            continue;
+        }
+        if(strlen(id) > SERVE_MAX_ID) {
+            id[SERVE_MAX_ID] = '\0';
+        }
+
+        if(strcmp(rest, "stats") == 0) {
+            uint64_t done, hits, misses;
+
+            pthread_mutex_lock(&queue_lock);
+            done = jobs_done;
+            pthread_mutex_unlock(&queue_lock);
+            pthread_mutex_lock(&cache_lock);
+            hits = cache_hits;
+            misses = cache_misses;
+            pthread_mutex_unlock(&cache_lock);
+            reply(conn, id, "jobs %llu hits %llu misses %llu", (unsigned long long) done,
+                  (unsigned long long) hits, (unsigned long long) misses);
+            continue;
+        }
+
+        job = malloc(sizeof(Serve_job));
+        if(job == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+        job->conn = conn;
+        strcpy(job->id, id);
+
+        why = parse_job(rest, job);
+        if(why != NULL) {
+            reply(conn, id, "error %s", why);
+            free(job);
+            continue;
+        }
+        submit(job);
+    }
+
+    free(line);
+    conn_finish(conn, false);
+
+    return NULL;
+}
+
+static int open_socket(const char* path, struct sockaddr_un* addr) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(fd < 0) {
+        perror("Could not create socket");
+        exit(EXIT_FAILURE);
+    }
+    if(strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Error: socket path %s is too long\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+
+    return fd;
+}
+
+/* Send the jobs on stdin, then tell the service there are no more */
+static void* send_jobs(void* arg) {
+    int fd = *(int*) arg;
+    char buf[4096];
+    ssize_t n;
+
+    while((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+        if(!write_all(fd, buf, n)) {
+            break;
+        }
+    }
+    shutdown(fd, SHUT_WR);
+
+    return NULL;
+}
+
+static int run_client(const char* path) {
+    struct sockaddr_un addr;
+    int fd = open_socket(path, &addr);
+    pthread_t sender;
+    char buf[4096];
+    ssize_t n;
+
+    if(connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        perror("Could not connect");
+        exit(EXIT_FAILURE);
+    }
+
+    if(pthread_create(&sender, NULL, send_jobs, &fd) != 0) {
+        perror("Could not create thread");
+        exit(EXIT_FAILURE);
+    }
+    while((n = read(fd, buf, sizeof(buf))) > 0) {
+        write_all(STDOUT_FILENO, buf, n);
+    }
+    pthread_join(sender, NULL);
+    close(fd);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
+    struct sockaddr_un addr;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int perm_bits = SERVE_PERM_BITS;
+    bool client = false;
+    int fd, opt;
+
+    while((opt = getopt(argc, argv, "t:b:n:c")) != -1) {
+        switch(opt) {
+        case 't':
+            threads = atoi(optarg);
+            if(threads < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 'b':
+            perm_bits = atoi(optarg);
+            if(perm_bits < 1 || perm_bits > 31) {
+                usage(argv[0]);
+            }
+            break;
+        case 'n':
+            cache_size = atoi(optarg);
+            if(cache_size < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 'c':
+            client = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc - optind != 1) {
+        usage(argv[0]);
+    }
+    socket_path = argv[optind];
+
+    if(client) {
+        return run_client(socket_path);
+    }
+
+    /* Every thread can hold a context at once */
+    if(cache_size < threads) {
+        cache_size = threads;
+    }
+    cache = calloc(cache_size, sizeof(Serve_entry));
+    if(cache == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+    for(int i = 0; i < cache_size; i++) {
+        ramsey_init(&cache[i].ctx, 2, perm_bits);
+    }
+
+    fd = open_socket(socket_path, &addr);
+    if(bind(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        perror("Could not bind socket");
+        exit(EXIT_FAILURE);
+    }
+    if(listen(fd, SOMAXCONN) != 0) {
+        perror("Could not listen on socket");
+        unlink(socket_path);
+        exit(EXIT_FAILURE);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    for(int i = 0; i < threads; i++) {
+        pthread_t thread;
+
+        if(pthread_create(&thread, NULL, worker, NULL) != 0) {
+            perror("Could not create thread");
+            exit(EXIT_FAILURE);
+        }
+        pthread_detach(thread);
+    }
+
+    printf("Serving on %s with %d threads, %d warm contexts of %d bits\n", socket_path, threads,
+           cache_size, perm_bits);
+    fflush(stdout);
+
+    for(;;) {
+        Serve_conn* conn;
+        pthread_t thread;
+        int client_fd = accept(fd, NULL, NULL);
+
+        if(client_fd < 0) {
+            if(errno != EINTR) {
+                perror("Could not accept");
+            }
+            continue;
+        }
+
+        conn = malloc(sizeof(Serve_conn));
+        if(conn == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+        conn->fd = client_fd;
+        conn->in = fdopen(client_fd, "r");
+        conn->pending = 0;
+        conn->done = false;
+        pthread_mutex_init(&conn->lock, NULL);
+        if(conn->in == NULL || pthread_create(&thread, NULL, reader, conn) != 0) {
+            perror("Could not start client");
+            exit(EXIT_FAILURE);
+        }
+        pthread_detach(thread);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sat.h"
+#include "session.h"
+
+/* A clique seen during the session */
+typedef struct {
+    uint64_t mask;
+    color cc;
+    bool used;
+
+    /* Activation variable guarding the clique's clause */
+    int var;
+
+    /* Update in which the clique was last active */
+    uint32_t stamp;
+} Session_entry;
+
+struct Session_s {
+    int order;
+    Sat* sat;
+
+    /* Open addressing table of every clique seen */
+    Session_entry* table;
+    uint32_t table_cap;
+    uint32_t table_count;
+
+    /* Activation literals of the active instance */
+    int* assumptions;
+    int assumption_count;
+    int assumption_cap;
+
+    uint32_t stamp;
+    int clauses;
+};
+
+static inline uint32_t session_hash(uint64_t mask, color cc, uint32_t cap) {
+    return (uint32_t)(((mask ^ cc) * 0x9e3779b97f4a7c15ULL) >> 32) & (cap - 1);
+}
+
+static Session_entry* session_find(Session* s, uint64_t mask, color cc) {
+    uint32_t i = session_hash(mask, cc, s->table_cap);
+
+    while(s->table[i].used && (s->table[i].mask != mask || s->table[i].cc != cc)) {
+        i = (i + 1) & (s->table_cap - 1);
+    }
+
+    return &s->table[i];
+}
+
+static void session_grow(Session* s) {
+    Session_entry* old = s->table;
+    uint32_t old_cap = s->table_cap;
+
+    s->table_cap = old_cap ? 2 * old_cap : 1024;
+    s->table = calloc(s->table_cap, sizeof(Session_entry));
+    if(s->table == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(uint32_t i = 0; i < old_cap; i++) {
+        if(old[i].used) {
+            *session_find(s, old[i].mask, old[i].cc) = old[i];
+        }
+    }
+
+    free(old);
+}
+
+Session* session_new(int order) {
+    Session* s = calloc(1, sizeof(Session));
+
+    if(s == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    s->order = order;
+    s->sat = sat_new(order);
+    session_grow(s);
+
+    return s;
+}
+
+void session_free(Session* s) {
+    sat_free(s->sat);
+    free(s->table);
+    free(s->assumptions);
+    free(s);
+}
+
+void session_update(Session* s, const Ext_clique* cliques, int count, int* added, int* retracted) {
+    int previous = s->assumption_count;
+    int kept = 0;
+
+    *added = 0;
+    s->stamp++;
+    s->assumption_count = 0;
+
+    if(s->assumption_cap < count) {
+        s->assumption_cap = count;
+        s->assumptions = realloc(s->assumptions, count * sizeof(int));
+        if(s->assumptions == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for(int i = 0; i < count; i++) {
+        Session_entry* e;
+
+        if(2 * (s->table_count + 1) > s->table_cap) {
+            session_grow(s);
+        }
+
+        e = session_find(s, cliques[i].mask, cliques[i].cc);
+
+        if(!e->used) {
+            /* First time this clique is seen: add its guarded clause */
+            int lits[EXT_MAX_ORDER + 1];
+            int n;
+
+            e->used = true;
+            e->mask = cliques[i].mask;
+            e->cc = cliques[i].cc;
+            e->var = sat_new_var(s->sat);
+            e->stamp = 0;
+            s->table_count++;
+
+            lits[0] = -e->var;
+            n = ext_clause(&cliques[i], lits + 1);
+            sat_add_clause(s->sat, lits, n + 1);
+            s->clauses++;
+        }
+
+        if(e->stamp == s->stamp) {
+            continue;
+        }
+
+        if(e->stamp == s->stamp - 1 && s->stamp > 1) {
+            kept++;
+        } else {
+            (*added)++;
+        }
+
+        e->stamp = s->stamp;
+        s->assumptions[s->assumption_count++] = e->var;
+    }
+
+    *retracted = previous - kept;
+}
+
+int session_solve(Session* s, uint64_t* row) {
+    int status = sat_solve(s->sat, s->assumptions, s->assumption_count, 0);
+
+    if(status == SAT_SAT) {
+        *row = 0;
+        for(int v = 0; v < s->order; v++) {
+            if(sat_value(s->sat, v + 1)) {
+                *row |= ((uint64_t)1) << v;
+            }
+        }
+    }
+
+    return status;
+}
+
+int session_clauses(const Session* s) {
+    return s->clauses;
+}
@@ -0,0 +1,35 @@
+/**
+ * Incremental SAT across a sequence of related extension instances, such as
+ * the vertex-deleted variants of a base graph or the graph after one local
+ * search move. One solver is kept for the whole session. Every clique seen is
+ * added once as a clause guarded by its own activation variable, and an
+ * instance is solved by assuming the activation variables of its cliques.
+ * Moving to the next instance only adds the cliques not seen before and
+ * stops assuming the ones which disappeared, so learnt clauses carry over.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdint.h>
+
+#include "extension.h"
+
+typedef struct Session_s Session;
+
+Session* session_new(int order);
+void session_free(Session* s);
+
+/* Make cliques the active instance. The number of cliques newly activated
+   and retracted relative to the previous instance are stored in added and
+   retracted */
+void session_update(Session* s, const Ext_clique* cliques, int count, int* added, int* retracted);
+
+/* Solve the active instance. Returns SAT_SAT and stores the row found, or
+   SAT_UNSAT */
+int session_solve(Session* s, uint64_t* row);
+
+/* Clauses added to the solver over the whole session */
+int session_clauses(const Session* s);
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * File: sweep.c
+ *
+ * Purpose: Scaling benchmark over generated colorings. Sweeps the order, the
+ *  clique size k and the blue density (see gen_density), and at each point
+ *  times every engine on the same coloring:
+ *
+ *   enum_graph   list the red and blue k-cliques with graph_cliques_in (orders
+ *                up to GRAPH_MAX_ORDER only)
+ *   enum_wide    the same with wide_cliques
+ *   count_graph  count them with graph_clique_counts (orders up to
+ *                GRAPH_MAX_ORDER only)
+ *   count_wide   count them with wide_cliques, without a visitor
+ *   extend_sat   solve the one-vertex extension avoiding monochromatic
+ *                (k+1)-cliques, i.e. the k-cliques as clauses, under a
+ *                conflict limit
+ *
+ *  One CSV row is written per engine and point: the result (cliques, or 1, 0
+ *  and -1 for an extension found, none and limit reached), the time, the
+ *  bytes of the data the engine builds beyond the coloring (clique lists and
+ *  clause literals), and the candidates it handles per second, i.e. cliques
+ *  for enumeration and counting and propagated row bits for extension.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "extension.h"
+#include "gen.h"
+#include "graph.h"
+#include "sat.h"
+#include "wide.h"
+
+/* Most densities in one sweep */
+#define SWEEP_MAX_DENSITIES 16
+
+/* Default conflict limit of an extension solve */
+#define SWEEP_CONFLICT_LIMIT 10000
+
+/* A growable list of cliques, k vertices each */
+typedef struct {
+    int* vertices;
+    uint64_t count;
+    uint64_t size;
+} Clique_list;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-n min,max,step] [-k min,max] [-d density,...] [-s seeds] "
+            "[-x conflicts] [-o out]\n"
+            "  -n  orders swept (default 20,120,10)\n"
+            "  -k  clique sizes swept (default 3,6)\n"
+            "  -d  blue densities swept (default 0.3,0.4,0.5)\n"
+            "  -s  colorings per point, seeded 1, 2, ... (default 1)\n"
+            "  -x  conflict limit of an extension solve (default %d)\n"
+            "  -o  write the CSV to out instead of stdout\n", prog, SWEEP_CONFLICT_LIMIT);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void list_clique(const int* clique, int k, color cc, void* arg) {
+    Clique_list* list = arg;
+
+    (void) cc;
+    if(list->count == list->size) {
+        list->size = list->size ? 2 * list->size : 1024;
+        list->vertices = realloc(list->vertices, sizeof(int) * k * list->size);
+        if(list->vertices == NULL) {
+            perror("Could not alloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memcpy(list->vertices + list->count * k, clique, sizeof(int) * k);
+    list->count++;
+}
+
+static void report(FILE* out, const char* engine, int order, int k, double density, int seed,
+                   int64_t result, double seconds, uint64_t bytes, uint64_t candidates) {
+    fprintf(out, "%s,%d,%d,%.3f,%d,%lld,%.6f,%llu,%llu,%.0f\n", engine, order, k, density, seed,
+            (long long) result, seconds, (unsigned long long) bytes,
+            (unsigned long long) candidates, seconds > 0 ? candidates / seconds : 0.0);
+    fflush(out);
+}
+
+/* Time every engine on one coloring */
+static void run_point(FILE* out, const Wide_graph* g, int k, double density, int seed,
+                      uint64_t conflict_limit) {
+    struct timespec start;
+    Clique_list list = { NULL, 0, 0 };
+    uint64_t found;
+    int status;
+    Sat* sat;
+
+    if(g->order <= GRAPH_MAX_ORDER) {
+        uint64_t counts[GRAPH_MAX_ORDER + 1];
+        Graph small;
+
+        gen_pack(g, &small);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(color cc = 0; cc < 2; cc++) {
+            graph_cliques_in(&small, k, cc, graph_all(small.order), list_clique, &list);
+        }
+        report(out, "enum_graph", g->order, k, density, seed, list.count, elapsed(&start),
+               sizeof(int) * k * list.count, list.count);
+        list.count = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        found = 0;
+        for(color cc = 0; cc < 2; cc++) {
+            graph_clique_counts(&small, cc, graph_all(small.order), counts);
+            found += counts[k];
+        }
+        report(out, "count_graph", g->order, k, density, seed, found, elapsed(&start), 0, found);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(color cc = 0; cc < 2; cc++) {
+        wide_cliques(g, k, cc, list_clique, &list);
+    }
+    report(out, "enum_wide", g->order, k, density, seed, list.count, elapsed(&start),
+           sizeof(int) * k * list.count, list.count);
+    free(list.vertices);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    found = 0;
+    for(color cc = 0; cc < 2; cc++) {
+        found += wide_cliques(g, k, cc, NULL, NULL);
+    }
+    report(out, "count_wide", g->order, k, density, seed, found, elapsed(&start), 0, found);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sat = sat_new(g->order);
+    for(color cc = 0; cc < 2; cc++) {
+        wide_cliques(g, k, cc, ext_add_clique_clause, sat);
+    }
+    status = sat_solve(sat, NULL, 0, conflict_limit);
+    report(out, "extend_sat", g->order, k, density, seed,
+           status == SAT_SAT ? 1 : status == SAT_UNSAT ? 0 : -1, elapsed(&start),
+           sizeof(int) * k * found, sat_propagations(sat));
+    sat_free(sat);
+}
+
+int main(int argc, char** argv) {
+    double densities[SWEEP_MAX_DENSITIES] = { 0.3, 0.4, 0.5 };
+    uint64_t conflict_limit = SWEEP_CONFLICT_LIMIT;
+    int order_min = 20, order_max = 120, order_step = 10;
+    int k_min = 3, k_max = 6;
+    int density_count = 3;
+    int seeds = 1;
+    FILE* out = stdout;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:k:d:s:x:o:")) != -1) {
+        switch(opt) {
+        case 'n':
+            if(sscanf(optarg, "%d,%d,%d", &order_min, &order_max, &order_step) != 3 ||
+               order_min < 2 || order_max > WIDE_MAX_ORDER || order_step < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 'k':
+            if(sscanf(optarg, "%d,%d", &k_min, &k_max) != 2 || k_min < 2 || k_max < k_min) {
+                usage(argv[0]);
+            }
+            break;
+        case 'd': {
+            char* s = optarg;
+
+            density_count = 0;
+            do {
+                if(density_count == SWEEP_MAX_DENSITIES) {
+                    usage(argv[0]);
+                }
+                char* end;
+
+                densities[density_count] = strtod(s, &end);
+                if(end == s || (*end != ',' && *end != '\0') ||
+                   densities[density_count] < 0 || densities[density_count] > 1) {
+                    usage(argv[0]);
+                }
+                s = end;
+                density_count++;
+            } while(*s++ == ',');
+            break;
+        }
+        case 's':
+            seeds = atoi(optarg);
+            if(seeds < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 'x': {
+            char* end;
+
+            /* strtoull would take a sign, wrapping -1 to no limit */
+            conflict_limit = strtoull(optarg, &end, 0);
+            if(end == optarg || *end != '\0' || *optarg == '-' || *optarg == '+') {
+                usage(argv[0]);
+            }
+            break;
+        }
+        case 'o':
+            out = fopen(optarg, "w");
+            if(out == NULL) {
+                perror("Could not open output file");
+                exit(EXIT_FAILURE);
+            }
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc != optind) {
+        usage(argv[0]);
+    }
+
+    fprintf(out, "engine,order,k,density,seed,result,seconds,bytes,candidates,candidates_per_sec\n");
+
+    for(int order = order_min; order <= order_max; order += order_step) {
+        for(int d = 0; d < density_count; d++) {
+            for(int seed = 1; seed <= seeds; seed++) {
+                Wide_graph g;
+
+                gen_density(&g, order, densities[d], seed);
+                for(int k = k_min; k <= k_max && k <= order; k++) {
+                    run_point(out, &g, k, densities[d], seed, conflict_limit);
+                }
+                wide_free(&g);
+            }
+        }
+    }
+
+    if(out != stdout) {
+        fclose(out);
+    }
+
+    return EXIT_SUCCESS;
+}
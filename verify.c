@@ -0,0 +1,374 @@
+/**
+ * File: verify.c
+ *
+ * Purpose: Certifies colorings as R(s, t) colorings, i.e. free of red K_s and
+ *  blue K_t, independently of the tools that produce them. Every argument is
+ *  a file (or - for stdin), or a generator spec (see gen.h). Files may hold
+ *  any number of colorings in either format the tools write:
+ *
+ *   adjacency matrices  rows of 0's and 1's, as written by graph_dump,
+ *                       wide_dump and extend_graph's dump_graph. Other lines
+ *                       (such as the rest of a tool's output) are skipped,
+ *                       and stacked matrices are split by their order
+ *   mask lines          the order and the hex blue neighbor mask of each
+ *                       vertex, one coloring per line, as in grow's runs
+ *
+ *  Colorings of up to 64 vertices are read in batches of VERIFY_BATCH, and
+ *  the batch is split between threads, each checking its colorings with a
+ *  bitset clique search that stops at the first clique. Larger colorings are
+ *  checked on the multiword backend.
+ *
+ *  Failures are reported as they are found; the exit status is nonzero if
+ *  any coloring failed or could not be read.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gen.h"
+#include "graph.h"
+#include "wide.h"
+
+/* Colorings read before the threads check them */
+#define VERIFY_BATCH 4096
+
+/* Colorings waiting to be checked, and the clique found in each: 0 or 1 for
+   a red or blue one, -1 for none */
+typedef struct {
+    int fill;
+    Graph graphs[VERIFY_BATCH];
+    uint64_t index[VERIFY_BATCH];
+    int bad[VERIFY_BATCH];
+} Verify_batch;
+
+/* A thread's share of the batch: every threads-th coloring from first */
+typedef struct {
+    pthread_t thread;
+    int first;
+} Verify_worker;
+
+static void usage(const char* prog);
+static double elapsed(const struct timespec* start);
+
+static int clique_size[2] = { 5, 5 };
+static bool verbose = false;
+static int threads = 1;
+
+static Verify_batch batch;
+static const char* source = NULL;
+static uint64_t checked = 0;
+static uint64_t failed = 0;
+static uint64_t unreadable = 0;
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-c s,t] [-t threads] [-v] <file|spec|-> ...\n"
+            "  -c  clique sizes s,t (default 5,5)\n"
+            "  -t  number of checking threads (default number of processors)\n"
+            "  -v  report every coloring, not just the failures\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static double elapsed(const struct timespec* start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Is there a clique of depth more vertices among cand, with nbr giving the
+   neighbors of each vertex */
+static bool has_clique(const uint64_t* nbr, uint64_t cand, int depth) {
+    for(;;) {
+        uint64_t rest = cand;
+        int v;
+
+        /* Give up once fewer than depth candidates are left, i.e. clearing
+           the lowest one depth - 1 times leaves none */
+        for(int i = 1; i < depth; i++) {
+            rest &= rest - 1;
+        }
+        if(rest == 0) {
+            return false;
+        }
+        if(depth == 1) {
+            return true;
+        }
+
+        v = __builtin_ctzll(cand);
+        cand &= cand - 1;
+        if(has_clique(nbr, cand & nbr[v], depth - 1)) {
+            return true;
+        }
+    }
+}
+
+static void* verify_worker(void* arg) {
+    Verify_worker* w = arg;
+
+    for(int i = w->first; i < batch.fill; i += threads) {
+        const Graph* g = &batch.graphs[i];
+
+        batch.bad[i] = -1;
+        for(color cc = 0; cc < 2 && batch.bad[i] < 0; cc++) {
+            if(has_clique(g->nbr[cc], graph_all(g->order), clique_size[cc])) {
+                batch.bad[i] = cc;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void report(uint64_t index, int order, int bad) {
+    if(bad >= 0) {
+        printf("%s:%llu: order %d, %s K%d\n", source, (unsigned long long) index, order,
+               bad ? "blue" : "red", clique_size[bad]);
+        failed++;
+    } else if(verbose) {
+        printf("%s:%llu: order %d, ok\n", source, (unsigned long long) index, order);
+    }
+    checked++;
+}
+
+static void batch_flush(void) {
+    Verify_worker workers[threads];
+
+    if(batch.fill == 0) {
+        return;
+    }
+
+    for(int i = 0; i < threads; i++) {
+        workers[i].first = i;
+        if(pthread_create(&workers[i].thread, NULL, verify_worker, &workers[i]) != 0) {
+            perror("Could not create thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for(int i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    for(int i = 0; i < batch.fill; i++) {
+        report(batch.index[i], batch.graphs[i].order, batch.bad[i]);
+    }
+
+    batch.fill = 0;
+}
+
+static void check_graph(const Graph* g, uint64_t index) {
+    if(batch.fill == VERIFY_BATCH) {
+        batch_flush();
+    }
+
+    batch.graphs[batch.fill] = *g;
+    batch.index[batch.fill] = index;
+    batch.fill++;
+}
+
+static void check_wide(const Wide_graph* g, uint64_t index) {
+    Graph small;
+    int bad = -1;
+
+    if(g->order <= GRAPH_MAX_ORDER) {
+        gen_pack(g, &small);
+        check_graph(&small, index);
+        return;
+    }
+
+    batch_flush();
+    for(color cc = 0; cc < 2 && bad < 0; cc++) {
+        if(wide_has_clique(g, clique_size[cc], cc)) {
+            bad = cc;
+        }
+    }
+    report(index, g->order, bad);
+}
+
+static void bad_input(uint64_t line, const char* why) {
+    fprintf(stderr, "%s:%llu: %s\n", source, (unsigned long long) line, why);
+    unreadable++;
+}
+
+/* Check the matrix rows collected, n rows of n entries per coloring. Fewer
+   than n rows are not a matrix, but a lone row such as a printed extension */
+static void check_rows(char** rows, int count, uint64_t line, uint64_t* index) {
+    int order = strlen(rows[0]);
+
+    /* A lone row of digits is not taken for a matrix */
+    if(count < order) {
+        if(count > 1) {
+            bad_input(line, "matrix has fewer rows than columns");
+        }
+        return;
+    }
+    if(count % order != 0) {
+        bad_input(line, "matrix rows do not make up square matrices");
+        return;
+    }
+
+    for(int base = 0; base < count; base += order) {
+        Wide_graph g;
+        bool symmetric = true;
+
+        wide_init(&g, order);
+        for(int u = 0; u < order; u++) {
+            for(int v = u + 1; v < order; v++) {
+                symmetric = symmetric && rows[base + u][v] == rows[base + v][u];
+                wide_set(&g, u, v, rows[base + u][v] - '0');
+            }
+        }
+
+        if(symmetric) {
+            check_wide(&g, (*index)++);
+        } else {
+            bad_input(line + base, "matrix is not symmetric");
+        }
+        wide_free(&g);
+    }
+}
+
+static void check_file(FILE* f) {
+    char** rows = NULL;
+    int row_count = 0, row_size = 0;
+    uint64_t line = 0, first = 0, index = 1;
+    char* text = NULL;
+    size_t text_size = 0;
+    ssize_t len;
+
+    while((len = getline(&text, &text_size, f)) != -1) {
+        Graph g;
+        bool matrix = true;
+        int masks;
+
+        line++;
+        while(len > 0 && (text[len - 1] == '\n' || text[len - 1] == '\r')) {
+            text[--len] = '\0';
+        }
+        for(ssize_t i = 0; i < len && matrix; i++) {
+            matrix = text[i] == '0' || text[i] == '1';
+        }
+        matrix = matrix && len > 0 && len <= WIDE_MAX_ORDER;
+
+        /* A matrix ends at any other line, or a row of another length */
+        if(row_count > 0 && (!matrix || strlen(rows[0]) != (size_t) len)) {
+            check_rows(rows, row_count, first, &index);
+            for(int i = 0; i < row_count; i++) {
+                free(rows[i]);
+            }
+            row_count = 0;
+        }
+
+        if(matrix) {
+            if(row_count == row_size) {
+                row_size = row_size ? 2 * row_size : 64;
+                rows = realloc(rows, sizeof(char*) * row_size);
+                if(rows == NULL) {
+                    perror("Could not alloc");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            if(row_count == 0) {
+                first = line;
+            }
+            rows[row_count] = strdup(text);
+            if(rows[row_count] == NULL) {
+                perror("Could not alloc");
+                exit(EXIT_FAILURE);
+            }
+            row_count++;
+        } else if((masks = graph_parse_masks(&g, text)) > 0) {
+            check_graph(&g, index++);
+        } else if(masks < 0) {
+            bad_input(line, "masks are not symmetric");
+        }
+    }
+
+    if(row_count > 0) {
+        check_rows(rows, row_count, first, &index);
+        for(int i = 0; i < row_count; i++) {
+            free(rows[i]);
+        }
+    }
+    if(index == 1) {
+        bad_input(line, "no colorings found");
+    }
+
+    free(rows);
+    free(text);
+}
+
+int main(int argc, char** argv) {
+    struct timespec start;
+    double seconds;
+    int opt;
+
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    while((opt = getopt(argc, argv, "c:t:v")) != -1) {
+        switch(opt) {
+        case 'c':
+            if(sscanf(optarg, "%d,%d", &clique_size[0], &clique_size[1]) != 2 ||
+               clique_size[0] < 2 || clique_size[1] < 2) {
+                usage(argv[0]);
+            }
+            break;
+        case 't':
+            threads = atoi(optarg);
+            if(threads < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if(argc == optind) {
+        usage(argv[0]);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = optind; i < argc; i++) {
+        Wide_graph g;
+
+        source = argv[i];
+        if(strcmp(argv[i], "-") == 0) {
+            source = "<stdin>";
+            check_file(stdin);
+        } else if(gen_spec(&g, argv[i])) {
+            check_wide(&g, 1);
+            wide_free(&g);
+        } else {
+            FILE* f = fopen(argv[i], "r");
+
+            if(f == NULL) {
+                perror("Could not open colorings");
+                unreadable++;
+                continue;
+            }
+            check_file(f);
+            fclose(f);
+        }
+
+        /* Reports name the source, so a batch never spans two */
+        batch_flush();
+    }
+    seconds = elapsed(&start);
+
+    printf("Checked %llu colorings for red K%d and blue K%d in %.3fs (%.0f per second): "
+           "%llu failed, %llu unreadable\n", (unsigned long long) checked, clique_size[0],
+           clique_size[1], seconds, seconds > 0 ? checked / seconds : 0.0,
+           (unsigned long long) failed, (unsigned long long) unreadable);
+
+    return failed == 0 && unreadable == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,239 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "wide.h"
+
+/* Clique search state */
+typedef struct {
+    const Wide_graph* g;
+    int k;
+    color cc;
+    int clique[WIDE_MAX_ORDER];
+
+    void (*visit)(const int* clique, int k, color cc, void* arg);
+    void* arg;
+
+    /* Stop at the first clique if first is set */
+    bool first;
+    bool stop;
+    uint64_t found;
+} Wide_search;
+
+/* Instantiate the kernels for each row width */
+#define WIDE_PASTE(a, b) a##_##b
+#define WIDE_NAME(a, b) WIDE_PASTE(a, b)
+#define WIDE_FN(name) WIDE_NAME(name, W)
+
+#define W 1
+#include "wide_kernels.h"
+#undef W
+#define W 2
+#include "wide_kernels.h"
+#undef W
+#define W 4
+#include "wide_kernels.h"
+#undef W
+#define W 8
+#include "wide_kernels.h"
+#undef W
+#define W 16
+#include "wide_kernels.h"
+#undef W
+#define W 32
+#include "wide_kernels.h"
+#undef W
+#define W 64
+#include "wide_kernels.h"
+#undef W
+
+void wide_init(Wide_graph* g, int order) {
+    int need = (order + 63) / 64;
+
+    if(order < 1 || order > WIDE_MAX_ORDER) {
+        fprintf(stderr, "Error: order %d is not supported\n", order);
+        exit(EXIT_FAILURE);
+    }
+
+    g->order = order;
+    g->words = 1;
+    while(g->words < need) {
+        g->words *= 2;
+    }
+
+    g->nbr[0] = calloc((size_t) order * g->words, sizeof(uint64_t));
+    g->nbr[1] = calloc((size_t) order * g->words, sizeof(uint64_t));
+    if(g->nbr[0] == NULL || g->nbr[1] == NULL) {
+        perror("Could not alloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int u = 0; u < order; u++) {
+        for(int v = u + 1; v < order; v++) {
+            wide_set(g, u, v, 0);
+        }
+    }
+}
+
+void wide_free(Wide_graph* g) {
+    free(g->nbr[0]);
+    free(g->nbr[1]);
+}
+
+/* Load an adjacency matrix of 0's and 1's, one row per line. The order is
+   taken from the first row */
+void wide_load(Wide_graph* g, const char* path) {
+    FILE* f = fopen(path, "r");
+    color row[WIDE_MAX_ORDER];
+    int order = 0;
+    int i, c;
+
+    if(f == NULL) {
+        perror("Could not open adjacency matrix");
+        exit(EXIT_FAILURE);
+    }
+
+    while((c = fgetc(f)) != EOF && c != '\n') {
+        if(c == '0' || c == '1') {
+            if(order == WIDE_MAX_ORDER) {
+                fprintf(stderr, "Error: graph has more than %d vertices\n", WIDE_MAX_ORDER);
+                exit(EXIT_FAILURE);
+            }
+            row[order++] = c - '0';
+        }
+    }
+
+    if(order == 0) {
+        fprintf(stderr, "Error: invalid matrix size\n");
+        exit(EXIT_FAILURE);
+    }
+
+    wide_init(g, order);
+    for(i = 1; i < order; i++) {
+        wide_set(g, 0, i, row[i]);
+    }
+
+    /* Rows below the first must agree with the entries already set */
+    i = order;
+    while((c = fgetc(f)) != EOF) {
+        int u, v;
+
+        if(c != '0' && c != '1') {
+            continue;
+        }
+        if(i == order * order) {
+            i++;
+            break;
+        }
+
+        u = i / order;
+        v = i % order;
+        if(u < v) {
+            wide_set(g, u, v, c - '0');
+        } else if(u > v && wide_color(g, u, v) != c - '0') {
+            fprintf(stderr, "Error: matrix is not symmetric at %d, %d\n", u, v);
+            exit(EXIT_FAILURE);
+        }
+        i++;
+    }
+    fclose(f);
+
+    if(i != order * order) {
+        fprintf(stderr, "Error: invalid matrix size\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void wide_dump(const Wide_graph* g, FILE* f) {
+    for(int u = 0; u < g->order; u++) {
+        for(int v = 0; v < g->order; v++) {
+            fputc(u == v ? '0' : '0' + wide_color(g, u, v), f);
+        }
+        fputc('\n', f);
+    }
+}
+
+static void wide_dispatch(Wide_search* s) {
+    switch(s->g->words) {
+    case 1:
+        wide_search_1(s);
+        break;
+    case 2:
+        wide_search_2(s);
+        break;
+    case 4:
+        wide_search_4(s);
+        break;
+    case 8:
+        wide_search_8(s);
+        break;
+    case 16:
+        wide_search_16(s);
+        break;
+    case 32:
+        wide_search_32(s);
+        break;
+    default:
+        wide_search_64(s);
+        break;
+    }
+}
+
+uint64_t wide_cliques(const Wide_graph* g, int k, color cc,
+                      void (*visit)(const int* clique, int k, color cc, void* arg), void* arg) {
+    Wide_search s;
+
+    if(k < 1 || k > g->order) {
+        return 0;
+    }
+
+    s.g = g;
+    s.k = k;
+    s.cc = cc;
+    s.visit = visit;
+    s.arg = arg;
+    s.first = false;
+    s.stop = false;
+    s.found = 0;
+    wide_dispatch(&s);
+
+    return s.found;
+}
+
+bool wide_has_clique(const Wide_graph* g, int k, color cc) {
+    Wide_search s;
+
+    if(k < 1 || k > g->order) {
+        return false;
+    }
+
+    s.g = g;
+    s.k = k;
+    s.cc = cc;
+    s.visit = NULL;
+    s.arg = NULL;
+    s.first = true;
+    s.stop = false;
+    s.found = 0;
+    wide_dispatch(&s);
+
+    return s.found > 0;
+}
+
+double wide_walk(const Wide_graph* g, int k, color cc, uint64_t* rng) {
+    switch(g->words) {
+    case 1:
+        return wide_walk_1(g, k, cc, rng);
+    case 2:
+        return wide_walk_2(g, k, cc, rng);
+    case 4:
+        return wide_walk_4(g, k, cc, rng);
+    case 8:
+        return wide_walk_8(g, k, cc, rng);
+    case 16:
+        return wide_walk_16(g, k, cc, rng);
+    case 32:
+        return wide_walk_32(g, k, cc, rng);
+    default:
+        return wide_walk_64(g, k, cc, rng);
+    }
+}
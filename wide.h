@@ -0,0 +1,87 @@
+/**
+ * Two-colorings of complete graphs beyond the 64 vertices a Graph can pack.
+ * Each neighbor set is a row of 64-bit words, and the row width is rounded
+ * up to a power of two, at most 64 words. The bitset kernels, the clique
+ * search and the clique sampler are written once in wide_kernels.h and
+ * instantiated for each width, so their word loops have constant trip counts
+ * that the compiler unrolls and vectorizes; the wide_* entry points dispatch
+ * on the graph's width.
+ */
+
+#ifndef WIDE_H
+#define WIDE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "graph.h"
+
+/* Largest order supported, and the widest row in words */
+#define WIDE_MAX_ORDER 4096
+#define WIDE_MAX_WORDS (WIDE_MAX_ORDER / 64)
+
+typedef struct {
+    int order;
+    int words;
+
+    /* nbr[c] + v * words is the set of vertices u with edge uv of color c */
+    uint64_t* nbr[2];
+} Wide_graph;
+
+static inline const uint64_t* wide_row(const Wide_graph* g, color c, int v) {
+    return g->nbr[c] + (size_t) v * g->words;
+}
+
+static inline color wide_color(const Wide_graph* g, int u, int v) {
+    return (wide_row(g, 1, u)[v / 64] >> (v % 64)) & 1;
+}
+
+static inline void wide_set(Wide_graph* g, int u, int v, color c) {
+    uint64_t bu = ((uint64_t)1) << (u % 64);
+    uint64_t bv = ((uint64_t)1) << (v % 64);
+
+    g->nbr[c][(size_t) u * g->words + v / 64] |= bv;
+    g->nbr[!c][(size_t) u * g->words + v / 64] &= ~bv;
+    g->nbr[c][(size_t) v * g->words + u / 64] |= bu;
+    g->nbr[!c][(size_t) v * g->words + u / 64] &= ~bu;
+}
+
+/* An all red coloring of the given order */
+void wide_init(Wide_graph* g, int order);
+void wide_free(Wide_graph* g);
+
+/* Load an adjacency matrix of 0's and 1's, of any order up to
+   WIDE_MAX_ORDER */
+void wide_load(Wide_graph* g, const char* path);
+void wide_dump(const Wide_graph* g, FILE* f);
+
+/* Call visit (if not NULL) for every k-clique of color cc, in lexicographic
+   order. Returns the number of cliques found */
+uint64_t wide_cliques(const Wide_graph* g, int k, color cc,
+                      void (*visit)(const int* clique, int k, color cc, void* arg), void* arg);
+
+/* Is there any k-clique of color cc. Stops at the first one */
+bool wide_has_clique(const Wide_graph* g, int k, color cc);
+
+/* xorshift64* */
+static inline uint64_t wide_rand(uint64_t* s) {
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 2685821657736338717ULL;
+}
+
+/* Uniform value in [0, n) */
+static inline uint64_t wide_rand_below(uint64_t* s, uint64_t n) {
+    return (uint64_t)((double)(wide_rand(s) >> 11) / 9007199254740992.0 * n);
+}
+
+/* One random walk towards a k-clique of color cc: each step picks a vertex
+   uniformly among the common neighbors of those picked so far. Returns the
+   product of the candidate counts at each step if the walk completes, else
+   0, so the mean over walks is the number of ordered k-cliques, i.e. k! times
+   the number of k-cliques */
+double wide_walk(const Wide_graph* g, int k, color cc, uint64_t* rng);
+
+#endif
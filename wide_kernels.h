@@ -0,0 +1,105 @@
+/**
+ * Bitset kernels and clique search over rows of W words, included by wide.c
+ * once for each row width with W defined. Names are suffixed with the width
+ * through WIDE_FN.
+ */
+
+static inline int WIDE_FN(wide_count)(const uint64_t* a) {
+    int n = 0;
+
+    for(int i = 0; i < W; i++) {
+        n += __builtin_popcountll(a[i]);
+    }
+
+    return n;
+}
+
+static inline void WIDE_FN(wide_and)(uint64_t* out, const uint64_t* a, const uint64_t* b) {
+    for(int i = 0; i < W; i++) {
+        out[i] = a[i] & b[i];
+    }
+}
+
+/* Extend the clique of n vertices, whose common neighbors of color cc above
+   its last vertex are cand, to every k-clique */
+static void WIDE_FN(wide_extend)(Wide_search* s, int n, const uint64_t* cand) {
+    const uint64_t* nbr = s->g->nbr[s->cc];
+    uint64_t cur[W];
+    uint64_t next[W];
+
+    if(n == s->k) {
+        s->found++;
+        if(s->visit != NULL) {
+            s->visit(s->clique, s->k, s->cc, s->arg);
+        }
+        s->stop = s->first;
+        return;
+    }
+
+    /* Not enough candidates left to finish the clique */
+    if(WIDE_FN(wide_count)(cand) < s->k - n) {
+        return;
+    }
+
+    memcpy(cur, cand, sizeof(cur));
+    for(int w = 0; w < W; w++) {
+        while(cur[w] && !s->stop) {
+            int v = w * 64 + __builtin_ctzll(cur[w]);
+
+            /* Clearing v first leaves only the candidates above it */
+            cur[w] &= cur[w] - 1;
+            WIDE_FN(wide_and)(next, cur, nbr + (size_t) v * W);
+            s->clique[n] = v;
+            WIDE_FN(wide_extend)(s, n + 1, next);
+        }
+    }
+}
+
+static inline void WIDE_FN(wide_all)(uint64_t* all, int order) {
+    for(int i = 0; i < W; i++) {
+        int lo = i * 64;
+
+        all[i] = order >= lo + 64 ? ~(uint64_t)0 :
+                 order <= lo ? 0 : (((uint64_t)1) << (order - lo)) - 1;
+    }
+}
+
+static void WIDE_FN(wide_search)(Wide_search* s) {
+    uint64_t all[W];
+
+    WIDE_FN(wide_all)(all, s->g->order);
+    WIDE_FN(wide_extend)(s, 0, all);
+}
+
+static double WIDE_FN(wide_walk)(const Wide_graph* g, int k, color cc, uint64_t* rng) {
+    uint64_t cand[W];
+    double weight = 1;
+
+    WIDE_FN(wide_all)(cand, g->order);
+
+    for(int step = 0; step < k; step++) {
+        int n = WIDE_FN(wide_count)(cand);
+        int w = 0;
+        uint64_t pick, bits;
+
+        if(n == 0) {
+            return 0;
+        }
+        weight *= n;
+
+        /* The pick-th candidate: find its word, then clear the bits below */
+        pick = wide_rand_below(rng, n);
+        while(pick >= (uint64_t) __builtin_popcountll(cand[w])) {
+            pick -= __builtin_popcountll(cand[w]);
+            w++;
+        }
+        bits = cand[w];
+        while(pick--) {
+            bits &= bits - 1;
+        }
+
+        WIDE_FN(wide_and)(cand, cand, g->nbr[cc] + (size_t)(w * 64 + __builtin_ctzll(bits)) * W);
+    }
+
+    return weight;
+}